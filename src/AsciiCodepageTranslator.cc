@@ -18,28 +18,57 @@
  */
 
 #include "AsciiCodepageTranslator.h"
+#include "Metrics.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 
-bool AsciiCodepageTranslator::translate(uint8_t in, gunichar &out)
+bool AsciiCodepageTranslator::Unknown(uint8_t in)
 {
-    bool ret = false;
+    static const unsigned slot = Metrics::RegisterTranslator("ascii");
 
-    if (in <= 127)
-    {
-        out = in;
-        ret = true;
-    }
-    else
+    int i = in;
+    Metrics::AddUnknownByte(slot);
+    std::cerr << "AsciiCodepageTranslator::translate(): Droppping unknown char 0x"
+        << std::setfill('0') << std::setw(2) << std::hex << i << std::endl;
+
+    return false;
+}
+
+bool AsciiCodepageTranslator::lookup(uint8_t in, gunichar &out) const
+{
+    if (in > 127)
+        return false;
+
+    out = in;
+    return true;
+}
+
+size_t AsciiCodepageTranslator::translateSpan(const uint8_t *in, size_t len, gunichar *out, std::vector<size_t> *missing) const
+{
+    return Table().Translate(in, len, out, missing);
+}
+
+void AsciiCodepageTranslator::translateSpanUtf8(const uint8_t *in, size_t len, std::string &out, std::vector<size_t> *missing) const
+{
+    Table().TranslateUtf8(in, len, out, missing);
+}
+
+const TranslationTable &AsciiCodepageTranslator::Table()
+{
+    static const TranslationTable table = []
     {
-        int i = in;
-        ret = false;
-        std::cerr << "AsciiCodepageTranslator::translate(): Droppping unknown char 0x"
-            << std::setfill('0') << std::setw(2) << std::hex << i << std::endl;
-    }
+        TranslationTable t;
+        for (unsigned b = 0; b < 0x80; ++b)
+            t.Set((uint8_t) b, b);
+        return t;
+    }();
 
-    return ret;
+    return table;
 }
 
+uint64_t AsciiCodepageTranslator::GetFingerprint() const
+{
+    return 0x7f; // identity up to 0x7f, nothing above
+}
@@ -17,14 +17,36 @@
  * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef ASCIICODEPAGETRANSLATOR_H_
+#define ASCIICODEPAGETRANSLATOR_H_
+
 #include <sstream>
 #include <string>
 #include "CairoTTY.h"
+#include "TranslationTable.h"
 
-class AsciiCodepageTranslator : public ICodepageTranslator
+class AsciiCodepageTranslator final : public ICodepageTranslator
 {
 public:
-    virtual bool translate(uint8_t in, gunichar &out);
+    virtual bool translate(uint8_t in, gunichar &out)
+    {
+        if (in > 127)
+            return Unknown(in);
+
+        out = in;
+        return true;
+    }
+
+    virtual bool lookup(uint8_t in, gunichar &out) const;
+    virtual size_t translateSpan(const uint8_t *in, size_t len, gunichar *out, std::vector<size_t> *missing) const;
+    virtual void translateSpanUtf8(const uint8_t *in, size_t len, std::string &out, std::vector<size_t> *missing) const;
+    virtual uint64_t GetFingerprint() const;
 private:
+    /** \brief Reports the byte in, which has no translation. Returns false. */
+    static bool Unknown(uint8_t in);
+
+    /** \brief Identity up to 0x7f, shared by all instances. */
+    static const TranslationTable &Table();
 };
 
+#endif /*ASCIICODEPAGETRANSLATOR_H_*/
@@ -0,0 +1,436 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "BoxDrawing.h"
+
+namespace
+{
+    /** \brief Weights of an arm. */
+    enum Weight
+    {
+        N, // none
+        L, // light
+        H, // heavy
+        D  // double
+    };
+
+    struct Arms
+    {
+        uint8_t m_Left;
+        uint8_t m_Right;
+        uint8_t m_Up;
+        uint8_t m_Down;
+    };
+
+    const gunichar BOX_FIRST = 0x2500;
+    const gunichar BLOCK_FIRST = 0x2580;
+    const gunichar BLOCK_LAST = 0x2595;
+
+    /** \brief Arms of U+2500..U+257F, all N for the characters drawn as glyphs. */
+    const Arms ARMS[] =
+    {
+        { L, L, N, N }, // U+2500 Light Horizontal
+        { H, H, N, N }, // U+2501 Heavy Horizontal
+        { N, N, L, L }, // U+2502 Light Vertical
+        { N, N, H, H }, // U+2503 Heavy Vertical
+        { N, N, N, N }, // U+2504 Light Triple Dash Horizontal
+        { N, N, N, N }, // U+2505 Heavy Triple Dash Horizontal
+        { N, N, N, N }, // U+2506 Light Triple Dash Vertical
+        { N, N, N, N }, // U+2507 Heavy Triple Dash Vertical
+        { N, N, N, N }, // U+2508 Light Quadruple Dash Horizontal
+        { N, N, N, N }, // U+2509 Heavy Quadruple Dash Horizontal
+        { N, N, N, N }, // U+250A Light Quadruple Dash Vertical
+        { N, N, N, N }, // U+250B Heavy Quadruple Dash Vertical
+        { N, L, N, L }, // U+250C Light Down And Right
+        { N, H, N, L }, // U+250D Down Light And Right Heavy
+        { N, L, N, H }, // U+250E Down Heavy And Right Light
+        { N, H, N, H }, // U+250F Heavy Down And Right
+        { L, N, N, L }, // U+2510 Light Down And Left
+        { H, N, N, L }, // U+2511 Down Light And Left Heavy
+        { L, N, N, H }, // U+2512 Down Heavy And Left Light
+        { H, N, N, H }, // U+2513 Heavy Down And Left
+        { N, L, L, N }, // U+2514 Light Up And Right
+        { N, H, L, N }, // U+2515 Up Light And Right Heavy
+        { N, L, H, N }, // U+2516 Up Heavy And Right Light
+        { N, H, H, N }, // U+2517 Heavy Up And Right
+        { L, N, L, N }, // U+2518 Light Up And Left
+        { H, N, L, N }, // U+2519 Up Light And Left Heavy
+        { L, N, H, N }, // U+251A Up Heavy And Left Light
+        { H, N, H, N }, // U+251B Heavy Up And Left
+        { N, L, L, L }, // U+251C Light Vertical And Right
+        { N, H, L, L }, // U+251D Vertical Light And Right Heavy
+        { N, L, H, L }, // U+251E Up Heavy And Right Down Light
+        { N, L, L, H }, // U+251F Down Heavy And Right Up Light
+        { N, L, H, H }, // U+2520 Vertical Heavy And Right Light
+        { N, H, H, L }, // U+2521 Down Light And Right Up Heavy
+        { N, H, L, H }, // U+2522 Up Light And Right Down Heavy
+        { N, H, H, H }, // U+2523 Heavy Vertical And Right
+        { L, N, L, L }, // U+2524 Light Vertical And Left
+        { H, N, L, L }, // U+2525 Vertical Light And Left Heavy
+        { L, N, H, L }, // U+2526 Up Heavy And Left Down Light
+        { L, N, L, H }, // U+2527 Down Heavy And Left Up Light
+        { L, N, H, H }, // U+2528 Vertical Heavy And Left Light
+        { H, N, H, L }, // U+2529 Down Light And Left Up Heavy
+        { H, N, L, H }, // U+252A Up Light And Left Down Heavy
+        { H, N, H, H }, // U+252B Heavy Vertical And Left
+        { L, L, N, L }, // U+252C Light Down And Horizontal
+        { H, L, N, L }, // U+252D Left Heavy And Right Down Light
+        { L, H, N, L }, // U+252E Right Heavy And Left Down Light
+        { H, H, N, L }, // U+252F Down Light And Horizontal Heavy
+        { L, L, N, H }, // U+2530 Down Heavy And Horizontal Light
+        { H, L, N, H }, // U+2531 Right Light And Left Down Heavy
+        { L, H, N, H }, // U+2532 Left Light And Right Down Heavy
+        { H, H, N, H }, // U+2533 Heavy Down And Horizontal
+        { L, L, L, N }, // U+2534 Light Up And Horizontal
+        { H, L, L, N }, // U+2535 Left Heavy And Right Up Light
+        { L, H, L, N }, // U+2536 Right Heavy And Left Up Light
+        { H, H, L, N }, // U+2537 Up Light And Horizontal Heavy
+        { L, L, H, N }, // U+2538 Up Heavy And Horizontal Light
+        { H, L, H, N }, // U+2539 Right Light And Left Up Heavy
+        { L, H, H, N }, // U+253A Left Light And Right Up Heavy
+        { H, H, H, N }, // U+253B Heavy Up And Horizontal
+        { L, L, L, L }, // U+253C Light Vertical And Horizontal
+        { H, L, L, L }, // U+253D Left Heavy And Right Vertical Light
+        { L, H, L, L }, // U+253E Right Heavy And Left Vertical Light
+        { H, H, L, L }, // U+253F Vertical Light And Horizontal Heavy
+        { L, L, H, L }, // U+2540 Up Heavy And Down Horizontal Light
+        { L, L, L, H }, // U+2541 Down Heavy And Up Horizontal Light
+        { L, L, H, H }, // U+2542 Vertical Heavy And Horizontal Light
+        { H, L, H, L }, // U+2543 Left Up Heavy And Right Down Light
+        { L, H, H, L }, // U+2544 Right Up Heavy And Left Down Light
+        { H, L, L, H }, // U+2545 Left Down Heavy And Right Up Light
+        { L, H, L, H }, // U+2546 Right Down Heavy And Left Up Light
+        { H, H, H, L }, // U+2547 Down Light And Up Horizontal Heavy
+        { H, H, L, H }, // U+2548 Up Light And Down Horizontal Heavy
+        { H, L, H, H }, // U+2549 Right Light And Left Vertical Heavy
+        { L, H, H, H }, // U+254A Left Light And Right Vertical Heavy
+        { H, H, H, H }, // U+254B Heavy Vertical And Horizontal
+        { N, N, N, N }, // U+254C Light Double Dash Horizontal
+        { N, N, N, N }, // U+254D Heavy Double Dash Horizontal
+        { N, N, N, N }, // U+254E Light Double Dash Vertical
+        { N, N, N, N }, // U+254F Heavy Double Dash Vertical
+        { D, D, N, N }, // U+2550 Double Horizontal
+        { N, N, D, D }, // U+2551 Double Vertical
+        { N, D, N, L }, // U+2552 Down Single And Right Double
+        { N, L, N, D }, // U+2553 Down Double And Right Single
+        { N, D, N, D }, // U+2554 Double Down And Right
+        { D, N, N, L }, // U+2555 Down Single And Left Double
+        { L, N, N, D }, // U+2556 Down Double And Left Single
+        { D, N, N, D }, // U+2557 Double Down And Left
+        { N, D, L, N }, // U+2558 Up Single And Right Double
+        { N, L, D, N }, // U+2559 Up Double And Right Single
+        { N, D, D, N }, // U+255A Double Up And Right
+        { D, N, L, N }, // U+255B Up Single And Left Double
+        { L, N, D, N }, // U+255C Up Double And Left Single
+        { D, N, D, N }, // U+255D Double Up And Left
+        { N, D, L, L }, // U+255E Vertical Single And Right Double
+        { N, L, D, D }, // U+255F Vertical Double And Right Single
+        { N, D, D, D }, // U+2560 Double Vertical And Right
+        { D, N, L, L }, // U+2561 Vertical Single And Left Double
+        { L, N, D, D }, // U+2562 Vertical Double And Left Single
+        { D, N, D, D }, // U+2563 Double Vertical And Left
+        { D, D, N, L }, // U+2564 Down Single And Horizontal Double
+        { L, L, N, D }, // U+2565 Down Double And Horizontal Single
+        { D, D, N, D }, // U+2566 Double Down And Horizontal
+        { D, D, L, N }, // U+2567 Up Single And Horizontal Double
+        { L, L, D, N }, // U+2568 Up Double And Horizontal Single
+        { D, D, D, N }, // U+2569 Double Up And Horizontal
+        { D, D, L, L }, // U+256A Vertical Single And Horizontal Double
+        { L, L, D, D }, // U+256B Vertical Double And Horizontal Single
+        { D, D, D, D }, // U+256C Double Vertical And Horizontal
+        { N, N, N, N }, // U+256D Light Arc Down And Right
+        { N, N, N, N }, // U+256E Light Arc Down And Left
+        { N, N, N, N }, // U+256F Light Arc Up And Left
+        { N, N, N, N }, // U+2570 Light Arc Up And Right
+        { N, N, N, N }, // U+2571 Light Diagonal Upper Right To Lower Left
+        { N, N, N, N }, // U+2572 Light Diagonal Upper Left To Lower Right
+        { N, N, N, N }, // U+2573 Light Diagonal Cross
+        { L, N, N, N }, // U+2574 Light Left
+        { N, N, L, N }, // U+2575 Light Up
+        { N, L, N, N }, // U+2576 Light Right
+        { N, N, N, L }, // U+2577 Light Down
+        { H, N, N, N }, // U+2578 Heavy Left
+        { N, N, H, N }, // U+2579 Heavy Up
+        { N, H, N, N }, // U+257A Heavy Right
+        { N, N, N, H }, // U+257B Heavy Down
+        { L, H, N, N }, // U+257C Light Left And Heavy Right
+        { N, N, L, H }, // U+257D Light Up And Heavy Down
+        { H, L, N, N }, // U+257E Heavy Left And Light Right
+        { N, N, H, L }, // U+257F Heavy Up And Light Down
+    };
+
+    /** \brief Positions closer than this (in points) are the same. */
+    const double EPSILON = 0.01;
+
+    bool Same(double a, double b)
+    {
+        return std::fabs(a - b) < EPSILON;
+    }
+
+    /** \brief Where a line of a double arm ends at the centre, given the arm across on its side. */
+    double DoubleEnd(unsigned across, double center, double off, double sign)
+    {
+        if (across == N)
+            return center + sign * off; // outer line, to the corner
+        if (across == D)
+            return center - sign * off; // inner line, up to the double line across
+        return center;
+    }
+}
+
+bool BoxDrawingCompositor::Handles(gunichar c)
+{
+    if (c >= BLOCK_FIRST)
+        return c <= BLOCK_LAST;
+
+    if (c < BOX_FIRST)
+        return false;
+
+    const Arms &a = ARMS[c - BOX_FIRST];
+    return a.m_Left != N || a.m_Right != N || a.m_Up != N || a.m_Down != N;
+}
+
+void BoxDrawingCompositor::Add(gunichar c, double left, double top, double right, double bottom, double light)
+{
+    if (c >= BLOCK_FIRST)
+    {
+        AddBlock(c, left, top, right, bottom);
+        return;
+    }
+
+    const Arms &a = ARMS[c - BOX_FIRST];
+    double cx = (left + right) / 2.0;
+    double cy = (top + bottom) / 2.0;
+
+    AddArms(m_Horizontal, a.m_Left, a.m_Right, a.m_Up, a.m_Down, left, cx, right, cy, light);
+    AddArms(m_Vertical, a.m_Up, a.m_Down, a.m_Left, a.m_Right, top, cy, bottom, cx, light);
+}
+
+void BoxDrawingCompositor::AddArms(std::vector<Rule> &rules, unsigned before, unsigned after, unsigned perpBefore, unsigned perpAfter,
+    double start, double center, double end, double pos, double light)
+{
+    double off = 1.5 * light;
+
+    // Single lines stop at the near line of a double line across.
+    bool doubleAcross = perpBefore == D || perpAfter == D;
+
+    if (before == D)
+    {
+        rules.push_back(Rule { light, pos - off, start, DoubleEnd(perpBefore, center, off, 1.0) });
+        rules.push_back(Rule { light, pos + off, start, DoubleEnd(perpAfter, center, off, 1.0) });
+    }
+    else if (before != N)
+    {
+        rules.push_back(Rule { before == H ? 2.0 * light : light, pos, start, doubleAcross ? center - off : center });
+    }
+
+    if (after == D)
+    {
+        rules.push_back(Rule { light, pos - off, DoubleEnd(perpBefore, center, off, -1.0), end });
+        rules.push_back(Rule { light, pos + off, DoubleEnd(perpAfter, center, off, -1.0), end });
+    }
+    else if (after != N)
+    {
+        rules.push_back(Rule { after == H ? 2.0 * light : light, pos, doubleAcross ? center + off : center, end });
+    }
+}
+
+void BoxDrawingCompositor::AddBlock(gunichar c, double left, double top, double right, double bottom)
+{
+    double gray = 0.0;
+    double width = right - left;
+    double height = bottom - top;
+
+    if (c == 0x2580)
+        bottom = top + height / 2.0; // upper half
+    else if (c < 0x2588)
+        top = bottom - height * (c - 0x2580) / 8.0; // lower eighths
+    else if (c > 0x2588 && c < 0x2590)
+        right = left + width * (0x2590 - c) / 8.0; // left eighths
+    else if (c == 0x2590)
+        left += width / 2.0; // right half
+    else if (c >= 0x2591 && c <= 0x2593)
+        gray = 1.0 - (c - 0x2590) / 4.0; // light, medium and dark shade
+    else if (c == 0x2594)
+        bottom = top + height / 8.0; // upper eighth
+    else if (c == 0x2595)
+        left = right - width / 8.0; // right eighth
+
+    m_Boxes.push_back(Box { gray, left, top, right, bottom });
+}
+
+void BoxDrawingCompositor::MergeRules(std::vector<Rule> &rules)
+{
+    std::sort(rules.begin(), rules.end(), [](const Rule &a, const Rule &b)
+    {
+        if (a.m_Width != b.m_Width)
+            return a.m_Width < b.m_Width;
+        if (a.m_Pos != b.m_Pos)
+            return a.m_Pos < b.m_Pos;
+        return a.m_From < b.m_From;
+    });
+
+    size_t out = 0;
+    for (size_t i = 0; i < rules.size(); ++i)
+    {
+        Rule &last = rules[out > 0 ? out - 1 : 0];
+
+        if (out > 0 && last.m_Width == rules[i].m_Width && Same(last.m_Pos, rules[i].m_Pos)
+            && rules[i].m_From <= last.m_To + EPSILON)
+        {
+            last.m_To = std::max(last.m_To, rules[i].m_To);
+        }
+        else
+        {
+            rules[out++] = rules[i];
+        }
+    }
+
+    rules.resize(out);
+}
+
+void BoxDrawingCompositor::MergeBoxes(std::vector<Box> &boxes)
+{
+    // First into horizontal bands...
+    std::sort(boxes.begin(), boxes.end(), [](const Box &a, const Box &b)
+    {
+        if (a.m_Gray != b.m_Gray)
+            return a.m_Gray < b.m_Gray;
+        if (a.m_Top != b.m_Top)
+            return a.m_Top < b.m_Top;
+        if (a.m_Bottom != b.m_Bottom)
+            return a.m_Bottom < b.m_Bottom;
+        return a.m_Left < b.m_Left;
+    });
+
+    size_t out = 0;
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        Box &last = boxes[out > 0 ? out - 1 : 0];
+
+        if (out > 0 && last.m_Gray == boxes[i].m_Gray && Same(last.m_Top, boxes[i].m_Top)
+            && Same(last.m_Bottom, boxes[i].m_Bottom) && boxes[i].m_Left <= last.m_Right + EPSILON)
+        {
+            last.m_Right = std::max(last.m_Right, boxes[i].m_Right);
+        }
+        else
+        {
+            boxes[out++] = boxes[i];
+        }
+    }
+    boxes.resize(out);
+
+    // ...then bands of the same extent on top of each other.
+    std::sort(boxes.begin(), boxes.end(), [](const Box &a, const Box &b)
+    {
+        if (a.m_Gray != b.m_Gray)
+            return a.m_Gray < b.m_Gray;
+        if (a.m_Left != b.m_Left)
+            return a.m_Left < b.m_Left;
+        if (a.m_Right != b.m_Right)
+            return a.m_Right < b.m_Right;
+        return a.m_Top < b.m_Top;
+    });
+
+    out = 0;
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        Box &last = boxes[out > 0 ? out - 1 : 0];
+
+        if (out > 0 && last.m_Gray == boxes[i].m_Gray && Same(last.m_Left, boxes[i].m_Left)
+            && Same(last.m_Right, boxes[i].m_Right) && boxes[i].m_Top <= last.m_Bottom + EPSILON)
+        {
+            last.m_Bottom = std::max(last.m_Bottom, boxes[i].m_Bottom);
+        }
+        else
+        {
+            boxes[out++] = boxes[i];
+        }
+    }
+    boxes.resize(out);
+}
+
+void BoxDrawingCompositor::Flush(const Cairo::RefPtr<Cairo::Context> &cr)
+{
+    if (m_Horizontal.empty() && m_Vertical.empty() && m_Boxes.empty())
+        return;
+
+    MergeRules(m_Horizontal);
+    MergeRules(m_Vertical);
+    MergeBoxes(m_Boxes);
+
+    cr->save();
+    cr->begin_new_path();
+
+    // Boxes first, so that rules crossing shaded areas stay visible.
+    for (size_t i = 0; i < m_Boxes.size(); ++i)
+    {
+        const Box &b = m_Boxes[i];
+        cr->rectangle(b.m_Left, b.m_Top, b.m_Right - b.m_Left, b.m_Bottom - b.m_Top);
+
+        if (i + 1 == m_Boxes.size() || m_Boxes[i + 1].m_Gray != b.m_Gray)
+        {
+            cr->set_source_rgb(b.m_Gray, b.m_Gray, b.m_Gray);
+            cr->fill();
+        }
+    }
+
+    // Square caps close the corners where arms meet at the centre of a cell.
+    cr->set_source_rgb(0.0, 0.0, 0.0);
+    cr->set_line_cap(Cairo::LINE_CAP_SQUARE);
+
+    // One path per line width; the rules are sorted by width.
+    std::vector<Rule> *axes[] = { &m_Horizontal, &m_Vertical };
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        const std::vector<Rule> &rules = *axes[axis];
+
+        for (size_t i = 0; i < rules.size(); ++i)
+        {
+            const Rule &r = rules[i];
+
+            if (axis == 0)
+            {
+                cr->move_to(r.m_From, r.m_Pos);
+                cr->line_to(r.m_To, r.m_Pos);
+            }
+            else
+            {
+                cr->move_to(r.m_Pos, r.m_From);
+                cr->line_to(r.m_Pos, r.m_To);
+            }
+
+            if (i + 1 == rules.size() || rules[i + 1].m_Width != r.m_Width)
+            {
+                cr->set_line_width(r.m_Width);
+                cr->stroke();
+            }
+        }
+    }
+
+    cr->restore();
+
+    m_Horizontal.clear();
+    m_Vertical.clear();
+    m_Boxes.clear();
+}
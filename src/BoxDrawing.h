@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOXDRAWING_H_
+#define BOXDRAWING_H_
+
+#include <vector>
+
+#include <glibmm.h>
+#include <cairomm/cairomm.h>
+
+/**
+ * \brief Draws box drawing and block characters as merged vector shapes.
+ *
+ * Every character of the Unicode box drawing block (U+2500..U+257F, except
+ * the dashed, rounded and diagonal ones) is split into its arms, lines from
+ * the cell edges to the centre, and every block or shade character
+ * (U+2580..U+2595) into a rectangle. Flush() merges the arms that continue
+ * each other, within a line and across lines, into as few long rules and
+ * rectangles as possible and draws them. So a ruled table costs a handful
+ * of path operations per page instead of a glyph per character, and the
+ * rules have no gaps between the cells.
+ */
+class BoxDrawingCompositor
+{
+public:
+    /** \brief Whether c is drawn by the compositor rather than as a glyph. */
+    static bool Handles(gunichar c);
+
+    /**
+     * \brief Adds c, drawn into the cell from (left, top) to (right, bottom).
+     *
+     * light is the width of a light line, heavy lines are twice as wide.
+     */
+    void Add(gunichar c, double left, double top, double right, double bottom, double light);
+
+    /** \brief Draws everything added since the last call on cr, then forgets it. */
+    void Flush(const Cairo::RefPtr<Cairo::Context> &cr);
+
+private:
+    /** \brief A straight line along one axis: from m_From to m_To at m_Pos across. */
+    struct Rule
+    {
+        double m_Width;
+        double m_Pos;
+        double m_From;
+        double m_To;
+    };
+
+    struct Box
+    {
+        double m_Gray;
+        double m_Left;
+        double m_Top;
+        double m_Right;
+        double m_Bottom;
+    };
+
+    /**
+     * \brief Adds the arms along one axis of a character.
+     *
+     * before and after are the weights of the arms towards start and end,
+     * perpBefore and perpAfter those of the arms on either side across.
+     */
+    static void AddArms(std::vector<Rule> &rules, unsigned before, unsigned after, unsigned perpBefore, unsigned perpAfter,
+        double start, double center, double end, double pos, double light);
+
+    void AddBlock(gunichar c, double left, double top, double right, double bottom);
+
+    /** \brief Joins rules of the same width on the same position that touch or overlap. */
+    static void MergeRules(std::vector<Rule> &rules);
+
+    /** \brief Joins boxes of the same gray side by side, then on top of each other. */
+    static void MergeBoxes(std::vector<Box> &boxes);
+
+    std::vector<Rule> m_Horizontal;
+    std::vector<Rule> m_Vertical;
+    std::vector<Box> m_Boxes;
+};
+
+#endif /*BOXDRAWING_H_*/
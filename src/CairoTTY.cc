@@ -17,21 +17,91 @@
  * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 #include <assert.h>
+#include <cairo-pdf.h>
 #include "CairoTTY.h"
 #include "AsciiCodepageTranslator.h"
+#include "BoxDrawing.h"
 #include "CodepageTranslator.h"
+#include "DisplayList.h"
+#include "FontCoverage.h"
+#include "FontFiles.h"
+#include "JobScheduler.h"
+#include "LineTemplates.h"
+#include "Metrics.h"
+#include "Overstrike.h"
+#include "TextSidecar.h"
+
+namespace
+{
+    /** \brief Width of a light box drawing rule, relative to the font size. */
+    const double BOX_LINE_WIDTH = 0.07;
+}
 
-CairoTTY::CairoTTY(Cairo::RefPtr<Cairo::PdfSurface> cs, const PageSize &p, const Margins &m, ICharPreprocessor *preprocessor, ICodepageTranslator *translator):
+CairoTTY::CairoTTY(Cairo::RefPtr<Cairo::PdfSurface> cs, const PageSize &p, const Margins &m, ICharPreprocessor *preprocessor, ICodepageTranslator *translator,
+    std::shared_ptr<const FontFileSet> fonts):
+    m_SurfaceProvider(nullptr),
     m_CairoSurface(cs),
     m_FontName("Courier New"),
     m_FontSize(10.0),
+    m_FontFiles(fonts),
+    m_FontWeight(FontWeight::Normal),
+    m_FontSlant(FontSlant::Normal),
+    m_Margins(m),
+    m_PageCount(0),
+    m_PageHasContent(false),
+    m_SplitPages(0),
+    m_SplitOnReset(false),
+    m_PagesInChunk(0),
+    m_ChunkHasContent(false),
+    m_InputOffset(0),
+    m_Checkpoints(false),
+    m_BreakInGlyph(false),
+    m_CheckpointPending(false),
+    m_Preprocessor(preprocessor),
+    m_CpTranslator(translator),
+    m_LastAdvance(0.0),
+    m_CoverageApplies(false),
+    m_TextSidecar(nullptr)
+{
+    Init(p);
+    SetPreprocessor(preprocessor);
+}
+
+CairoTTY::CairoTTY(ISurfaceProvider *provider, const PageSize &p, const Margins &m, ICharPreprocessor *preprocessor, ICodepageTranslator *translator,
+    std::shared_ptr<const FontFileSet> fonts):
+    m_SurfaceProvider(provider),
+    m_CairoSurface(provider->OpenSurface(p)),
+    m_FontName("Courier New"),
+    m_FontSize(10.0),
+    m_FontFiles(fonts),
     m_FontWeight(FontWeight::Normal),
     m_FontSlant(FontSlant::Normal),
     m_Margins(m),
+    m_PageCount(0),
+    m_PageHasContent(false),
+    m_SplitPages(0),
+    m_SplitOnReset(false),
+    m_PagesInChunk(0),
+    m_ChunkHasContent(false),
+    m_InputOffset(0),
+    m_Checkpoints(false),
+    m_BreakInGlyph(false),
+    m_CheckpointPending(false),
     m_Preprocessor(preprocessor),
-    m_CpTranslator(translator)
+    m_CpTranslator(translator),
+    m_LastAdvance(0.0),
+    m_CoverageApplies(false),
+    m_TextSidecar(nullptr)
+{
+    Init(p);
+    SetPreprocessor(preprocessor);
+}
+
+void CairoTTY::Init(const PageSize &p)
 {
     m_Context = Cairo::Context::create(m_CairoSurface);
 
@@ -45,8 +115,15 @@ CairoTTY::CairoTTY(Cairo::RefPtr<Cairo::PdfSurface> cs, const PageSize &p, const
 
 CairoTTY::~CairoTTY()
 {
+    FinishPage();
+    if (m_TextSidecar && m_PageHasContent)
+        m_TextSidecar->EndPage();
     m_Context.clear();
-    m_CairoSurface->finish();
+
+    if (m_SurfaceProvider)
+        m_SurfaceProvider->CloseSurface(m_CairoSurface, !m_ChunkHasContent);
+    else
+        m_CairoSurface->finish();
 }
 
 CairoTTY &CairoTTY::operator<<(unsigned char c)
@@ -56,25 +133,231 @@ CairoTTY &CairoTTY::operator<<(unsigned char c)
     else
         append((char) c);
 
+    ByteDone();
+
+    return *this;
+}
+
+void CairoTTY::CheckpointPending()
+{
+    // The page started with the next byte, unless this one already drew on it.
+    if (!m_PageHasContent)
+        TakeCheckpoint(m_InputOffset);
+    m_CheckpointPending = false;
+}
+
+CairoTTY &CairoTTY::write(const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+        *this << buf[i];
+
     return *this;
 }
 
+void CairoTTY::Render(const DisplayPage &page)
+{
+    page.Replay(*this);
+}
+
+void CairoTTY::SetSplitting(unsigned pages, bool onReset)
+{
+    m_SplitPages = pages;
+    m_SplitOnReset = onReset;
+}
+
 void CairoTTY::SetPreprocessor(ICharPreprocessor *preprocessor)
 {
     m_Preprocessor = preprocessor;
+    if (m_Preprocessor)
+        m_Preprocessor->SetTranslator(m_CpTranslator);
+}
+
+void CairoTTY::SetVectorBoxes(bool enable)
+{
+    if (!enable)
+    {
+        FinishPage();
+        m_BoxDrawing.reset();
+    }
+    else if (!m_BoxDrawing)
+    {
+        m_BoxDrawing.reset(new BoxDrawingCompositor());
+    }
+}
+
+void CairoTTY::SetLineTemplates(bool enable)
+{
+    if (!enable)
+    {
+        FinishPage();
+        m_LineTemplates.reset();
+    }
+    else if (!m_LineTemplates)
+    {
+        m_LineTemplates.reset(new LineTemplates());
+        m_LineTemplates->SetStyle(m_Context->get_font_face(), m_FontSize);
+    }
+}
+
+void CairoTTY::SetOverstrike(bool enable)
+{
+    if (!enable)
+    {
+        FlushLine();
+        m_Overstrike.reset();
+    }
+    else if (!m_Overstrike)
+    {
+        m_Overstrike.reset(new OverstrikeCompositor());
+    }
+}
+
+void CairoTTY::SetFontCoverage(std::shared_ptr<const FontCoverage> coverage)
+{
+    m_FontCoverage = coverage;
+    m_CoverageApplies = m_FontCoverage && m_FontCoverage->GetFamily() == m_FontName;
+}
+
+void CairoTTY::SetTextSidecar(TextSidecar *sidecar)
+{
+    m_TextSidecar = sidecar;
+}
+
+void CairoTTY::FinishPage()
+{
+    FlushLine();
+    if (m_LineTemplates)
+        m_LineTemplates->Flush(m_Context);
+    if (m_BoxDrawing)
+        m_BoxDrawing->Flush(m_Context);
+}
+
+void CairoTTY::StartDocument(const std::string &title)
+{
+    if (m_PageHasContent)
+    {
+        FinishPage();
+        m_Context->show_page();
+        ++m_PageCount;
+        ++m_PagesInChunk;
+        m_PageHasContent = false;
+        if (m_TextSidecar)
+            m_TextSidecar->EndPage();
+    }
+
+    m_FontWeight = FontWeight::Normal;
+    m_FontSlant = FontSlant::Normal;
+    StretchFont(1.0, 1.0);
+    UseCurrentFont();
+    Home();
+
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
+    Cairo::RefPtr<Cairo::PdfSurface> pdf = Cairo::RefPtr<Cairo::PdfSurface>::cast_dynamic(m_CairoSurface);
+    if (pdf)
+    {
+        // Pages of the link are counted from 1 within the surface.
+        std::string link = "page=" + std::to_string(m_PagesInChunk + 1);
+        cairo_pdf_surface_add_outline(pdf->cobj(), CAIRO_PDF_OUTLINE_ROOT, title.c_str(), link.c_str(), (cairo_pdf_outline_flags_t) 0);
+    }
+#else
+    (void) title; // no outlines before cairo 1.16
+#endif
+}
+
+unsigned CairoTTY::GetPageCount() const
+{
+    // The first page is always output, even if it stays empty.
+    return m_PageCount + ((m_PageHasContent || m_PageCount == 0) ? 1 : 0);
+}
+
+unsigned CairoTTY::GetFinishedPageCount() const
+{
+    return m_PageCount;
+}
+
+void CairoTTY::EnableCheckpoints()
+{
+    m_Checkpoints = true;
+    TakeCheckpoint(m_InputOffset);
+}
+
+const TTYCheckpoint &CairoTTY::GetCheckpoint() const
+{
+    return m_Checkpoint;
+}
+
+void CairoTTY::Resume(const TTYCheckpoint &cp)
+{
+    m_InputOffset = cp.m_Offset;
+    m_PageCount = cp.m_Pages;
+    m_FontWeight = cp.m_FontWeight;
+    m_FontSlant = cp.m_FontSlant;
+    StretchFont(cp.m_StretchX, cp.m_StretchY);
+    UseCurrentFont();
+
+    if (m_Preprocessor && !cp.m_PreprocessorState.empty())
+    {
+        std::istringstream state(cp.m_PreprocessorState);
+        m_Preprocessor->LoadState(state);
+    }
+
+    Home();
+    m_Checkpoint = cp;
+}
+
+void CairoTTY::TakeCheckpoint(uint64_t offset)
+{
+    m_Checkpoint.m_Offset = offset;
+    m_Checkpoint.m_Pages = m_PageCount;
+    m_Checkpoint.m_StretchX = m_StretchX;
+    m_Checkpoint.m_StretchY = m_StretchY;
+    m_Checkpoint.m_FontWeight = m_FontWeight;
+    m_Checkpoint.m_FontSlant = m_FontSlant;
+
+    std::ostringstream state;
+    if (m_Preprocessor)
+        m_Preprocessor->SaveState(state);
+    m_Checkpoint.m_PreprocessorState = state.str();
+}
+
+void CairoTTY::NextChunk()
+{
+    if (!m_SurfaceProvider)
+        return;
+
+    m_Context.clear();
+    m_SurfaceProvider->CloseSurface(m_CairoSurface, !m_ChunkHasContent);
+
+    m_CairoSurface = m_SurfaceProvider->OpenSurface(m_PageSize);
+    m_Context = Cairo::Context::create(m_CairoSurface);
+    m_PagesInChunk = 0;
+    m_ChunkHasContent = false;
+
+    UseCurrentFont();
 }
 
 void CairoTTY::SetFont(const std::string &family, double size, Cairo::FontSlant slant, Cairo::FontWeight weight)
 {
     assert(size > 0.0);
 
-    m_Context->select_font_face(family, slant, weight);
+    if (m_FontFiles)
+        cairo_set_font_face(m_Context->cobj(), m_FontFiles->GetFace(slant, weight));
+    else
+        m_Context->select_font_face(family, slant, weight);
     m_Context->set_font_size(size);
 
+    if (m_LineTemplates)
+        m_LineTemplates->SetStyle(m_Context->get_font_face(), size);
+
     m_Context->get_font_extents(m_FontExtents);
 }
 
 void CairoTTY::UseCurrentFont()
+{
+    UseFont(m_FontName);
+}
+
+void CairoTTY::UseFont(const std::string &family)
 {
     Cairo::FontWeight weight;
     Cairo::FontSlant slant;
@@ -99,7 +382,7 @@ void CairoTTY::UseCurrentFont()
             break;
     }
 
-    SetFont(m_FontName, m_FontSize, slant, weight);
+    SetFont(family, m_FontSize, slant, weight);
 }
 
 void CairoTTY::SetPageSize(const PageSize &p)
@@ -108,11 +391,15 @@ void CairoTTY::SetPageSize(const PageSize &p)
     assert(p.m_Height > 0.0);
 
     m_PageSize = p;
-    m_CairoSurface->set_size(m_PageSize.m_Width, m_PageSize.m_Height);
+
+    Cairo::RefPtr<Cairo::PdfSurface> pdf = Cairo::RefPtr<Cairo::PdfSurface>::cast_dynamic(m_CairoSurface);
+    if (pdf)
+        pdf->set_size(m_PageSize.m_Width, m_PageSize.m_Height);
 }
 
 void CairoTTY::Home()
 {
+    FlushLine();
     m_x = 0.0;
     m_y = m_FontExtents.height * m_StretchY; // so that the top of the first line touches 0.0
 }
@@ -130,6 +417,7 @@ void CairoTTY::CarriageReturn()
 
 void CairoTTY::LineFeed()
 {
+    FlushLine();
     m_y += m_FontExtents.height * m_StretchY;
 
     // check if we still fit on the page
@@ -139,13 +427,62 @@ void CairoTTY::LineFeed()
 
 void CairoTTY::NewPage()
 {
+    FinishPage();
     m_Context->show_page();
+    ++m_PageCount;
+    ++m_PagesInChunk;
+    m_PageHasContent = false;
+    if (m_TextSidecar)
+        m_TextSidecar->EndPage();
+
+    if (m_SplitPages && m_PagesInChunk >= m_SplitPages)
+        NextChunk();
+
     Home();
+
+    if (m_Checkpoints)
+    {
+        // A glyph that does not fit starts the page, so the page starts with
+        // the current byte; otherwise it starts after the current byte.
+        if (m_BreakInGlyph)
+            TakeCheckpoint(m_InputOffset);
+        else
+            m_CheckpointPending = true;
+    }
+
+    // The page is complete: a bulk job may pause here for an interactive one.
+    JobScheduler::PageBoundary();
+}
+
+void CairoTTY::Initialize()
+{
+    m_FontWeight = FontWeight::Normal;
+    m_FontSlant = FontSlant::Normal;
+    StretchFont(1.0, 1.0);
+
+    if (m_SplitOnReset && m_ChunkHasContent)
+    {
+        // A reset starts a new job, which goes into its own chunk.
+        if (m_PageHasContent)
+        {
+            FinishPage();
+            m_Context->show_page();
+            ++m_PageCount;
+            m_PageHasContent = false;
+            if (m_TextSidecar)
+                m_TextSidecar->EndPage();
+        }
+        NextChunk();
+        Home();
+    }
 }
 
 void CairoTTY::SetFontName(const std::string family)
 {
     m_FontName = family;
+
+    // The coverage is only known for the font it was computed for
+    m_CoverageApplies = m_FontCoverage && m_FontCoverage->GetFamily() == m_FontName;
 }
 
 void CairoTTY::SetFontSize(const double size)
@@ -175,7 +512,9 @@ void CairoTTY::append(char c)
 
     if (m_CpTranslator == nullptr)
     {
-        m_CpTranslator = new AsciiCodepageTranslator();
+        // Stateless, so one instance serves all CairoTTYs (and threads)
+        static AsciiCodepageTranslator ascii;
+        m_CpTranslator = &ascii;
     }
 
     if (m_CpTranslator->translate(c, uc))
@@ -191,6 +530,12 @@ void CairoTTY::append(gunichar c)
         // TODO: tab handling
         return;
     }
+    else if (c == 0x08)
+    {
+        // Backspace: back by one glyph, the next one is printed over it
+        m_x = std::max(0.0, m_x - m_LastAdvance);
+        return;
+    }
     else if (Glib::Unicode::iscntrl(c))
     {
         std::cout << "Cannot print character 0x" << std::hex << c << std::endl;
@@ -203,16 +548,156 @@ void CairoTTY::append(gunichar c)
     double x_advance = m_StretchX * t.x_advance;
 
     if (m_Margins.m_Left + m_x + x_advance > m_PageSize.m_Width - m_Margins.m_Right)
+    {
+        m_BreakInGlyph = true;
         NewLine(); // forced linebreak - text wraps to the next line
+        m_BreakInGlyph = false;
+    }
 
-    m_Context->save();
-    m_Context->move_to(m_Margins.m_Left + m_x, m_Margins.m_Top + m_y);
-    m_Context->scale(m_StretchX, m_StretchY);
-    m_Context->show_text(s);
-    m_Context->restore();
+    if (m_Overstrike)
+    {
+        // Drawn at the end of the line
+        m_Overstrike->Add(c, m_x, x_advance, TextStyle { m_FontSize, m_StretchX, m_StretchY, m_FontWeight, m_FontSlant },
+            m_InputOffset);
+    }
+    else
+    {
+        Draw(c, m_Margins.m_Left + m_x, m_Margins.m_Top + m_y, x_advance, m_InputOffset);
+    }
+    m_PageHasContent = true;
+    m_ChunkHasContent = true;
 
     // We ignore y_advance, as we in no way can support
     // vertical text layout.
     m_x += x_advance;
+    m_LastAdvance = x_advance;
 }
 
+void CairoTTY::Draw(gunichar c, double x, double y, double x_advance, uint64_t offset)
+{
+    Metrics::Add(Metrics::GLYPHS);
+
+    if (m_TextSidecar)
+    {
+        m_TextSidecar->AddGlyph(c, x, y, x_advance, m_FontExtents.height * m_StretchY,
+            TextStyle { m_FontSize, m_StretchX, m_StretchY, m_FontWeight, m_FontSlant }, offset);
+    }
+
+    if (m_BoxDrawing && BoxDrawingCompositor::Handles(c))
+    {
+        // The cells of consecutive lines touch, so vertical rules continue.
+        double bottom = y + m_FontExtents.descent * m_StretchY;
+        double top = bottom - m_FontExtents.height * m_StretchY;
+        m_BoxDrawing->Add(c, x, top, x + x_advance, bottom, m_FontSize * BOX_LINE_WIDTH);
+    }
+    else if (const FontCoverage::Fallback *fallback = m_CoverageApplies ? m_FontCoverage->GetFallback(c) : nullptr)
+    {
+        DrawFallbackGlyph(Glib::ustring(1, c), fallback->GetFace(m_FontWeight, m_FontSlant), x, y, x_advance);
+    }
+    else
+    {
+        DrawGlyph(Glib::ustring(1, c), x, y);
+    }
+}
+
+void CairoTTY::FlushLine()
+{
+    if (!m_Overstrike || m_Overstrike->IsEmpty())
+        return;
+
+    TextStyle current { m_FontSize, m_StretchX, m_StretchY, m_FontWeight, m_FontSlant };
+    TextStyle used = current;
+    double y = m_Margins.m_Top + m_y;
+
+    for (const OverstrikeCompositor::Cell &cell : m_Overstrike->GetCells())
+    {
+        TextStyle style = cell.m_Style;
+        if (cell.m_Bold)
+            style.m_Weight = FontWeight::Bold;
+
+        if (!(style == used))
+        {
+            m_FontSize = style.m_Size;
+            m_StretchX = style.m_StretchX;
+            m_StretchY = style.m_StretchY;
+            m_FontWeight = style.m_Weight;
+            m_FontSlant = style.m_Slant;
+            UseCurrentFont();
+            used = style;
+        }
+
+        Draw(cell.m_Char, m_Margins.m_Left + cell.m_X, y, cell.m_Advance, cell.m_Offset);
+    }
+
+    // Underlines, one rule per run of underlined cells
+    const std::vector<OverstrikeCompositor::Cell> &cells = m_Overstrike->GetCells();
+    for (size_t i = 0; i < cells.size(); ++i)
+    {
+        if (!cells[i].m_Underline)
+            continue;
+
+        double left = cells[i].m_X, right = left + cells[i].m_Advance;
+        while (i + 1 < cells.size() && cells[i + 1].m_Underline && cells[i + 1].m_X <= right + 0.01)
+        {
+            ++i;
+            right = std::max(right, cells[i].m_X + cells[i].m_Advance);
+        }
+
+        double thickness = cells[i].m_Style.m_Size * BOX_LINE_WIDTH;
+        m_Context->rectangle(m_Margins.m_Left + left, y + m_FontExtents.descent * cells[i].m_Style.m_StretchY / 2.0 - thickness / 2.0,
+            right - left, thickness);
+        m_Context->fill();
+    }
+
+    if (!(used == current))
+    {
+        m_FontSize = current.m_Size;
+        m_StretchX = current.m_StretchX;
+        m_StretchY = current.m_StretchY;
+        m_FontWeight = current.m_Weight;
+        m_FontSlant = current.m_Slant;
+        UseCurrentFont();
+    }
+
+    m_Overstrike->Clear();
+}
+
+void CairoTTY::DrawGlyph(const Glib::ustring &s, double x, double y)
+{
+    if (m_LineTemplates)
+    {
+        // Drawn at the end of the page
+        m_LineTemplates->AddGlyph(s, x, y, m_StretchX, m_StretchY);
+        return;
+    }
+
+    m_Context->save();
+    m_Context->move_to(x, y);
+    m_Context->scale(m_StretchX, m_StretchY);
+    m_Context->show_text(s);
+    m_Context->restore();
+}
+
+void CairoTTY::DrawFallbackGlyph(const Glib::ustring &s, cairo_font_face_t *face, double x, double y, double width)
+{
+    // Only the face changes, size and extents of the main font stay.
+    Cairo::RefPtr<Cairo::FontFace> current = m_Context->get_font_face();
+    cairo_set_font_face(m_Context->cobj(), face);
+    if (m_LineTemplates)
+        m_LineTemplates->SetStyle(m_Context->get_font_face(), m_FontSize);
+
+    // Squeezed or widened to the cell of the main font, the columns stay aligned.
+    Cairo::TextExtents t;
+    m_Context->get_text_extents(s, t);
+
+    double stretchX = m_StretchX;
+    if (t.x_advance > 0.0)
+        m_StretchX = width / t.x_advance;
+
+    DrawGlyph(s, x, y);
+
+    m_StretchX = stretchX;
+    m_Context->set_font_face(current);
+    if (m_LineTemplates)
+        m_LineTemplates->SetStyle(current, m_FontSize);
+}
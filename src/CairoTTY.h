@@ -21,8 +21,12 @@
 #define CAIROTTY_H_
 
 #include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
 #include <string>
 #include <algorithm>
+#include <vector>
 #include <glibmm.h>
 #include <cairomm/cairomm.h>
 
@@ -96,6 +100,9 @@ public:
     virtual void LineFeed() = 0;
     virtual void NewPage() = 0;
 
+    /** \brief Printer reset (ESC @): back to the default style. */
+    virtual void Initialize() = 0;
+
     virtual void SetFontName(const std::string family) = 0;
     virtual void SetFontSize(const double size) = 0;
     virtual void SetFontWeight(const FontWeight weight) = 0;
@@ -110,11 +117,43 @@ public:
     {}
 };
 
+class ICodepageTranslator;
+
 class ICharPreprocessor
 {
 public:
     virtual void process(ICairoTTYProtected &ctty, uint8_t c) = 0;
 
+    /**
+     * \brief Writes the parser state, for resuming a conversion later.
+     *
+     * May be called from within process() when a printable character
+     * causes a page break; the state must then be the one from before
+     * that character. Stateless preprocessors need not override these.
+     */
+    virtual void SaveState(std::ostream &) const
+    {}
+
+    /** \brief Restores the state written by SaveState(), throws std::runtime_error if it is invalid. */
+    virtual void LoadState(std::istream &)
+    {}
+
+    /**
+     * \brief The translator the TTY translates characters with, nullptr for
+     * AsciiCodepageTranslator. Called before the first process(), for
+     * preprocessors that switch character tables themselves.
+     */
+    virtual void SetTranslator(const ICodepageTranslator *)
+    {}
+
+    /**
+     * \brief Appends the characters the preprocessor may draw besides those
+     * of the translator (of character tables it switches to), for looking
+     * up fonts for them before the first page.
+     */
+    virtual void GetExtraChars(std::vector<gunichar> &) const
+    {}
+
     virtual ~ICharPreprocessor()
     {}
 };
@@ -124,47 +163,222 @@ class ICodepageTranslator
 public:
     virtual bool translate(uint8_t in, gunichar &out) = 0;
 
+    /** \brief Like translate(), but silent about bytes without a translation. */
+    virtual bool lookup(uint8_t in, gunichar &out) const = 0;
+
+    /**
+     * \brief Translates len bytes at once, silently like lookup().
+     *
+     * out must have room for len code points. Bytes without a translation
+     * are skipped, their positions in in are appended to missing if it is
+     * not null. Returns the number of code points written.
+     */
+    virtual size_t translateSpan(const uint8_t *in, size_t len, gunichar *out, std::vector<size_t> *missing) const = 0;
+
+    /** \brief Like translateSpan(), but appends the translation to out as UTF-8. */
+    virtual void translateSpanUtf8(const uint8_t *in, size_t len, std::string &out, std::vector<size_t> *missing) const = 0;
+
+    /** \brief Value that changes whenever the translation does, used in cache keys. */
+    virtual uint64_t GetFingerprint() const = 0;
+
     virtual ~ICodepageTranslator()
     {}
 };
 
+/**
+ * \brief Supplies the surfaces CairoTTY draws on.
+ *
+ * This allows the output to be split into several chunks, each on its own surface.
+ */
+class ISurfaceProvider
+{
+public:
+    /** \brief Returns the surface for the next chunk of pages. */
+    virtual Cairo::RefPtr<Cairo::Surface> OpenSurface(const PageSize &p) = 0;
+
+    /**
+     * \brief Called once all pages of a chunk are drawn.
+     *
+     * empty is true if nothing at all was drawn on the surface.
+     */
+    virtual void CloseSurface(Cairo::RefPtr<Cairo::Surface> surface, bool empty) = 0;
+
+    virtual ~ISurfaceProvider()
+    {}
+};
+
+/** \brief Everything needed to resume a conversion at the start of a page. */
+struct TTYCheckpoint
+{
+    TTYCheckpoint():
+        m_Offset(0),
+        m_Pages(0),
+        m_StretchX(1.0),
+        m_StretchY(1.0),
+        m_FontWeight(FontWeight::Normal),
+        m_FontSlant(FontSlant::Normal)
+    {}
+
+    /** \brief Input bytes processed before the page. */
+    uint64_t m_Offset;
+
+    /** \brief Pages completed before the page. */
+    unsigned m_Pages;
+
+    double m_StretchX;
+    double m_StretchY;
+    FontWeight m_FontWeight;
+    FontSlant m_FontSlant;
+
+    /** \brief As written by ICharPreprocessor::SaveState(). */
+    std::string m_PreprocessorState;
+};
+
+class BoxDrawingCompositor;
+class DisplayPage;
+class FontCoverage;
+class FontFileSet;
+class LineTemplates;
+class OverstrikeCompositor;
+class TextSidecar;
+
+template <class Translator>
+class StaticTTY;
+
+/**
+ * The ICairoTTYProtected methods are final, so that StaticTTY can call them
+ * without going through the vtable.
+ */
 class CairoTTY: protected ICairoTTYProtected
 {
+    template <class Translator>
+    friend class StaticTTY;
+
 public:
-    CairoTTY(Cairo::RefPtr<Cairo::PdfSurface> cs, const PageSize &p, const Margins &m, ICharPreprocessor *preprocessor, ICodepageTranslator *translator);
+    /**
+     * Unless fonts is given, fonts are selected by name (through fontconfig).
+     * With fonts, the font name has no effect.
+     */
+    CairoTTY(Cairo::RefPtr<Cairo::PdfSurface> cs, const PageSize &p, const Margins &m, ICharPreprocessor *preprocessor, ICodepageTranslator *translator,
+        std::shared_ptr<const FontFileSet> fonts = nullptr);
+    CairoTTY(ISurfaceProvider *provider, const PageSize &p, const Margins &m, ICharPreprocessor *preprocessor, ICodepageTranslator *translator,
+        std::shared_ptr<const FontFileSet> fonts = nullptr);
 
     virtual ~CairoTTY();
 
     CairoTTY &operator<<(uint8_t c);
 
+    /** \brief Feeds len bytes at once. */
+    CairoTTY &write(const uint8_t *buf, size_t len);
+
+    /** \brief Bookkeeping after every input byte, for callers that run the preprocessor themselves. */
+    void ByteDone()
+    {
+        ++m_InputOffset;
+
+        if (m_CheckpointPending)
+            CheckpointPending();
+    }
+
+    /** \brief Draws a page recorded by DisplayListRecorder, bypassing the preprocessor. */
+    void Render(const DisplayPage &page);
+
+    /**
+     * \brief Starts a new surface every pages pages (0 = never) and,
+     * if onReset is set, at every printer reset (ESC @).
+     *
+     * Only has an effect if the CairoTTY was created with an ISurfaceProvider.
+     */
+    void SetSplitting(unsigned pages, bool onReset);
+
     void SetPreprocessor(ICharPreprocessor *preprocessor);
 
-    virtual void UseCurrentFont();
+    /** \brief Draw box drawing and block characters as merged vector rules, see BoxDrawingCompositor. */
+    void SetVectorBoxes(bool enable);
+
+    /** \brief Draw lines repeating on several pages from shared templates, see LineTemplates. */
+    void SetLineTemplates(bool enable);
+
+    /** \brief Collapse overstruck glyphs into bold and underlined ones, see OverstrikeCompositor. */
+    void SetOverstrike(bool enable);
+
+    /**
+     * \brief Draw the characters the font lacks with the fallback fonts of coverage.
+     *
+     * Only applies while the font name is the one coverage was computed for.
+     */
+    void SetFontCoverage(std::shared_ptr<const FontCoverage> coverage);
+
+    /** \brief Also pass every glyph and page break to sidecar (not owned), nullptr for none. */
+    void SetTextSidecar(TextSidecar *sidecar);
+
+    /**
+     * \brief Starts the next of several documents drawn on the same surface.
+     *
+     * Begins a new page unless the current one is still empty, resets the
+     * style as a printer reset would and adds a top level entry named title
+     * (UTF-8) to the PDF outline, pointing at that page.
+     */
+    void StartDocument(const std::string &title);
+
+    /** \brief Number of pages output so far, including the current one if anything was drawn on it. */
+    unsigned GetPageCount() const;
 
-    virtual void SetPageSize(const PageSize &p);
+    /** \brief Number of pages ended so far, without the current one. */
+    unsigned GetFinishedPageCount() const;
 
-    virtual void Home();
-    virtual void NewLine();
-    virtual void CarriageReturn();
-    virtual void LineFeed();
-    virtual void NewPage();
+    /** \brief Start recording a checkpoint at every page start, see GetCheckpoint(). */
+    void EnableCheckpoints();
 
-    virtual void SetFontName(const std::string family = "Courier New");
-    virtual void SetFontSize(const double size = 10.0);
-    virtual void SetFontWeight(const FontWeight weight = FontWeight::Normal);
-    virtual void SetFontSlant(const FontSlant slant = FontSlant::Italic);
-    virtual void StretchFont(double stretch_x, double stretch_y = 1.0);
+    /**
+     * \brief The checkpoint at the start of the last page begun.
+     *
+     * Feeding the input from m_Offset on to a CairoTTY restored by Resume()
+     * draws exactly the pages from there on.
+     */
+    const TTYCheckpoint &GetCheckpoint() const;
+
+    /** \brief Continues from cp, as if the input before cp.m_Offset had been fed already. */
+    void Resume(const TTYCheckpoint &cp);
+
+    virtual void UseCurrentFont() final;
+
+    virtual void SetPageSize(const PageSize &p) final;
+
+    virtual void Home() final;
+    virtual void NewLine() final;
+    virtual void CarriageReturn() final;
+    virtual void LineFeed() final;
+    virtual void NewPage() final;
+    virtual void Initialize() final;
+
+    virtual void SetFontName(const std::string family = "Courier New") final;
+    virtual void SetFontSize(const double size = 10.0) final;
+    virtual void SetFontWeight(const FontWeight weight = FontWeight::Normal) final;
+    virtual void SetFontSlant(const FontSlant slant = FontSlant::Italic) final;
+    virtual void StretchFont(double stretch_x, double stretch_y = 1.0) final;
 
 protected:
-    virtual void append(char c);
-    virtual void append(gunichar c);
+    virtual void append(char c) final;
+    virtual void append(gunichar c) final;
+
+    /** \brief Draws the already laid out text s with its origin at (x, y). */
+    virtual void DrawGlyph(const Glib::ustring &s, double x, double y);
+
+    /** \brief Draws s with face instead of the current font, stretched to width. */
+    void DrawFallbackGlyph(const Glib::ustring &s, cairo_font_face_t *face, double x, double y, double width);
 
 private:
-    Cairo::RefPtr<Cairo::PdfSurface> m_CairoSurface;
+    ISurfaceProvider *m_SurfaceProvider;
+    Cairo::RefPtr<Cairo::Surface> m_CairoSurface;
     Cairo::RefPtr<Cairo::Context> m_Context;
 
     std::string m_FontName;
     double m_FontSize;
+
+    /** \brief Faces loaded from files, nullptr to select fonts by name. */
+    std::shared_ptr<const FontFileSet> m_FontFiles;
+
     FontWeight m_FontWeight;
     FontSlant m_FontSlant;
     Cairo::FontExtents m_FontExtents;
@@ -178,9 +392,76 @@ private:
     double m_StretchX;
     double m_StretchY;
 
+    /** \brief Completed pages. */
+    unsigned m_PageCount;
+    bool m_PageHasContent;
+
+    unsigned m_SplitPages;
+    bool m_SplitOnReset;
+    unsigned m_PagesInChunk;
+    bool m_ChunkHasContent;
+
+    /** \brief Bytes fed through operator<< so far, counting from the checkpoint resumed. */
+    uint64_t m_InputOffset;
+
+    bool m_Checkpoints;
+    TTYCheckpoint m_Checkpoint;
+
+    /** \brief A page break happened while drawing a glyph (the current byte belongs to the new page). */
+    bool m_BreakInGlyph;
+
+    /** \brief A page break happened during the current byte, take the checkpoint after it. */
+    bool m_CheckpointPending;
+
     ICharPreprocessor *m_Preprocessor;
     ICodepageTranslator *m_CpTranslator;
 
+    /** \brief Collects the box drawing characters of the current page, nullptr if disabled. */
+    std::unique_ptr<BoxDrawingCompositor> m_BoxDrawing;
+
+    /** \brief Collects the glyphs of the current page, nullptr if disabled. */
+    std::unique_ptr<LineTemplates> m_LineTemplates;
+
+    /** \brief Collects the glyphs of the current line, nullptr if disabled. */
+    std::unique_ptr<OverstrikeCompositor> m_Overstrike;
+
+    /** \brief Advance of the last glyph, for backspace. */
+    double m_LastAdvance;
+
+    /** \brief Fallback fonts, nullptr if unknown. */
+    std::shared_ptr<const FontCoverage> m_FontCoverage;
+
+    /** \brief m_FontCoverage is for m_FontName. */
+    bool m_CoverageApplies;
+
+    TextSidecar *m_TextSidecar;
+
+    void Init(const PageSize &p);
+
+    /** \brief Completes the drawing of the current page, call before show_page(). */
+    void FinishPage();
+
+    /** \brief Draws the line collected by m_Overstrike, call before leaving the line. */
+    void FlushLine();
+
+    /**
+     * \brief Draws c at (x, y) with the current style, x_advance wide.
+     *
+     * offset is the input byte offset of c, for the text sidecar.
+     */
+    void Draw(gunichar c, double x, double y, double x_advance, uint64_t offset);
+
+    /** \brief Closes the current surface and continues on a new one. */
+    void NextChunk();
+
+    void TakeCheckpoint(uint64_t offset);
+
+    /** \brief Rest of ByteDone(), after the byte that began a page. */
+    void CheckpointPending();
+
+    /** \brief Selects family with the current size, weight and slant. */
+    void UseFont(const std::string &family);
+
     void SetFont(const std::string &family, double size,
         Cairo::FontSlant slant = Cairo::FONT_SLANT_NORMAL,
         Cairo::FontWeight weight = Cairo::FONT_WEIGHT_NORMAL);
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Checkpoint.h"
+#include "Hash.h"
+
+namespace
+{
+    const char *MAGIC = "dotprint-checkpoint";
+    const unsigned VERSION = 1;
+
+    const uint64_t TAIL_SIZE = 64 << 10;
+
+    std::string ToHex(const std::string &s)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+
+        for (unsigned char c : s)
+        {
+            hex += digits[c >> 4];
+            hex += digits[c & 0xf];
+        }
+
+        return hex.empty() ? "-" : hex;
+    }
+
+    std::string FromHex(const std::string &hex)
+    {
+        std::string s;
+
+        if (hex == "-")
+            return s;
+
+        if (hex.size() % 2)
+            throw std::runtime_error("Damaged checkpoint");
+
+        for (size_t i = 0; i < hex.size(); i += 2)
+            s += (char) std::stoi(hex.substr(i, 2), nullptr, 16);
+
+        return s;
+    }
+
+    /** \brief Reads "key value", checking the key. */
+    template <typename T>
+    void Expect(std::istream &in, const char *key, T &value)
+    {
+        std::string k;
+
+        if (!(in >> k) || k != key || !(in >> value))
+            throw std::runtime_error(std::string("Damaged checkpoint, expected ") + key);
+    }
+}
+
+bool ConversionCheckpoint::Load(const std::string &fileName)
+{
+    std::ifstream in(fileName);
+    if (!in.is_open())
+        return false;
+
+    unsigned version, weight, slant;
+    std::string state;
+
+    Expect(in, MAGIC, version);
+    if (version != VERSION)
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(version));
+
+    in >> std::hex;
+    Expect(in, "settings", m_Settings);
+    Expect(in, "tail", m_TailHash);
+    in >> std::dec;
+    Expect(in, "offset", m_TTY.m_Offset);
+    Expect(in, "pages", m_TTY.m_Pages);
+    Expect(in, "stretch-x", m_TTY.m_StretchX);
+    Expect(in, "stretch-y", m_TTY.m_StretchY);
+    Expect(in, "weight", weight);
+    Expect(in, "slant", slant);
+    Expect(in, "preprocessor", state);
+
+    m_TTY.m_FontWeight = weight ? FontWeight::Bold : FontWeight::Normal;
+    m_TTY.m_FontSlant = slant ? FontSlant::Italic : FontSlant::Normal;
+    m_TTY.m_PreprocessorState = FromHex(state);
+
+    return true;
+}
+
+void ConversionCheckpoint::Save(const std::string &fileName) const
+{
+    std::string tmp = fileName + "." + std::to_string(getpid()) + ".tmp";
+
+    {
+        std::ofstream out(tmp);
+        if (!out.is_open())
+            throw std::ios_base::failure("Unable to create \"" + tmp + "\"");
+
+        out << MAGIC << " " << VERSION << std::endl;
+        out << std::hex;
+        out << "settings " << m_Settings << std::endl;
+        out << "tail " << m_TailHash << std::endl;
+        out << std::dec << std::setprecision(std::numeric_limits<double>::max_digits10);
+        out << "offset " << m_TTY.m_Offset << std::endl;
+        out << "pages " << m_TTY.m_Pages << std::endl;
+        out << "stretch-x " << m_TTY.m_StretchX << std::endl;
+        out << "stretch-y " << m_TTY.m_StretchY << std::endl;
+        out << "weight " << (m_TTY.m_FontWeight == FontWeight::Bold ? 1 : 0) << std::endl;
+        out << "slant " << (m_TTY.m_FontSlant == FontSlant::Italic ? 1 : 0) << std::endl;
+        out << "preprocessor " << ToHex(m_TTY.m_PreprocessorState) << std::endl;
+
+        out.close();
+        if (out.fail())
+        {
+            unlink(tmp.c_str());
+            throw std::ios_base::failure("Unable to write \"" + tmp + "\"");
+        }
+    }
+
+    if (rename(tmp.c_str(), fileName.c_str()) != 0)
+    {
+        int err = errno;
+        unlink(tmp.c_str());
+        throw std::ios_base::failure("Unable to rename \"" + tmp + "\": " + strerror(err));
+    }
+}
+
+uint64_t ConversionCheckpoint::TailHash(int fd, uint64_t offset)
+{
+    uint64_t start = offset > TAIL_SIZE ? offset - TAIL_SIZE : 0;
+    std::vector<uint8_t> buffer(offset - start);
+    size_t done = 0;
+
+    while (done < buffer.size())
+    {
+        ssize_t n = pread(fd, buffer.data() + done, buffer.size() - done, start + done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break; // shorter than offset, the hash will not match
+
+        done += n;
+    }
+
+    Hash64 h;
+    h.Update(buffer.data(), done);
+
+    return h.Final();
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "CairoTTY.h"
+
+/**
+ * \brief Where an incremental conversion stopped, stored in a small text file.
+ *
+ * Besides the CairoTTY state it holds what is needed to tell whether the
+ * checkpoint still applies: the settings it was made with and a hash of the
+ * input just before the offset, which changes if the file was replaced
+ * rather than appended to.
+ */
+struct ConversionCheckpoint
+{
+    ConversionCheckpoint():
+        m_Settings(0),
+        m_TailHash(0)
+    {}
+
+    /** \brief ConversionSettings::GetFingerprint() of the conversion. */
+    uint64_t m_Settings;
+
+    /** \brief TailHash() of the input at m_TTY.m_Offset. */
+    uint64_t m_TailHash;
+
+    TTYCheckpoint m_TTY;
+
+    /** \brief Returns false if fileName does not exist, throws std::runtime_error if it is damaged. */
+    bool Load(const std::string &fileName);
+
+    /** \brief Replaces fileName atomically. */
+    void Save(const std::string &fileName) const;
+
+    /** \brief Hash of up to 64 kB of the file fd just before offset. */
+    static uint64_t TailHash(int fd, uint64_t offset);
+};
+
+#endif /*CHECKPOINT_H_*/
@@ -17,7 +17,9 @@
  * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 #include <assert.h>
 #include <string.h>
 
@@ -25,11 +27,57 @@
 #include <getopt.h>
 
 #include "CmdLineParser.h"
+#include "FontCoverage.h"
 #include "PageSizeFactory.h"
 #include "MarginsFactory.h"
+#include "PdfLinearizer.h"
 #include "PreprocessorFactory.h"
 #include "CodepageTranslator.h"
 
+namespace
+{
+    /** \brief Values getopt_long returns for options without a short form. */
+    enum LongOnlyOption
+    {
+        OPT_SPLIT_PAGES = 256,
+        OPT_SPLIT_ON_RESET,
+        OPT_STATS,
+        OPT_READ_AHEAD,
+        OPT_READ_BLOCK,
+        OPT_SAVE_IR,
+        OPT_LOAD_IR,
+        OPT_RENDER_THREAD,
+        OPT_CACHE,
+        OPT_CACHE_SIZE,
+        OPT_INCREMENTAL,
+        OPT_WATCH,
+        OPT_JOBS,
+        OPT_MERGE,
+        OPT_LINEARIZE,
+        OPT_FORMAT,
+        OPT_DPI,
+        OPT_FIRST_PAGE_ONLY,
+        OPT_VECTOR_BOXES,
+        OPT_TEMPLATES,
+        OPT_OVERSTRIKE,
+        OPT_FONT_COVERAGE,
+        OPT_FONT_FILE,
+        OPT_FONT_FILE_BOLD,
+        OPT_FONT_FILE_ITALIC,
+        OPT_FONT_FILE_BOLD_ITALIC,
+        OPT_TEXT,
+        OPT_LAYOUT,
+        OPT_STREAM,
+        OPT_FORM_FEED_IDLE,
+        OPT_IDLE_TIMEOUT,
+        OPT_MAX_JOB_SIZE,
+        OPT_METRICS,
+        OPT_BULK_JOBS,
+        OPT_BULK_SIZE,
+        OPT_INTERACTIVE_SLO
+    };
+}
+
 const struct option CmdLineParser::LONG_OPTIONS[] =
 {
     {"page",        required_argument,  0,  'p'},
@@ -40,25 +88,65 @@ const struct option CmdLineParser::LONG_OPTIONS[] =
     {"font-face",   required_argument,  0,  'f'},
     {"font-size",   required_argument,  0,  's'},
     {"margins",     required_argument,  0,  'm'},
+    {"split-pages", required_argument,  0,  OPT_SPLIT_PAGES},
+    {"split-on-reset", no_argument,     0,  OPT_SPLIT_ON_RESET},
+    {"stats",       no_argument,        0,  OPT_STATS},
+    {"read-ahead",  required_argument,  0,  OPT_READ_AHEAD},
+    {"read-block",  required_argument,  0,  OPT_READ_BLOCK},
+    {"save-ir",     required_argument,  0,  OPT_SAVE_IR},
+    {"load-ir",     no_argument,        0,  OPT_LOAD_IR},
+    {"render-thread", no_argument,      0,  OPT_RENDER_THREAD},
+    {"cache",       required_argument,  0,  OPT_CACHE},
+    {"cache-size",  required_argument,  0,  OPT_CACHE_SIZE},
+    {"incremental", required_argument,  0,  OPT_INCREMENTAL},
+    {"watch",       required_argument,  0,  OPT_WATCH},
+    {"jobs",        required_argument,  0,  OPT_JOBS},
+    {"merge",       no_argument,        0,  OPT_MERGE},
+    {"linearize",   no_argument,        0,  OPT_LINEARIZE},
+    {"format",      required_argument,  0,  OPT_FORMAT},
+    {"dpi",         required_argument,  0,  OPT_DPI},
+    {"first-page-only", no_argument,    0,  OPT_FIRST_PAGE_ONLY},
+    {"vector-boxes", no_argument,       0,  OPT_VECTOR_BOXES},
+    {"templates",   no_argument,        0,  OPT_TEMPLATES},
+    {"overstrike",  no_argument,        0,  OPT_OVERSTRIKE},
+    {"font-coverage", no_argument,      0,  OPT_FONT_COVERAGE},
+    {"font-file",   required_argument,  0,  OPT_FONT_FILE},
+    {"font-file-bold", required_argument, 0, OPT_FONT_FILE_BOLD},
+    {"font-file-italic", required_argument, 0, OPT_FONT_FILE_ITALIC},
+    {"font-file-bold-italic", required_argument, 0, OPT_FONT_FILE_BOLD_ITALIC},
+    {"text",        required_argument,  0,  OPT_TEXT},
+    {"layout",      required_argument,  0,  OPT_LAYOUT},
+    {"stream",      no_argument,        0,  OPT_STREAM},
+    {"form-feed-idle", required_argument, 0, OPT_FORM_FEED_IDLE},
+    {"idle-timeout", required_argument, 0,  OPT_IDLE_TIMEOUT},
+    {"max-job-size", required_argument, 0,  OPT_MAX_JOB_SIZE},
+    {"metrics",     required_argument,  0,  OPT_METRICS},
+    {"bulk-jobs",   required_argument,  0,  OPT_BULK_JOBS},
+    {"bulk-size",   required_argument,  0,  OPT_BULK_SIZE},
+    {"interactive-slo", required_argument, 0, OPT_INTERACTIVE_SLO},
     {"help",        no_argument,        0,  'h'},
     { 0, 0, 0, 0 }
 };
 
 const char *CmdLineParser::SHORT_OPTIONS="p:lo:P:t:f:s:m:h";
 
-const char *CmdLineParser::DEFAULT_FONT_FACE = "Courier New";
-const double CmdLineParser::DEFAULT_FONT_SIZE = 11.0;
-
 CmdLineParser::CmdLineParser(int argc, char* const argv[]):
     m_ProgName((argc>0 && argv[0] != nullptr)? argv[0] : "dotprint"),
-    m_PageSize(PageSizeFactory::GetDefault()),
-    m_PageMargins(MarginsFactory::GetDefault()),
-    m_Landscape(false),
-    m_Preprocessor(PreprocessorFactory::GetDefault()),
-    m_Translator(nullptr),
     m_OutputFileSet(false),
-    m_FontFace(DEFAULT_FONT_FACE),
-    m_FontSize(DEFAULT_FONT_SIZE)
+    m_Merge(false),
+    m_Stats(false),
+    m_FontCoverage(false),
+    m_ReadAheadDepth(0),
+    m_ReadBlockSize(1 << 20),
+    m_CacheSize(1024ULL << 20),
+    m_Jobs(std::max(std::thread::hardware_concurrency(), 1u)),
+    m_BulkJobs(0),
+    m_BulkSize(1 << 20),
+    m_InteractiveSlo(5000),
+    m_Stream(false),
+    m_FormFeedIdle(500),
+    m_IdleTimeout(5000),
+    m_MaxJobSize(64ULL << 20)
 {
     while (true)
     {
@@ -77,7 +165,7 @@ CmdLineParser::CmdLineParser(int argc, char* const argv[]):
 
         case 'l':
             // Set landscape mode
-            m_Landscape = true;
+            m_Settings.m_Landscape = true;
             break;
 
         case 'o':
@@ -111,6 +199,188 @@ CmdLineParser::CmdLineParser(int argc, char* const argv[]):
             SetPageMargins(optarg);
             break;
 
+        case OPT_SPLIT_PAGES:
+            // Split output every N pages
+            SetSplitPages(optarg);
+            break;
+
+        case OPT_SPLIT_ON_RESET:
+            // Split output at every ESC @
+            m_Settings.m_SplitOnReset = true;
+            break;
+
+        case OPT_STATS:
+            // Print statistics when done
+            m_Stats = true;
+            break;
+
+        case OPT_READ_AHEAD:
+            // Read input on a separate thread
+            SetReadAhead(optarg);
+            break;
+
+        case OPT_READ_BLOCK:
+            // Size of the read-ahead blocks
+            SetReadBlock(optarg);
+            break;
+
+        case OPT_SAVE_IR:
+            // Save the display list
+            m_Settings.m_SaveDisplayList = optarg;
+            break;
+
+        case OPT_LOAD_IR:
+            // Input is a saved display list
+            m_Settings.m_LoadDisplayList = true;
+            break;
+
+        case OPT_RENDER_THREAD:
+            // Render on a separate thread
+            m_Settings.m_RenderThread = true;
+            break;
+
+        case OPT_CACHE:
+            // Cache the results; only valid if they are reproducible
+            m_CacheDir = optarg;
+            m_Settings.m_Deterministic = true;
+            break;
+
+        case OPT_CACHE_SIZE:
+            // Size limit of the cache
+            SetCacheSize(optarg);
+            break;
+
+        case OPT_INCREMENTAL:
+            // Only convert what was appended since the last run
+            m_CheckpointFile = optarg;
+            break;
+
+        case OPT_WATCH:
+            // Convert files as they appear in a directory
+            m_WatchDir = optarg;
+            break;
+
+        case OPT_JOBS:
+            // Parallel conversions in watch mode
+            SetJobs(optarg);
+            break;
+
+        case OPT_MERGE:
+            // Several input files into one output file
+            m_Merge = true;
+            break;
+
+        case OPT_LINEARIZE:
+            // Fast web view
+            if (!PdfLinearizer::IsAvailable())
+            {
+                std::cerr << m_ProgName << ": --linearize is not supported, dotprint was built without qpdf." << std::endl;
+                exit(-1);
+            }
+            m_Settings.m_Linearize = true;
+            break;
+
+        case OPT_FORMAT:
+            // pdf, png or pbm
+            SetFormat(optarg);
+            break;
+
+        case OPT_DPI:
+            // Resolution of raster output
+            SetDpi(optarg);
+            break;
+
+        case OPT_FIRST_PAGE_ONLY:
+            // Preview: only the first page
+            m_Settings.m_FirstPageOnly = true;
+            break;
+
+        case OPT_VECTOR_BOXES:
+            // Box drawing characters as vector rules
+            m_Settings.m_VectorBoxes = true;
+            break;
+
+        case OPT_TEMPLATES:
+            // Repeated lines as form XObjects
+            m_Settings.m_LineTemplates = true;
+            break;
+        case OPT_OVERSTRIKE:
+            // Overstruck characters as bold and underline
+            m_Settings.m_Overstrike = true;
+            break;
+
+        case OPT_FONT_COVERAGE:
+            // Report of the characters the font lacks, once -f and -t are known
+            m_FontCoverage = true;
+            break;
+
+        case OPT_FONT_FILE:
+            // Fonts from files, no fontconfig
+            SetFontFile(m_Settings.m_FontFiles.m_Regular, optarg);
+            break;
+
+        case OPT_FONT_FILE_BOLD:
+            SetFontFile(m_Settings.m_FontFiles.m_Bold, optarg);
+            break;
+
+        case OPT_FONT_FILE_ITALIC:
+            SetFontFile(m_Settings.m_FontFiles.m_Italic, optarg);
+            break;
+
+        case OPT_FONT_FILE_BOLD_ITALIC:
+            SetFontFile(m_Settings.m_FontFiles.m_BoldItalic, optarg);
+            break;
+
+        case OPT_TEXT:
+            // Plain text sidecar
+            m_Settings.m_TextFile = optarg;
+            break;
+
+        case OPT_LAYOUT:
+            // NDJSON layout sidecar
+            m_Settings.m_LayoutFile = optarg;
+            break;
+
+        case OPT_STREAM:
+            // Endless printer port stream, one output file per job
+            m_Stream = true;
+            break;
+
+        case OPT_FORM_FEED_IDLE:
+            // Silence after a form feed that ends a job in --stream mode
+            SetMilliseconds(m_FormFeedIdle, optarg);
+            break;
+
+        case OPT_IDLE_TIMEOUT:
+            // Silence that ends a job in --stream mode
+            SetMilliseconds(m_IdleTimeout, optarg);
+            break;
+
+        case OPT_MAX_JOB_SIZE:
+            // Input size that ends a job in --stream mode
+            SetMaxJobSize(optarg);
+            break;
+
+        case OPT_METRICS:
+            // Prometheus endpoint for --watch and --stream
+            m_MetricsAddress = optarg;
+            break;
+
+        case OPT_BULK_JOBS:
+            // Parallel bulk conversions in watch and stream mode
+            SetBulkJobs(optarg);
+            break;
+
+        case OPT_BULK_SIZE:
+            // Input size of bulk jobs
+            SetBulkSize(optarg);
+            break;
+
+        case OPT_INTERACTIVE_SLO:
+            // Latency objective of interactive jobs
+            SetMilliseconds(m_InteractiveSlo, optarg);
+            break;
+
         case 'h':
             // help
             PrintHelp();
@@ -125,12 +395,89 @@ CmdLineParser::CmdLineParser(int argc, char* const argv[]):
         }
     }
 
+    const FontFilePaths &files = m_Settings.m_FontFiles;
+    if (!files.IsSet() && (!files.m_Bold.empty() || !files.m_Italic.empty() || !files.m_BoldItalic.empty()))
+    {
+        std::cerr << m_ProgName << ": --font-file-bold, --font-file-italic and --font-file-bold-italic need --font-file." << std::endl;
+        exit(-1);
+    }
+
+    if (m_FontCoverage && files.IsSet())
+    {
+        std::cerr << m_ProgName << ": --font-coverage is about fonts selected by name, not --font-file." << std::endl;
+        exit(-1);
+    }
+
+    if (m_FontCoverage)
+    {
+        PrintFontCoverage();
+        exit(0);
+    }
+
     if (!m_OutputFileSet)
     {
         std::cerr << m_ProgName << ": you must specify an output file with --output output.pdf" << std::endl;
+        std::cerr << m_ProgName << ": (or an output directory with --watch)" << std::endl;
+        exit(-1);
+    }
+
+    if (m_Settings.m_Format != OutputFormat::Pdf
+        && (m_Settings.IsSplit() || m_Settings.m_Linearize || m_Merge || !m_CheckpointFile.empty()))
+    {
+        std::cerr << m_ProgName << ": image output cannot be combined with splitting, --linearize, --merge" << std::endl;
+        std::cerr << m_ProgName << ": or --incremental." << std::endl;
+        exit(-1);
+    }
+
+    if (m_Settings.m_FirstPageOnly && m_Settings.m_Format == OutputFormat::Pdf)
+    {
+        std::cerr << m_ProgName << ": --first-page-only needs --format png or pbm." << std::endl;
+        exit(-1);
+    }
+
+    if (m_Settings.m_FirstPageOnly && m_Settings.m_RenderThread)
+    {
+        std::cerr << m_ProgName << ": --first-page-only cannot be combined with --render-thread." << std::endl;
+        exit(-1);
+    }
+
+    if (!m_MetricsAddress.empty() && m_WatchDir.empty() && !m_Stream)
+    {
+        std::cerr << m_ProgName << ": --metrics needs --watch or --stream." << std::endl;
+        exit(-1);
+    }
+
+    if (m_BulkJobs > m_Jobs)
+    {
+        std::cerr << m_ProgName << ": --bulk-jobs cannot be more than --jobs." << std::endl;
+        exit(-1);
+    }
+
+    if (m_Stream && !m_WatchDir.empty())
+    {
+        std::cerr << m_ProgName << ": --stream and --watch cannot be combined." << std::endl;
         exit(-1);
     }
 
+    if (!m_WatchDir.empty())
+    {
+        if (optind < argc)
+        {
+            std::cerr << m_ProgName << ": --watch takes no input file." << std::endl;
+            exit(-1);
+        }
+
+        if (!m_CheckpointFile.empty() || !m_Settings.m_SaveDisplayList.empty() || m_ReadAheadDepth > 0 || !m_CacheDir.empty()
+            || !m_Settings.m_TextFile.empty() || !m_Settings.m_LayoutFile.empty())
+        {
+            std::cerr << m_ProgName << ": --watch cannot be combined with --incremental, --save-ir, --read-ahead, --cache," << std::endl;
+            std::cerr << m_ProgName << ": --text or --layout." << std::endl;
+            exit(-1);
+        }
+
+        return;
+    }
+
     // optind is the index of the first file arg
     if (optind >= argc)
     {
@@ -138,58 +485,153 @@ CmdLineParser::CmdLineParser(int argc, char* const argv[]):
         exit(-1);
     }
 
-    if (optind + 1 < argc)
+    if (optind + 1 < argc && !m_Merge)
     {
-        std::cerr << m_ProgName << ": too many input files. Only single input file is allowed." << std::endl;
+        std::cerr << m_ProgName << ": too many input files. Only single input file is allowed without --merge." << std::endl;
         exit(-1);
     }
 
     m_InputFile = argv[optind];
+    m_InputFiles.assign(argv + optind, argv + argc);
+
+    if (m_Merge && (m_Settings.IsSplit() || m_Settings.m_LoadDisplayList || !m_Settings.m_SaveDisplayList.empty()
+        || m_Settings.m_RenderThread || !m_CacheDir.empty() || m_ReadAheadDepth > 0 || !m_CheckpointFile.empty()))
+    {
+        std::cerr << m_ProgName << ": --merge cannot be combined with splitting, display lists, --render-thread," << std::endl;
+        std::cerr << m_ProgName << ": --cache, --read-ahead or --incremental." << std::endl;
+        exit(-1);
+    }
+
+    if (m_Stream && (m_Merge || m_Settings.m_LoadDisplayList || !m_Settings.m_SaveDisplayList.empty() || !m_CacheDir.empty()
+        || m_ReadAheadDepth > 0 || !m_CheckpointFile.empty() || !m_Settings.m_TextFile.empty() || !m_Settings.m_LayoutFile.empty()))
+    {
+        std::cerr << m_ProgName << ": --stream cannot be combined with --merge, display lists, --cache, --read-ahead," << std::endl;
+        std::cerr << m_ProgName << ": --incremental, --text or --layout." << std::endl;
+        exit(-1);
+    }
+
+    if (!m_Settings.m_LayoutFile.empty()
+        && (m_Settings.m_LoadDisplayList || !m_Settings.m_SaveDisplayList.empty() || m_Settings.m_RenderThread))
+    {
+        // Pages rendered from a display list do not know their input offsets.
+        std::cerr << m_ProgName << ": --layout cannot be combined with display lists or --render-thread." << std::endl;
+        exit(-1);
+    }
+
+    if (!m_CheckpointFile.empty() && (!m_Settings.m_TextFile.empty() || !m_Settings.m_LayoutFile.empty()))
+    {
+        std::cerr << m_ProgName << ": --incremental cannot be combined with --text or --layout." << std::endl;
+        exit(-1);
+    }
+
+    if (m_Settings.m_LoadDisplayList && !m_Settings.m_SaveDisplayList.empty())
+    {
+        std::cerr << m_ProgName << ": --load-ir and --save-ir cannot be combined." << std::endl;
+        exit(-1);
+    }
+
+    if (!m_CheckpointFile.empty() && (m_InputFile == "-" || m_Settings.IsSplit() || m_Settings.m_LoadDisplayList
+        || !m_Settings.m_SaveDisplayList.empty() || m_Settings.m_RenderThread || !m_CacheDir.empty() || m_ReadAheadDepth > 0))
+    {
+        std::cerr << m_ProgName << ": --incremental needs an input file and cannot be combined with splitting," << std::endl;
+        std::cerr << m_ProgName << ": display lists, --render-thread, --cache or --read-ahead." << std::endl;
+        exit(-1);
+    }
 }
 
-const PageSize &CmdLineParser::GetPageSize() const
+const ConversionSettings &CmdLineParser::GetConversionSettings() const
 {
-    return m_PageSize;
+    return m_Settings;
 }
 
-const Margins &CmdLineParser::GetPageMargins() const
+const std::string &CmdLineParser::GetOutputFile() const
 {
-    return m_PageMargins;
+    return m_OutputFile;
 }
 
-bool CmdLineParser::GetLandscape() const
+const std::string &CmdLineParser::GetInputFile() const
 {
-    return m_Landscape;
+    return m_InputFile;
 }
 
-ICharPreprocessor *CmdLineParser::GetPreprocessor() const
+const std::vector<std::string> &CmdLineParser::GetInputFiles() const
 {
-    return m_Preprocessor;
+    return m_InputFiles;
 }
 
-ICodepageTranslator *CmdLineParser::GetCodepageTranslator() const
+bool CmdLineParser::GetMerge() const
 {
-    return m_Translator;
+    return m_Merge;
 }
 
-const std::string &CmdLineParser::GetOutputFile() const
+bool CmdLineParser::GetStats() const
 {
-    return m_OutputFile;
+    return m_Stats;
 }
 
-const std::string &CmdLineParser::GetInputFile() const
+unsigned CmdLineParser::GetReadAheadDepth() const
 {
-    return m_InputFile;
+    return m_ReadAheadDepth;
+}
+
+size_t CmdLineParser::GetReadBlockSize() const
+{
+    return m_ReadBlockSize;
+}
+
+const std::string &CmdLineParser::GetCacheDir() const
+{
+    return m_CacheDir;
+}
+
+uint64_t CmdLineParser::GetCacheSize() const
+{
+    return m_CacheSize;
+}
+
+const std::string &CmdLineParser::GetCheckpointFile() const
+{
+    return m_CheckpointFile;
+}
+
+const std::string &CmdLineParser::GetWatchDir() const
+{
+    return m_WatchDir;
+}
+
+SchedulerSettings CmdLineParser::GetSchedulerSettings() const
+{
+    SchedulerSettings scheduler;
+    scheduler.m_Slots = m_Jobs;
+    scheduler.m_BulkJobs = m_BulkJobs > 0 ? m_BulkJobs : m_Jobs;
+    scheduler.m_BulkSize = m_BulkSize;
+    scheduler.m_InteractiveSlo = std::chrono::milliseconds(m_InteractiveSlo);
+    return scheduler;
+}
+
+bool CmdLineParser::GetStream() const
+{
+    return m_Stream;
 }
 
-const std::string &CmdLineParser::GetFontFace() const
+std::chrono::milliseconds CmdLineParser::GetFormFeedIdle() const
 {
-    return m_FontFace;
+    return std::chrono::milliseconds(m_FormFeedIdle);
 }
 
-double CmdLineParser::GetFontSize() const
+std::chrono::milliseconds CmdLineParser::GetIdleTimeout() const
 {
-    return m_FontSize;
+    return std::chrono::milliseconds(m_IdleTimeout);
+}
+
+uint64_t CmdLineParser::GetMaxJobSize() const
+{
+    return m_MaxJobSize;
+}
+
+const std::string &CmdLineParser::GetMetricsAddress() const
+{
+    return m_MetricsAddress;
 }
 
 void CmdLineParser::SetPageSize(const char *arg)
@@ -209,7 +651,7 @@ void CmdLineParser::SetPageSize(const char *arg)
         exit(1);
     }
 
-    m_PageSize = *p;
+    m_Settings.m_PageSize = *p;
 }
 
 void CmdLineParser::SetPageMargins(const char *arg)
@@ -229,28 +671,28 @@ void CmdLineParser::SetPageMargins(const char *arg)
     switch (sscanf(arg, "%lf,%lf,%lf,%lf", &mtop, &mright, &mbottom, &mleft))
     {
         case 1:
-            m_PageMargins.m_Top = mtop * milimeter;
-            m_PageMargins.m_Right = mtop * milimeter;
-            m_PageMargins.m_Bottom = mtop * milimeter;
-            m_PageMargins.m_Left = mtop * milimeter;
+            m_Settings.m_Margins.m_Top = mtop * milimeter;
+            m_Settings.m_Margins.m_Right = mtop * milimeter;
+            m_Settings.m_Margins.m_Bottom = mtop * milimeter;
+            m_Settings.m_Margins.m_Left = mtop * milimeter;
             break;
         case 2:
-            m_PageMargins.m_Top = mtop * milimeter;
-            m_PageMargins.m_Right = mright * milimeter;
-            m_PageMargins.m_Bottom = mtop * milimeter;
-            m_PageMargins.m_Left = mright * milimeter;
+            m_Settings.m_Margins.m_Top = mtop * milimeter;
+            m_Settings.m_Margins.m_Right = mright * milimeter;
+            m_Settings.m_Margins.m_Bottom = mtop * milimeter;
+            m_Settings.m_Margins.m_Left = mright * milimeter;
             break;
         case 3:
-            m_PageMargins.m_Top = mtop * milimeter;
-            m_PageMargins.m_Right = mright * milimeter;
-            m_PageMargins.m_Bottom = mbottom * milimeter;
-            m_PageMargins.m_Left = mright * milimeter;
+            m_Settings.m_Margins.m_Top = mtop * milimeter;
+            m_Settings.m_Margins.m_Right = mright * milimeter;
+            m_Settings.m_Margins.m_Bottom = mbottom * milimeter;
+            m_Settings.m_Margins.m_Left = mright * milimeter;
             break;
         case 4:
-            m_PageMargins.m_Top = mtop * milimeter;
-            m_PageMargins.m_Right = mright * milimeter;
-            m_PageMargins.m_Bottom = mbottom * milimeter;
-            m_PageMargins.m_Left = mleft * milimeter;
+            m_Settings.m_Margins.m_Top = mtop * milimeter;
+            m_Settings.m_Margins.m_Right = mright * milimeter;
+            m_Settings.m_Margins.m_Bottom = mbottom * milimeter;
+            m_Settings.m_Margins.m_Left = mleft * milimeter;
             break;
         default:
             std::cerr << m_ProgName << ": wrong margin format: " << arg << std::endl;
@@ -268,15 +710,13 @@ void CmdLineParser::SetPreprocessor(const char *arg)
         exit(0);
     }
 
-    ICharPreprocessor *p = PreprocessorFactory::Lookup(arg);
-
-    if (!p)
+    if (!PreprocessorFactory::Lookup(arg))
     {
         std::cerr << m_ProgName << ": unknown preprocessor. Use --preprocessor list to get a list." << std::endl;
         exit(1);
     }
 
-    m_Preprocessor = p;
+    m_Settings.m_Preprocessor = arg;
 }
 
 void CmdLineParser::SetTranslator(const char *arg)
@@ -285,26 +725,176 @@ void CmdLineParser::SetTranslator(const char *arg)
 
     t->loadTable(arg);
 
-    m_Translator = t;
+    m_Settings.m_Translator = t;
 }
 
 void CmdLineParser::SetFontFace(const char *arg)
 {
-    m_FontFace = arg;
+    m_Settings.m_FontFace = arg;
+}
+
+void CmdLineParser::SetFontFile(std::string &file, const char *arg)
+{
+    if (access(arg, R_OK) != 0)
+    {
+        std::cerr << m_ProgName << ": unable to read font file \"" << arg << "\"" << std::endl;
+        exit(1);
+    }
+
+    file = arg;
 }
 
 void CmdLineParser::SetFontSize(const char *arg)
 {
-    if (sscanf(arg, "%lf", &m_FontSize) != 1)
+    if (sscanf(arg, "%lf", &m_Settings.m_FontSize) != 1)
     {
         std::cerr << m_ProgName << ": wrong font size: " << arg << std::endl;
     }
 }
 
+void CmdLineParser::SetSplitPages(const char *arg)
+{
+    if (sscanf(arg, "%u", &m_Settings.m_SplitPages) != 1)
+    {
+        std::cerr << m_ProgName << ": wrong number of pages: " << arg << std::endl;
+        exit(1);
+    }
+}
+
+void CmdLineParser::SetReadAhead(const char *arg)
+{
+    if (sscanf(arg, "%u", &m_ReadAheadDepth) != 1)
+    {
+        std::cerr << m_ProgName << ": wrong read-ahead depth: " << arg << std::endl;
+        exit(1);
+    }
+}
+
+void CmdLineParser::SetReadBlock(const char *arg)
+{
+    unsigned kb;
+
+    if (sscanf(arg, "%u", &kb) != 1 || kb == 0)
+    {
+        std::cerr << m_ProgName << ": wrong read block size: " << arg << std::endl;
+        exit(1);
+    }
+
+    m_ReadBlockSize = (size_t) kb << 10;
+}
+
+void CmdLineParser::SetCacheSize(const char *arg)
+{
+    unsigned mb;
+
+    if (sscanf(arg, "%u", &mb) != 1)
+    {
+        std::cerr << m_ProgName << ": wrong cache size: " << arg << std::endl;
+        exit(1);
+    }
+
+    m_CacheSize = (uint64_t) mb << 20;
+}
+
+void CmdLineParser::SetJobs(const char *arg)
+{
+    if (sscanf(arg, "%u", &m_Jobs) != 1 || m_Jobs == 0)
+    {
+        std::cerr << m_ProgName << ": wrong number of jobs: " << arg << std::endl;
+        exit(1);
+    }
+
+    m_Settings.m_RasterThreads = m_Jobs;
+}
+
+void CmdLineParser::SetBulkJobs(const char *arg)
+{
+    if (sscanf(arg, "%u", &m_BulkJobs) != 1 || m_BulkJobs == 0)
+    {
+        std::cerr << m_ProgName << ": wrong number of bulk jobs: " << arg << std::endl;
+        exit(1);
+    }
+}
+
+void CmdLineParser::SetBulkSize(const char *arg)
+{
+    unsigned kb;
+
+    if (sscanf(arg, "%u", &kb) != 1)
+    {
+        std::cerr << m_ProgName << ": wrong bulk size: " << arg << std::endl;
+        exit(1);
+    }
+
+    m_BulkSize = (uint64_t) kb << 10;
+}
+
+void CmdLineParser::SetMaxJobSize(const char *arg)
+{
+    unsigned kb;
+
+    if (sscanf(arg, "%u", &kb) != 1 || kb == 0)
+    {
+        std::cerr << m_ProgName << ": wrong maximum job size: " << arg << std::endl;
+        exit(1);
+    }
+
+    m_MaxJobSize = (uint64_t) kb << 10;
+}
+
+void CmdLineParser::SetMilliseconds(unsigned &value, const char *arg)
+{
+    if (sscanf(arg, "%u", &value) != 1)
+    {
+        std::cerr << m_ProgName << ": wrong time in milliseconds: " << arg << std::endl;
+        exit(1);
+    }
+}
+
+void CmdLineParser::SetFormat(const char *arg)
+{
+    if (!strcmp(arg, "pdf"))
+        m_Settings.m_Format = OutputFormat::Pdf;
+    else if (!strcmp(arg, "png"))
+        m_Settings.m_Format = OutputFormat::Png;
+    else if (!strcmp(arg, "pbm"))
+        m_Settings.m_Format = OutputFormat::Pbm;
+    else
+    {
+        std::cerr << m_ProgName << ": unknown output format: " << arg << ". Use pdf, png or pbm." << std::endl;
+        exit(1);
+    }
+}
+
+void CmdLineParser::SetDpi(const char *arg)
+{
+    if (sscanf(arg, "%lf", &m_Settings.m_Dpi) != 1 || m_Settings.m_Dpi < 1.0 || m_Settings.m_Dpi > 2400.0)
+    {
+        std::cerr << m_ProgName << ": wrong resolution: " << arg << std::endl;
+        exit(1);
+    }
+}
+
+void CmdLineParser::PrintFontCoverage()
+{
+    std::shared_ptr<const FontCoverage> coverage = FontCoverage::Get(m_Settings.m_FontFace, m_Settings.m_Translator, m_Settings.m_Preprocessor);
+    if (!coverage)
+    {
+        std::cerr << m_ProgName << ": font coverage needs fontconfig, which this build does not use." << std::endl;
+        exit(1);
+    }
+
+    coverage->Print(std::cout);
+}
+
 void CmdLineParser::PrintHelp()
 {
     std::cout << "Usage: " << m_ProgName << " [OPTION]... INPUT_FILE -o OUTPUT_FILE" << std::endl;
-    std::cout << "Convert input text file into a PDF." << std::endl << std::endl;
+    std::cout << "  or:  " << m_ProgName << " [OPTION]... --merge INPUT_FILE... -o OUTPUT_FILE" << std::endl;
+    std::cout << "  or:  " << m_ProgName << " [OPTION]... --watch DIR -o OUTPUT_DIR" << std::endl;
+    std::cout << "  or:  " << m_ProgName << " [OPTION]... --stream FIFO -o OUTPUT_TEMPLATE" << std::endl;
+    std::cout << "Convert input text file into a PDF. Use - as INPUT_FILE to read standard input." << std::endl;
+    std::cout << "gzip and zstd compressed input is decompressed on the fly." << std::endl << std::endl;
 
     std::cout << "  -o, --output        Specify output file (PDF). Required." << std::endl;
     std::cout << "  -p, --page          Specify page size." << std::endl;
@@ -314,11 +904,89 @@ void CmdLineParser::PrintHelp()
     std::cout << "                      Use \"-P list\" to see available values." << std::endl;
     std::cout << "  -t, --translator    Select codepage translator to use." << std::endl;
     std::cout << "  -f, --font-face     Font to use." << std::endl;
-    std::cout << "                      Default value: \"" << DEFAULT_FONT_FACE << "\"" << std::endl;
+    std::cout << "                      Default value: \"" << ConversionSettings::DEFAULT_FONT_FACE << "\"" << std::endl;
+    std::cout << "      --font-file     Load the font from this file (TrueType, OpenType, Type 1)" << std::endl;
+    std::cout << "                      instead of looking up --font-face. Starts faster." << std::endl;
+    std::cout << "      --font-file-bold, --font-file-italic, --font-file-bold-italic" << std::endl;
+    std::cout << "                      Files of the other styles. Without them the regular font" << std::endl;
+    std::cout << "                      is emboldened or slanted." << std::endl;
     std::cout << "  -s, --font-size     Font size to use." << std::endl;
-    std::cout << "                      Default value: " << DEFAULT_FONT_SIZE << std::endl;
+    std::cout << "                      Default value: " << ConversionSettings::DEFAULT_FONT_SIZE << std::endl;
     std::cout << "  -m, --margins       Set page margins (in millimeters)." << std::endl;
     std::cout << "                      Use \"-m formats\" to see available formats." << std::endl;
     std::cout << "                      Default value: " << MarginsFactory::DEFAULT_MARGIN_VALUE << " mm for all margins." << std::endl;
+    std::cout << "      --font-coverage Show which characters of the translator the font lacks and" << std::endl;
+    std::cout << "                      from which fonts they are drawn instead, then exit." << std::endl;
+    std::cout << "      --vector-boxes  Draw box drawing characters (table borders) and block" << std::endl;
+    std::cout << "                      characters as continuous lines and areas, not as glyphs." << std::endl;
+    std::cout << "      --templates     Store lines that repeat on many pages (headers, footers)" << std::endl;
+    std::cout << "                      only once per PDF file. Smaller and faster for long runs." << std::endl;
+    std::cout << "      --overstrike    Draw characters printed over themselves (after a carriage" << std::endl;
+    std::cout << "                      return or backspace) once in bold, underscores as underline." << std::endl;
+    std::cout << "      --text          Also write the text of the pages to the given file (UTF-8," << std::endl;
+    std::cout << "                      pages separated by form feeds), e.g. for full-text search." << std::endl;
+    std::cout << "      --layout        Also write every line of text with its page, position, style" << std::endl;
+    std::cout << "                      runs and input byte offsets to the given file (JSON lines)." << std::endl;
+    std::cout << "      --split-pages   Start a new output file every N pages." << std::endl;
+    std::cout << "                      OUTPUT_FILE out.pdf becomes out-0001.pdf, out-0002.pdf, ..." << std::endl;
+    std::cout << "                      Each file appears as soon as it is complete." << std::endl;
+    std::cout << "      --split-on-reset" << std::endl;
+    std::cout << "                      Start a new output file at every printer reset (ESC @)." << std::endl;
+    std::cout << "      --read-ahead    Read the input on a separate thread, up to N blocks ahead." << std::endl;
+    std::cout << "                      Hides the latency of slow inputs (NFS, pipes). Default: off." << std::endl;
+    std::cout << "      --read-block    Size of a read-ahead block in kB. Default value: 1024" << std::endl;
+    std::cout << "      --save-ir       Also save the parsed input (display list) to the given file." << std::endl;
+    std::cout << "      --load-ir       INPUT_FILE is a display list saved by --save-ir. It is rendered" << std::endl;
+    std::cout << "                      without parsing, -P and -t have no effect." << std::endl;
+    std::cout << "      --render-thread Parse and render on separate threads." << std::endl;
+    std::cout << "      --cache         Keep converted files in the given directory and reuse them" << std::endl;
+    std::cout << "                      for identical input and options. Not used for standard input" << std::endl;
+    std::cout << "                      and split output. Implies output without a creation date." << std::endl;
+    std::cout << "      --cache-size    Size limit of the cache in MB. Default value: 1024" << std::endl;
+    std::cout << "      --incremental   For input files that keep growing: only convert the pages added" << std::endl;
+    std::cout << "                      since the last run, using the given checkpoint file. The last" << std::endl;
+    std::cout << "                      page of OUTPUT_FILE may be incomplete and is output again" << std::endl;
+    std::cout << "                      by the next run. The input must not be compressed." << std::endl;
+    std::cout << "      --linearize     Write linearized PDF files (\"fast web view\"), so that viewers" << std::endl;
+    std::cout << "                      can show the first page before the whole file is loaded." << std::endl;
+    std::cout << "      --format        Output format: pdf, png or pbm (1 bit, e.g. for fax)." << std::endl;
+    std::cout << "                      Images are written one per page: out.png becomes" << std::endl;
+    std::cout << "                      out-0001.png, out-0002.png, ... Default value: pdf" << std::endl;
+    std::cout << "      --dpi           Resolution of images. Default value: " << ConversionSettings::DEFAULT_DPI << std::endl;
+    std::cout << "      --first-page-only" << std::endl;
+    std::cout << "                      Only write an image of the first page, to OUTPUT_FILE itself." << std::endl;
+    std::cout << "      --merge         Convert all input files into OUTPUT_FILE, each starting on a" << std::endl;
+    std::cout << "                      new page with its own bookmark. Fonts are embedded once." << std::endl;
+    std::cout << "      --watch         Convert every file that is written or moved into the given" << std::endl;
+    std::cout << "                      directory, into OUTPUT_DIR, until interrupted. Converted" << std::endl;
+    std::cout << "                      files are moved to DIR/done, files that failed to DIR/failed." << std::endl;
+    std::cout << "                      Names starting with a dot or ending in .part or .tmp are ignored." << std::endl;
+    std::cout << "      --stream        INPUT_FILE is an endless printer port stream (a FIFO, or -)." << std::endl;
+    std::cout << "                      Every print job in it is converted into its own file." << std::endl;
+    std::cout << "                      A job ends at a printer reset (ESC @) after printed text," << std::endl;
+    std::cout << "                      or when no input arrives for a while. %N in OUTPUT_TEMPLATE" << std::endl;
+    std::cout << "                      is the job number, other % sequences are as in strftime." << std::endl;
+    std::cout << "      --form-feed-idle" << std::endl;
+    std::cout << "                      Milliseconds without input after a form feed that end a" << std::endl;
+    std::cout << "                      job in --stream mode. Default value: 500" << std::endl;
+    std::cout << "      --idle-timeout  Milliseconds without input that end a job in --stream mode" << std::endl;
+    std::cout << "                      in any case. Default value: 5000" << std::endl;
+    std::cout << "      --max-job-size  Input size in kB at which a job in --stream mode ends in any" << std::endl;
+    std::cout << "                      case, at a page end from half of it on. Default value: 65536" << std::endl;
+    std::cout << "      --metrics       Serve metrics in the Prometheus text format at /metrics, with" << std::endl;
+    std::cout << "                      --watch or --stream. [HOST:]PORT (host 127.0.0.1 if not given)" << std::endl;
+    std::cout << "                      or the path of a Unix socket." << std::endl;
+    std::cout << "      --jobs          Conversions running in parallel with --watch or --stream," << std::endl;
+    std::cout << "                      or threads rasterizing pages of image output." << std::endl;
+    std::cout << "                      Default value: number of CPUs" << std::endl;
+    std::cout << "      --bulk-jobs     Bulk jobs (see --bulk-size) converting or paused at the same time" << std::endl;
+    std::cout << "                      with --watch or --stream, at most --jobs. Bulk jobs only start" << std::endl;
+    std::cout << "                      while no other job waits, and pause at the next page break when" << std::endl;
+    std::cout << "                      one arrives and all --jobs are busy. Default value: --jobs" << std::endl;
+    std::cout << "      --bulk-size     Input size in kB from which a job is a bulk job. Default value: 1024" << std::endl;
+    std::cout << "      --interactive-slo" << std::endl;
+    std::cout << "                      Milliseconds from queueing to completion other jobs should stay" << std::endl;
+    std::cout << "                      within, for the metrics. Default value: 5000" << std::endl;
+    std::cout << "      --stats         Print input size, pages, output files, time and peak memory." << std::endl;
     std::cout << "  -h, --help          Display this help." << std::endl;
 }
@@ -20,21 +20,38 @@
 #ifndef CMDLINEPARSER_H_
 #define CMDLINEPARSER_H_
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 #include "CairoTTY.h"
+#include "Converter.h"
+#include "JobScheduler.h"
 
 class CmdLineParser
 {
 public:
     CmdLineParser(int argc, char* const argv[]);
-    const PageSize &GetPageSize() const;
-    const Margins &GetPageMargins() const;
-    bool GetLandscape() const;
+    const ConversionSettings &GetConversionSettings() const;
     const std::string &GetOutputFile() const;
     const std::string &GetInputFile() const;
-    ICharPreprocessor *GetPreprocessor() const;
-    ICodepageTranslator *GetCodepageTranslator() const;
-    const std::string &GetFontFace() const;
-    double GetFontSize() const;
+
+    /** \brief All input files; more than one only with --merge. */
+    const std::vector<std::string> &GetInputFiles() const;
+    bool GetMerge() const;
+    bool GetStats() const;
+    unsigned GetReadAheadDepth() const;
+    size_t GetReadBlockSize() const;
+    const std::string &GetCacheDir() const;
+    uint64_t GetCacheSize() const;
+    const std::string &GetCheckpointFile() const;
+    const std::string &GetWatchDir() const;
+    SchedulerSettings GetSchedulerSettings() const;
+    bool GetStream() const;
+    std::chrono::milliseconds GetFormFeedIdle() const;
+    std::chrono::milliseconds GetIdleTimeout() const;
+    uint64_t GetMaxJobSize() const;
+    const std::string &GetMetricsAddress() const;
 
 protected:
     void SetPageSize(const char *arg);
@@ -42,29 +59,52 @@ protected:
     void SetPreprocessor(const char *arg);
     void SetTranslator(const char *arg);
     void SetFontFace(const char *arg);
+    void SetFontFile(std::string &file, const char *arg);
     void SetFontSize(const char *arg);
+    void SetSplitPages(const char *arg);
+    void SetReadAhead(const char *arg);
+    void SetReadBlock(const char *arg);
+    void SetCacheSize(const char *arg);
+    void SetJobs(const char *arg);
+    void SetBulkJobs(const char *arg);
+    void SetBulkSize(const char *arg);
+    void SetMaxJobSize(const char *arg);
+    void SetMilliseconds(unsigned &value, const char *arg);
+    void SetFormat(const char *arg);
+    void SetDpi(const char *arg);
 
     void PrintHelp();
+    void PrintFontCoverage();
 
 private:
     static const struct option LONG_OPTIONS[];
     static const char *SHORT_OPTIONS;
 
-    static const char *DEFAULT_FONT_FACE;
-    static const double DEFAULT_FONT_SIZE;
-
     const std::string m_ProgName;
 
-    PageSize    m_PageSize;
-    Margins     m_PageMargins;
-    bool        m_Landscape;
-    ICharPreprocessor *m_Preprocessor;
-    ICodepageTranslator *m_Translator;
+    ConversionSettings m_Settings;
     std::string m_OutputFile;
     bool m_OutputFileSet;
     std::string m_InputFile;
-    std::string m_FontFace;
-    double m_FontSize;
+    std::vector<std::string> m_InputFiles;
+    bool m_Merge;
+    bool m_Stats;
+    bool m_FontCoverage;
+    unsigned m_ReadAheadDepth;
+    size_t m_ReadBlockSize;
+    std::string m_CacheDir;
+    uint64_t m_CacheSize;
+    std::string m_CheckpointFile;
+    std::string m_WatchDir;
+    unsigned m_Jobs;
+    unsigned m_BulkJobs;
+    uint64_t m_BulkSize;
+    unsigned m_InteractiveSlo;
+    bool m_Stream;
+    unsigned m_FormFeedIdle;
+    unsigned m_IdleTimeout;
+    uint64_t m_MaxJobSize;
+    std::string m_MetricsAddress;
 };
 
 #endif /*CMDLINEPARSER_H_*/
@@ -18,6 +18,8 @@
  */
 
 #include "CodepageTranslator.h"
+#include "Hash.h"
+#include "Metrics.h"
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -28,7 +30,12 @@ void CodepageTranslator::loadTable(std::string const& tableName)
     std::fstream f(tableName, std::fstream::in);
     std::string line;
 
-    m_table.clear();
+    m_table.Clear();
+
+    // Label of the unknown byte counter: the file name without directory and extension.
+    m_Name = tableName.substr(tableName.rfind('/') + 1);
+    m_Name = m_Name.substr(0, m_Name.rfind('.'));
+    m_MetricsSlot = Metrics::RegisterTranslator(m_Name);
 
     if (!f.is_open())
     {
@@ -68,29 +75,53 @@ void CodepageTranslator::loadTable(std::string const& tableName)
             std::stringstream ss2(uni.substr(2));
             gunichar unichar;
             ss2 >> std::hex >> unichar;
-            m_table.insert({ch, unichar});
+            // The first line for a character wins.
+            gunichar existing;
+            if (!m_table.Get(ch, existing))
+                m_table.Set(ch, unichar);
         }
     }
 }
 
-bool CodepageTranslator::translate(uint8_t in, gunichar &out)
+bool CodepageTranslator::Unknown(uint8_t in) const
 {
-    bool ret = false;
-    auto search = m_table.find(in);
+    int i = in;
+    Metrics::AddUnknownByte(m_MetricsSlot);
+    std::cerr << "CodepageTranslator::translate(): Droppping unknown char 0x"
+        << std::setfill('0') << std::setw(2) << std::hex << i << std::endl;
 
-    if (search != m_table.end())
-    {
-        out = search->second;
-        ret = true;
-    }
-    else
+    return false;
+}
+
+bool CodepageTranslator::lookup(uint8_t in, gunichar &out) const
+{
+    return m_table.Get(in, out);
+}
+
+size_t CodepageTranslator::translateSpan(const uint8_t *in, size_t len, gunichar *out, std::vector<size_t> *missing) const
+{
+    return m_table.Translate(in, len, out, missing);
+}
+
+void CodepageTranslator::translateSpanUtf8(const uint8_t *in, size_t len, std::string &out, std::vector<size_t> *missing) const
+{
+    m_table.TranslateUtf8(in, len, out, missing);
+}
+
+
+uint64_t CodepageTranslator::GetFingerprint() const
+{
+    Hash64 h;
+
+    for (unsigned b = 0; b < 256; ++b)
     {
-        int i = in;
-        ret = false;
-        std::cerr << "CodepageTranslator::translate(): Droppping unknown char 0x"
-            << std::setfill('0') << std::setw(2) << std::hex << i << std::endl;
+        gunichar c;
+        if (m_table.Get((uint8_t) b, c))
+        {
+            h.Update((uint64_t) b);
+            h.Update((uint64_t) c);
+        }
     }
 
-    return ret;
+    return h.Final();
 }
-
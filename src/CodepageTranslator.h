@@ -17,21 +17,40 @@
  * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <map>
+#ifndef CODEPAGETRANSLATOR_H_
+#define CODEPAGETRANSLATOR_H_
+
 #include <sstream>
 #include <string>
 #include "CairoTTY.h"
+#include "TranslationTable.h"
 
-class CodepageTranslator : public ICodepageTranslator
+class CodepageTranslator final : public ICodepageTranslator
 {
 public:
     void loadTable(std::string const& tableName);
 
-    virtual bool translate(uint8_t in, gunichar &out);
+    virtual bool translate(uint8_t in, gunichar &out)
+    {
+        return m_table.Get(in, out) || Unknown(in);
+    }
+
+    virtual bool lookup(uint8_t in, gunichar &out) const;
+    virtual size_t translateSpan(const uint8_t *in, size_t len, gunichar *out, std::vector<size_t> *missing) const;
+    virtual void translateSpanUtf8(const uint8_t *in, size_t len, std::string &out, std::vector<size_t> *missing) const;
+    virtual uint64_t GetFingerprint() const;
 
 private:
-    typedef std::map<uint8_t, gunichar> TTransTable;
+    /** \brief Reports the byte in, which has no translation. Returns false. */
+    bool Unknown(uint8_t in) const;
+
+    TranslationTable m_table;
+
+    /** \brief Name of the table, for Metrics. */
+    std::string m_Name;
 
-    TTransTable m_table;
+    /** \brief Unknown byte counter of the table, registered by loadTable(). */
+    unsigned m_MetricsSlot = 0;
 };
 
+#endif /*CODEPAGETRANSLATOR_H_*/
@@ -0,0 +1,484 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <exception>
+#include <fstream>
+#include <ios>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "AsciiCodepageTranslator.h"
+#include "Checkpoint.h"
+#include "DecompressingInputSource.h"
+#include "Converter.h"
+#include "FontCoverage.h"
+#include "Hash.h"
+#include "JobScheduler.h"
+#include "MarginsFactory.h"
+#include "PageSizeFactory.h"
+#include "PdfOutput.h"
+#include "PreprocessorFactory.h"
+#include "RasterOutput.h"
+
+const char *ConversionSettings::DEFAULT_FONT_FACE = "Courier New";
+const double ConversionSettings::DEFAULT_FONT_SIZE = 11.0;
+const double ConversionSettings::DEFAULT_DPI = 150.0;
+
+ConversionSettings::ConversionSettings():
+    m_PageSize(PageSizeFactory::GetDefault()),
+    m_Margins(MarginsFactory::GetDefault()),
+    m_Landscape(false),
+    m_FontFace(DEFAULT_FONT_FACE),
+    m_FontSize(DEFAULT_FONT_SIZE),
+    m_VectorBoxes(false),
+    m_LineTemplates(false),
+    m_Overstrike(false),
+    m_Preprocessor(PreprocessorFactory::GetDefault()),
+    m_Translator(nullptr),
+    m_SplitPages(0),
+    m_SplitOnReset(false),
+    m_LoadDisplayList(false),
+    m_RenderThread(false),
+    m_Deterministic(false),
+    m_Linearize(false),
+    m_Format(OutputFormat::Pdf),
+    m_Dpi(DEFAULT_DPI),
+    m_FirstPageOnly(false),
+    m_RasterThreads(0)
+{}
+
+PageSize ConversionSettings::GetEffectivePageSize() const
+{
+    PageSize p = m_PageSize;
+    if (m_Landscape)
+        p.Landscape();
+
+    return p;
+}
+
+uint64_t ConversionSettings::GetFingerprint() const
+{
+    Hash64 h;
+
+    h.Update(m_Preprocessor);
+    h.Update(m_Translator ? m_Translator->GetFingerprint() : AsciiCodepageTranslator().GetFingerprint());
+    h.Update(m_FontFace);
+    h.Update(m_FontFiles.m_Regular);
+    h.Update(m_FontFiles.m_Bold);
+    h.Update(m_FontFiles.m_Italic);
+    h.Update(m_FontFiles.m_BoldItalic);
+    h.Update(m_FontSize);
+    h.Update((uint64_t) m_VectorBoxes);
+    h.Update((uint64_t) m_Overstrike);
+
+    PageSize p = GetEffectivePageSize();
+    h.Update(p.m_Width);
+    h.Update(p.m_Height);
+    h.Update(m_Margins.m_Left);
+    h.Update(m_Margins.m_Right);
+    h.Update(m_Margins.m_Top);
+    h.Update(m_Margins.m_Bottom);
+
+    return h.Final();
+}
+
+bool ConversionSettings::IsSplit() const
+{
+    return m_SplitPages > 0 || m_SplitOnReset;
+}
+
+bool ConversionSettings::IsMultiFile() const
+{
+    if (m_Format != OutputFormat::Pdf)
+        return !m_FirstPageOnly;
+
+    return IsSplit();
+}
+
+const char *ConversionSettings::GetFileExtension() const
+{
+    switch (m_Format)
+    {
+    case OutputFormat::Png:
+        return ".png";
+    case OutputFormat::Pbm:
+        return ".pbm";
+    default:
+        return ".pdf";
+    }
+}
+
+namespace
+{
+    /** \brief Renders the pages of a DisplayListRecorder right away. */
+    class RenderSink: public IDisplayPageSink
+    {
+    public:
+        explicit RenderSink(CairoTTY &ctty):
+            m_Ctty(ctty)
+        {}
+
+        virtual void AddPage(std::unique_ptr<DisplayPage> page) override
+        {
+            m_Ctty.Render(*page);
+        }
+
+    private:
+        CairoTTY &m_Ctty;
+    };
+}
+
+const size_t Converter::INPUT_BUFFER_SIZE = 1 << 16;
+const size_t Converter::RENDER_QUEUE_PAGES = 16;
+
+Converter::Converter(const ConversionSettings &settings):
+    m_Settings(settings),
+    m_StaticWrite(PreprocessorFactory::LookupStatic(settings.m_Preprocessor, settings.m_Translator))
+{}
+
+ConversionStats Converter::Convert(IInputSource &in, const std::string &outputFile)
+{
+    if (m_Settings.m_Format != OutputFormat::Pdf)
+    {
+        RasterOutput output(outputFile, m_Settings.m_Format, m_Settings.m_Dpi, m_Settings.m_FirstPageOnly, m_Settings.m_RasterThreads);
+
+        ConversionStats stats = Convert(in, output);
+        output.Finish();
+        stats.m_OutputFiles = output.GetFiles().size();
+        stats.m_OutputBytes = output.GetOutputBytes();
+        if (m_Settings.m_FirstPageOnly)
+            stats.m_Pages = 1;
+
+        return stats;
+    }
+
+    PdfFileOutput output(outputFile, m_Settings.IsSplit(), m_Settings.m_Deterministic, m_Settings.m_Linearize);
+
+    ConversionStats stats = Convert(in, output);
+    stats.m_OutputFiles = output.GetFiles().size();
+    stats.m_OutputBytes = output.GetOutputBytes();
+
+    return stats;
+}
+
+ConversionStats Converter::Convert(IInputSource &in, const Cairo::Surface::SlotWriteFunc &write)
+{
+    PdfStreamOutput output(write, m_Settings.m_Deterministic);
+
+    ConversionStats stats = Convert(in, output);
+    stats.m_OutputFiles = 1;
+    stats.m_OutputBytes = output.GetOutputBytes();
+
+    return stats;
+}
+
+ConversionStats Converter::Convert(IInputSource &in, ISurfaceProvider &output)
+{
+    ConversionStats stats;
+    std::unique_ptr<TextSidecar> sidecar(CreateSidecar());
+
+    if (m_Settings.m_LoadDisplayList)
+    {
+        DisplayListReader reader(in);
+        stats.m_Pages = Render([&reader]() { return reader.Next(); }, output, sidecar.get());
+        stats.m_InputBytes = reader.GetBytesRead();
+    }
+    else if (m_Settings.m_RenderThread)
+    {
+        DisplayPageQueue queue(RENDER_QUEUE_PAGES);
+        std::exception_ptr renderError;
+
+        // Pages are drawn, and a bulk job pauses for interactive ones, on the renderer.
+        JobScheduler *scheduler = JobScheduler::GetBulkScheduler();
+
+        std::thread renderer([&]()
+        {
+            JobScheduler::SetBulkScheduler(scheduler);
+            try
+            {
+                stats.m_Pages = Render([&queue]() { return queue.Pop(); }, output, sidecar.get());
+            }
+            catch (...)
+            {
+                renderError = std::current_exception();
+                queue.Abort(); // unblocks the parser
+            }
+        });
+
+        try
+        {
+            stats.m_InputBytes = Record(in, queue);
+        }
+        catch (...)
+        {
+            queue.Close();
+            renderer.join();
+            if (renderError)
+                std::rethrow_exception(renderError);
+            throw;
+        }
+
+        queue.Close();
+        renderer.join();
+        if (renderError)
+            std::rethrow_exception(renderError);
+    }
+    else if (!m_Settings.m_SaveDisplayList.empty())
+    {
+        std::unique_ptr<CairoTTY> ctty(CreateTTY(output, nullptr, sidecar.get()));
+        RenderSink sink(*ctty);
+
+        stats.m_InputBytes = Record(in, sink);
+        stats.m_Pages = ctty->GetPageCount();
+    }
+    else
+    {
+        std::unique_ptr<ICharPreprocessor> preproc(PreprocessorFactory::Create(m_Settings.m_Preprocessor));
+        std::unique_ptr<CairoTTY> ctty(CreateTTY(output, preproc.get(), sidecar.get()));
+        std::vector<uint8_t> buffer(INPUT_BUFFER_SIZE);
+
+        while (size_t n = in.read(buffer.data(), buffer.size()))
+        {
+            Write(*ctty, *preproc, buffer.data(), n);
+            if (stats.m_InputBytes == 0)
+                stats.m_FirstByte = std::chrono::steady_clock::now();
+            stats.m_InputBytes += n;
+
+            // The first page is complete, the rest would be thrown away.
+            if (m_Settings.m_FirstPageOnly && ctty->GetFinishedPageCount() >= 1)
+                break;
+        }
+
+        stats.m_Pages = ctty->GetPageCount();
+    } // CairoTTY closes the last surface when it goes out of scope
+
+    if (sidecar)
+        sidecar->Finish();
+
+    return stats;
+}
+
+ConversionStats Converter::ConvertMerged(const std::vector<std::string> &inputs, const std::string &outputFile)
+{
+    ConversionStats stats;
+    PdfFileOutput output(outputFile, false, m_Settings.m_Deterministic, m_Settings.m_Linearize);
+    std::unique_ptr<TextSidecar> sidecar(CreateSidecar());
+    std::vector<uint8_t> buffer(INPUT_BUFFER_SIZE);
+
+    {
+        std::unique_ptr<CairoTTY> ctty(CreateTTY(output, nullptr, sidecar.get()));
+
+        for (const std::string &inputFile : inputs)
+        {
+            FileInputSource file(inputFile);
+            DecompressingInputSource in(file);
+
+            // A fresh preprocessor, so no escape sequence or mode leaks into the next input
+            std::unique_ptr<ICharPreprocessor> preproc(PreprocessorFactory::Create(m_Settings.m_Preprocessor));
+            ctty->SetPreprocessor(preproc.get());
+            ctty->StartDocument(Glib::filename_display_basename(inputFile));
+
+            while (size_t n = in.read(buffer.data(), buffer.size()))
+            {
+                Write(*ctty, *preproc, buffer.data(), n);
+                if (stats.m_InputBytes == 0)
+                    stats.m_FirstByte = std::chrono::steady_clock::now();
+                stats.m_InputBytes += n;
+            }
+
+            ctty->SetPreprocessor(nullptr);
+        }
+
+        stats.m_Pages = ctty->GetPageCount();
+    }
+
+    if (sidecar)
+        sidecar->Finish();
+
+    stats.m_OutputFiles = 1;
+    stats.m_OutputBytes = output.GetOutputBytes();
+
+    return stats;
+}
+
+ConversionStats Converter::ConvertIncremental(FileInputSource &in, const std::string &outputFile, const std::string &checkpointFile)
+{
+    ConversionStats stats;
+    ConversionCheckpoint cp;
+    uint64_t settings = m_Settings.GetFingerprint();
+    bool resume = cp.Load(checkpointFile) && cp.m_Settings == settings;
+
+    if (resume)
+    {
+        struct stat st;
+        if (fstat(in.GetFd(), &st) != 0)
+            throw std::ios_base::failure("Unable to stat the input");
+
+        if ((uint64_t) st.st_size < cp.m_TTY.m_Offset || ConversionCheckpoint::TailHash(in.GetFd(), cp.m_TTY.m_Offset) != cp.m_TailHash)
+        {
+            std::cerr << "Input changed since the checkpoint, converting it from the start." << std::endl;
+            resume = false;
+        }
+        else if ((uint64_t) st.st_size == cp.m_TTY.m_Offset)
+        {
+            return stats; // nothing new
+        }
+    }
+
+    if (resume)
+        in.Seek(cp.m_TTY.m_Offset);
+    else
+        cp.m_TTY = TTYCheckpoint();
+
+    PdfFileOutput output(outputFile, false, m_Settings.m_Deterministic, m_Settings.m_Linearize);
+    std::unique_ptr<ICharPreprocessor> preproc(PreprocessorFactory::Create(m_Settings.m_Preprocessor));
+    std::vector<uint8_t> buffer(INPUT_BUFFER_SIZE);
+
+    {
+        std::unique_ptr<CairoTTY> ctty(CreateTTY(output, preproc.get()));
+        ctty->EnableCheckpoints();
+        ctty->Resume(cp.m_TTY);
+
+        while (size_t n = in.read(buffer.data(), buffer.size()))
+        {
+            Write(*ctty, *preproc, buffer.data(), n);
+            if (stats.m_InputBytes == 0)
+                stats.m_FirstByte = std::chrono::steady_clock::now();
+            stats.m_InputBytes += n;
+        }
+
+        stats.m_Pages = ctty->GetPageCount() - cp.m_TTY.m_Pages;
+        cp.m_TTY = ctty->GetCheckpoint();
+    }
+
+    stats.m_OutputFiles = 1;
+    stats.m_OutputBytes = output.GetOutputBytes();
+
+    // Only once the output is complete
+    cp.m_Settings = settings;
+    cp.m_TailHash = ConversionCheckpoint::TailHash(in.GetFd(), cp.m_TTY.m_Offset);
+    cp.Save(checkpointFile);
+
+    return stats;
+}
+
+std::unique_ptr<CairoTTY> Converter::CreateTTY(ISurfaceProvider &output, ICharPreprocessor *preprocessor, TextSidecar *sidecar) const
+{
+    std::shared_ptr<const FontFileSet> fonts;
+    if (m_Settings.m_FontFiles.IsSet())
+        fonts = FontFileSet::Load(m_Settings.m_FontFiles);
+
+    std::unique_ptr<CairoTTY> ctty(new CairoTTY(&output, m_Settings.GetEffectivePageSize(), m_Settings.m_Margins, preprocessor, m_Settings.m_Translator, fonts));
+    if (m_Settings.m_Format == OutputFormat::Pdf)
+        ctty->SetSplitting(m_Settings.m_SplitPages, m_Settings.m_SplitOnReset);
+    else
+        ctty->SetSplitting(1, false); // every page on a surface of its own
+    ctty->SetVectorBoxes(m_Settings.m_VectorBoxes);
+    ctty->SetOverstrike(m_Settings.m_Overstrike);
+
+    // Form XObjects only pay off in PDF; the pages of raster output are
+    // replayed on other threads and must not share surfaces.
+    ctty->SetLineTemplates(m_Settings.m_LineTemplates && m_Settings.m_Format == OutputFormat::Pdf);
+
+    ctty->SetTextSidecar(sidecar);
+
+    // Set the font
+    ctty->SetFontName(m_Settings.m_FontFace);
+    ctty->SetFontSize(m_Settings.m_FontSize);
+    if (!fonts)
+        ctty->SetFontCoverage(FontCoverage::Get(m_Settings.m_FontFace, m_Settings.m_Translator, m_Settings.m_Preprocessor));
+    ctty->UseCurrentFont();
+
+    return ctty;
+}
+
+void Converter::Write(CairoTTY &ctty, ICharPreprocessor &preprocessor, const uint8_t *buf, size_t len) const
+{
+    if (m_StaticWrite)
+        m_StaticWrite(ctty, preprocessor, m_Settings.m_Translator, buf, len);
+    else
+        ctty.write(buf, len);
+}
+
+std::unique_ptr<TextSidecar> Converter::CreateSidecar() const
+{
+    if (m_Settings.m_TextFile.empty() && m_Settings.m_LayoutFile.empty())
+        return nullptr;
+
+    return std::unique_ptr<TextSidecar>(new TextSidecar(m_Settings.m_TextFile, m_Settings.m_LayoutFile, m_Settings.m_Margins.m_Left));
+}
+
+uint64_t Converter::Record(IInputSource &in, IDisplayPageSink &sink) const
+{
+    std::unique_ptr<ICharPreprocessor> preproc(PreprocessorFactory::Create(m_Settings.m_Preprocessor));
+    std::vector<uint8_t> buffer(INPUT_BUFFER_SIZE);
+    uint64_t bytes = 0;
+
+    std::ofstream file;
+    std::unique_ptr<DisplayListWriter> writer;
+    IDisplayPageSink *target = &sink;
+
+    if (!m_Settings.m_SaveDisplayList.empty())
+    {
+        file.open(m_Settings.m_SaveDisplayList, std::ofstream::binary);
+        if (!file.is_open())
+            throw std::ios_base::failure("Unable to open \"" + m_Settings.m_SaveDisplayList + "\"");
+
+        writer.reset(new DisplayListWriter(file, &sink));
+        target = writer.get();
+    }
+
+    DisplayListRecorder recorder(*target, preproc.get(), m_Settings.m_Translator);
+
+    while (size_t n = in.read(buffer.data(), buffer.size()))
+    {
+        recorder.write(buffer.data(), n);
+        bytes += n;
+    }
+
+    recorder.Finish();
+
+    if (file.is_open())
+    {
+        file.close();
+        if (file.fail())
+            throw std::ios_base::failure("Unable to write \"" + m_Settings.m_SaveDisplayList + "\"");
+    }
+
+    return bytes;
+}
+
+unsigned Converter::Render(const std::function<std::unique_ptr<DisplayPage>()> &next, ISurfaceProvider &output, TextSidecar *sidecar) const
+{
+    std::unique_ptr<CairoTTY> ctty(CreateTTY(output, nullptr, sidecar));
+
+    while (std::unique_ptr<DisplayPage> page = next())
+    {
+        ctty->Render(*page);
+
+        // Stops reading a loaded display list, see Convert() for the input.
+        if (m_Settings.m_FirstPageOnly && ctty->GetFinishedPageCount() >= 1)
+            break;
+    }
+
+    return ctty->GetPageCount();
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONVERTER_H_
+#define CONVERTER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CairoTTY.h"
+#include "DisplayList.h"
+#include "FontFiles.h"
+#include "InputSource.h"
+#include "StaticPipeline.h"
+#include "TextSidecar.h"
+
+/** \brief Kind of files the pages are written to. */
+enum class OutputFormat
+{
+    Pdf,
+    Png,
+
+    /** \brief 1 bit per pixel, e.g. for fax. */
+    Pbm
+};
+
+/** \brief Everything that determines how an input is rendered. */
+struct ConversionSettings
+{
+    ConversionSettings();
+
+    static const char *DEFAULT_FONT_FACE;
+    static const double DEFAULT_FONT_SIZE;
+    static const double DEFAULT_DPI;
+
+    /** \brief Page size in portrait orientation. */
+    PageSize m_PageSize;
+    Margins m_Margins;
+    bool m_Landscape;
+
+    std::string m_FontFace;
+    double m_FontSize;
+
+    /** \brief Load the fonts from these files, m_FontFace is not used then. */
+    FontFilePaths m_FontFiles;
+
+    /** \brief Draw box drawing and block characters as merged vector rules. */
+    bool m_VectorBoxes;
+
+    /** \brief Store lines repeating on several pages once per PDF file, see LineTemplates. */
+    bool m_LineTemplates;
+
+    /** \brief Collapse overstruck glyphs into bold and underlined ones, see OverstrikeCompositor. */
+    bool m_Overstrike;
+
+    /** \brief Name of the preprocessor, as known to PreprocessorFactory. */
+    std::string m_Preprocessor;
+
+    /** \brief Codepage translator, nullptr means plain ASCII. Not owned. */
+    ICodepageTranslator *m_Translator;
+
+    /** \brief Start a new output file every this many pages, 0 for never. */
+    unsigned m_SplitPages;
+
+    /** \brief Start a new output file at every printer reset (ESC @). */
+    bool m_SplitOnReset;
+
+    /** \brief Also write the display list of the input to this file, if not empty. */
+    std::string m_SaveDisplayList;
+
+    /** \brief The input is a display list written earlier, not a spool. */
+    bool m_LoadDisplayList;
+
+    /** \brief Parse and render on separate threads, passing pages through a display list. */
+    bool m_RenderThread;
+
+    /** \brief Same input, same output bytes: no creation date. */
+    bool m_Deterministic;
+
+    /** \brief Write linearized ("fast web view") PDF files, see PdfLinearizer. */
+    bool m_Linearize;
+
+    /** \brief Anything but Pdf writes one image file per page, see RasterOutput. */
+    OutputFormat m_Format;
+
+    /** \brief Resolution of raster output. */
+    double m_Dpi;
+
+    /** \brief Raster output: stop after the first page, written to the output file itself. */
+    bool m_FirstPageOnly;
+
+    /** \brief Threads rasterizing pages, 0 for one per CPU. */
+    unsigned m_RasterThreads;
+
+    /** \brief Also write the text of the pages to this file, if not empty. See TextSidecar. */
+    std::string m_TextFile;
+
+    /** \brief Also write the text with positions, styles and input offsets to this file, if not empty. */
+    std::string m_LayoutFile;
+
+    /** \brief Whether the PDF output is written as a series of files. */
+    bool IsSplit() const;
+
+    /** \brief Whether the output is several files, split PDF or an image per page. */
+    bool IsMultiFile() const;
+
+    /** \brief Extension of the output files, including the dot. */
+    const char *GetFileExtension() const;
+
+    /** \brief Page size with the orientation applied. */
+    PageSize GetEffectivePageSize() const;
+
+    /** \brief Hash of every setting that affects how the pages look. */
+    uint64_t GetFingerprint() const;
+};
+
+/** \brief Summary of a single conversion. */
+struct ConversionStats
+{
+    ConversionStats():
+        m_InputBytes(0),
+        m_Pages(0),
+        m_OutputFiles(0),
+        m_OutputBytes(0),
+        m_CacheHit(false)
+    {}
+
+    uint64_t m_InputBytes;
+    unsigned m_Pages;
+    unsigned m_OutputFiles;
+    uint64_t m_OutputBytes;
+
+    /** \brief The output was taken from the ResultCache, m_Pages is not known. */
+    bool m_CacheHit;
+
+    /**
+     * \brief When the first block of input had been drawn; the epoch if
+     * nothing was drawn, or the input went through a display list.
+     */
+    std::chrono::steady_clock::time_point m_FirstByte;
+};
+
+/**
+ * \brief Runs the whole pipeline (preprocessor, translator, CairoTTY) over one input.
+ *
+ * Every call to Convert() uses a freshly created preprocessor, so a Converter
+ * can be reused for any number of inputs.
+ *
+ * The input is read in blocks of fixed size and pages are written out as
+ * they are completed, so memory use does not grow with the input size.
+ * For very large documents splitting the output (m_SplitPages) also bounds
+ * what cairo keeps per document until the file is finished.
+ *
+ * Instead of driving the CairoTTY directly the preprocessor can record into
+ * a display list (DisplayListRecorder), which is then rendered on another
+ * thread and/or saved, so that it can later be rendered again without parsing.
+ */
+class Converter
+{
+public:
+    explicit Converter(const ConversionSettings &settings);
+
+    /** \brief Converts the whole input into the PDF file outputFile (or its chunks). */
+    ConversionStats Convert(IInputSource &in, const std::string &outputFile);
+
+    /** \brief Converts the whole input, passing the PDF data to write. Never split. */
+    ConversionStats Convert(IInputSource &in, const Cairo::Surface::SlotWriteFunc &write);
+
+    /** \brief Converts the whole input onto the surfaces of output. */
+    ConversionStats Convert(IInputSource &in, ISurfaceProvider &output);
+
+    /**
+     * \brief Converts the files inputs into the single PDF file outputFile.
+     *
+     * Each input starts on a new page, with the printer state reset, and
+     * gets an outline entry named after the file. As all inputs are drawn on
+     * one surface, the fonts are embedded only once. Never split.
+     */
+    ConversionStats ConvertMerged(const std::vector<std::string> &inputs, const std::string &outputFile);
+
+    /**
+     * \brief Converts what was added to in since the checkpoint stored in checkpointFile.
+     *
+     * The pages from the checkpoint on go to outputFile, then the checkpoint
+     * is moved to the start of the last page. As that page may still grow,
+     * it is output again by the next call. Without a valid checkpoint (none
+     * yet, other settings, the input was replaced) the whole input is
+     * converted. If nothing was added, outputFile is not written at all.
+     */
+    ConversionStats ConvertIncremental(FileInputSource &in, const std::string &outputFile, const std::string &checkpointFile);
+
+private:
+    /** \brief Size of the blocks the input is read in. */
+    static const size_t INPUT_BUFFER_SIZE;
+
+    /** \brief Pages the parsing thread may get ahead of the rendering thread. */
+    static const size_t RENDER_QUEUE_PAGES;
+
+    /** \brief Creates a CairoTTY drawing on output, set up according to the settings. */
+    std::unique_ptr<CairoTTY> CreateTTY(ISurfaceProvider &output, ICharPreprocessor *preprocessor, TextSidecar *sidecar = nullptr) const;
+
+    /** \brief The sidecar for m_TextFile and m_LayoutFile, nullptr if neither is set. */
+    std::unique_ptr<TextSidecar> CreateSidecar() const;
+
+    /** \brief Records the whole input into sink (and the file m_SaveDisplayList). Returns the bytes read. */
+    uint64_t Record(IInputSource &in, IDisplayPageSink &sink) const;
+
+    /** \brief Renders pages until next returns nullptr. Returns the page count. */
+    unsigned Render(const std::function<std::unique_ptr<DisplayPage>()> &next, ISurfaceProvider &output, TextSidecar *sidecar) const;
+
+    /** \brief Feeds len bytes through preprocessor to ctty, on the static pipeline if there is one. */
+    void Write(CairoTTY &ctty, ICharPreprocessor &preprocessor, const uint8_t *buf, size_t len) const;
+
+    ConversionSettings m_Settings;
+
+    /** \brief Pipeline specialized for the preprocessor and translator, nullptr for the virtual one. */
+    StaticWriteFunc m_StaticWrite;
+};
+
+#endif /*CONVERTER_H_*/
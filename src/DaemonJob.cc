@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "DaemonJob.h"
+#include "Metrics.h"
+
+ConversionStats DaemonJob::Convert(const ConversionSettings &settings, IInputSource &in, const std::string &output)
+{
+    std::string::size_type slash = output.rfind('/');
+    std::string dir = slash == std::string::npos ? "" : output.substr(0, slash + 1);
+    std::string temp = dir + "." + output.substr(dir.size()) + ".part";
+
+    ConversionStats stats;
+
+    try
+    {
+        Converter converter(settings);
+
+        if (settings.IsMultiFile())
+        {
+            // Every chunk (page) is written under a temporary name already
+            stats = converter.Convert(in, output);
+        }
+        else
+        {
+            stats = converter.Convert(in, temp);
+            if (rename(temp.c_str(), output.c_str()) != 0)
+                throw std::ios_base::failure("Unable to rename \"" + temp + "\": " + strerror(errno));
+        }
+    }
+    catch (...)
+    {
+        unlink(temp.c_str());
+        throw;
+    }
+
+    Metrics::Add(Metrics::INPUT_BYTES, stats.m_InputBytes);
+    Metrics::Add(Metrics::PAGES, stats.m_Pages);
+    Metrics::Add(Metrics::OUTPUT_BYTES, stats.m_OutputBytes);
+
+    return stats;
+}
+
+void DaemonJob::Finish(std::chrono::steady_clock::time_point queued, bool failed, const std::string &message)
+{
+    Metrics::AddJob(std::chrono::duration<double>(std::chrono::steady_clock::now() - queued).count(), failed);
+    Log(message);
+}
+
+void DaemonJob::Log(const std::string &message)
+{
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::cerr << message << std::endl;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DAEMONJOB_H_
+#define DAEMONJOB_H_
+
+#include <chrono>
+#include <string>
+
+#include "Converter.h"
+
+/** \brief What --watch and --stream do for every job they convert. */
+class DaemonJob
+{
+public:
+    /**
+     * \brief Converts in into output and counts the bytes and pages in Metrics.
+     *
+     * output only appears once it is complete: it is written as ".NAME.part"
+     * in the same directory and then renamed (split and image output rename
+     * every file by itself). Throws like Converter::Convert(), after
+     * removing the partial file.
+     */
+    static ConversionStats Convert(const ConversionSettings &settings, IInputSource &in, const std::string &output);
+
+    /** \brief Counts the job queued at queued in Metrics and logs message. */
+    static void Finish(std::chrono::steady_clock::time_point queued, bool failed, const std::string &message);
+
+    /** \brief Writes message as a line to standard error, lines of concurrent jobs do not mix. */
+    static void Log(const std::string &message);
+};
+
+#endif /*DAEMONJOB_H_*/
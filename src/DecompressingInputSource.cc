@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <ios>
+#include <stdexcept>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "DecompressingInputSource.h"
+
+namespace
+{
+    const uint8_t GZIP_MAGIC[] = { 0x1f, 0x8b };
+    const uint8_t ZSTD_MAGIC[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+    /** \brief Size of the buffer for compressed data. */
+    const size_t COMPRESSED_BUFFER_SIZE = 1 << 16;
+
+    /** \brief Returns the bytes read ahead for detection first, then the rest of the input. */
+    class PrefixedInputSource: public IInputSource
+    {
+    public:
+        PrefixedInputSource(IInputSource &in, const uint8_t *prefix, size_t size):
+            m_In(in),
+            m_Prefix(prefix, prefix + size),
+            m_Pos(0)
+        {}
+
+        virtual size_t read(uint8_t *buf, size_t len) override
+        {
+            if (m_Pos == m_Prefix.size())
+                return m_In.read(buf, len);
+
+            size_t n = std::min(len, m_Prefix.size() - m_Pos);
+            memcpy(buf, m_Prefix.data() + m_Pos, n);
+            m_Pos += n;
+
+            return n;
+        }
+
+    private:
+        IInputSource &m_In;
+        std::vector<uint8_t> m_Prefix;
+        size_t m_Pos;
+    };
+
+#ifdef HAVE_ZLIB
+    class GzipDecoder: public IInputSource
+    {
+    public:
+        explicit GzipDecoder(IInputSource &in):
+            m_In(in),
+            m_Buffer(COMPRESSED_BUFFER_SIZE),
+            m_InputEnd(false),
+            m_InMember(false)
+        {
+            memset(&m_Stream, 0, sizeof(m_Stream));
+
+            // 16: gzip header and trailer, no raw deflate or zlib streams
+            if (inflateInit2(&m_Stream, 15 + 16) != Z_OK)
+                throw std::runtime_error("Unable to initialize zlib");
+        }
+
+        virtual ~GzipDecoder()
+        {
+            inflateEnd(&m_Stream);
+        }
+
+        virtual size_t read(uint8_t *buf, size_t len) override
+        {
+            len = std::min<size_t>(len, UINT32_MAX); // avail_out is 32 bits
+
+            m_Stream.next_out = buf;
+            m_Stream.avail_out = len;
+
+            while (m_Stream.avail_out == len)
+            {
+                if (m_Stream.avail_in == 0 && !m_InputEnd)
+                {
+                    m_Stream.next_in = m_Buffer.data();
+                    m_Stream.avail_in = m_In.read(m_Buffer.data(), m_Buffer.size());
+                    m_InputEnd = m_Stream.avail_in == 0;
+                }
+
+                if (m_Stream.avail_in == 0 && m_InputEnd)
+                {
+                    if (m_InMember)
+                        throw std::ios_base::failure("Truncated gzip input");
+                    break;
+                }
+
+                int ret = inflate(&m_Stream, Z_NO_FLUSH);
+                if (ret == Z_STREAM_END)
+                {
+                    // Another member may follow
+                    inflateReset(&m_Stream);
+                    m_InMember = false;
+                }
+                else if (ret == Z_OK || ret == Z_BUF_ERROR)
+                {
+                    m_InMember = true;
+                }
+                else
+                {
+                    throw std::ios_base::failure(std::string("Damaged gzip input: ") + (m_Stream.msg ? m_Stream.msg : zError(ret)));
+                }
+            }
+
+            return len - m_Stream.avail_out;
+        }
+
+    private:
+        IInputSource &m_In;
+        std::vector<uint8_t> m_Buffer;
+        z_stream m_Stream;
+        bool m_InputEnd;
+        bool m_InMember;
+    };
+#endif
+
+#ifdef HAVE_ZSTD
+    class ZstdDecoder: public IInputSource
+    {
+    public:
+        explicit ZstdDecoder(IInputSource &in):
+            m_In(in),
+            m_Buffer(ZSTD_DStreamInSize()),
+            m_Ctx(ZSTD_createDCtx()),
+            m_InputEnd(false),
+            m_FrameDone(true)
+        {
+            if (!m_Ctx)
+                throw std::runtime_error("Unable to initialize zstd");
+
+            m_Input.src = m_Buffer.data();
+            m_Input.size = 0;
+            m_Input.pos = 0;
+        }
+
+        virtual ~ZstdDecoder()
+        {
+            ZSTD_freeDCtx(m_Ctx);
+        }
+
+        virtual size_t read(uint8_t *buf, size_t len) override
+        {
+            ZSTD_outBuffer out = { buf, len, 0 };
+
+            while (out.pos == 0)
+            {
+                if (m_Input.pos == m_Input.size && !m_InputEnd)
+                {
+                    m_Input.size = m_In.read(m_Buffer.data(), m_Buffer.size());
+                    m_Input.pos = 0;
+                    m_InputEnd = m_Input.size == 0;
+                }
+
+                // Also called without input, to flush what the decoder holds back
+                size_t ret = ZSTD_decompressStream(m_Ctx, &out, &m_Input);
+                if (ZSTD_isError(ret))
+                    throw std::ios_base::failure(std::string("Damaged zstd input: ") + ZSTD_getErrorName(ret));
+                m_FrameDone = ret == 0;
+
+                if (out.pos == 0 && m_Input.pos == m_Input.size && m_InputEnd)
+                {
+                    if (!m_FrameDone)
+                        throw std::ios_base::failure("Truncated zstd input");
+                    break;
+                }
+            }
+
+            return out.pos;
+        }
+
+    private:
+        IInputSource &m_In;
+        std::vector<uint8_t> m_Buffer;
+        ZSTD_DCtx *m_Ctx;
+        ZSTD_inBuffer m_Input;
+        bool m_InputEnd;
+        bool m_FrameDone;
+    };
+#endif
+
+    bool StartsWith(const uint8_t *data, size_t size, const uint8_t *magic, size_t magicSize)
+    {
+        return size >= magicSize && memcmp(data, magic, magicSize) == 0;
+    }
+}
+
+DecompressingInputSource::DecompressingInputSource(IInputSource &in):
+    m_Format(Format::Plain)
+{
+    uint8_t head[sizeof(ZSTD_MAGIC)];
+    size_t size = 0;
+
+    // Short reads are normal for pipes
+    while (size < sizeof(head))
+    {
+        size_t n = in.read(head + size, sizeof(head) - size);
+        if (n == 0)
+            break;
+        size += n;
+    }
+
+    m_Raw.reset(new PrefixedInputSource(in, head, size));
+
+    if (StartsWith(head, size, GZIP_MAGIC, sizeof(GZIP_MAGIC)))
+    {
+        m_Format = Format::Gzip;
+#ifdef HAVE_ZLIB
+        m_Decoder.reset(new GzipDecoder(*m_Raw));
+#else
+        throw std::runtime_error("The input is gzip compressed, but dotprint was built without zlib");
+#endif
+    }
+    else if (StartsWith(head, size, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)))
+    {
+        m_Format = Format::Zstd;
+#ifdef HAVE_ZSTD
+        m_Decoder.reset(new ZstdDecoder(*m_Raw));
+#else
+        throw std::runtime_error("The input is zstd compressed, but dotprint was built without zstd");
+#endif
+    }
+}
+
+DecompressingInputSource::~DecompressingInputSource()
+{}
+
+size_t DecompressingInputSource::read(uint8_t *buf, size_t len)
+{
+    return m_Decoder ? m_Decoder->read(buf, len) : m_Raw->read(buf, len);
+}
+
+DecompressingInputSource::Format DecompressingInputSource::GetFormat() const
+{
+    return m_Format;
+}
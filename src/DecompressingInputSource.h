@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DECOMPRESSINGINPUTSOURCE_H_
+#define DECOMPRESSINGINPUTSOURCE_H_
+
+#include <memory>
+
+#include "InputSource.h"
+
+/**
+ * \brief Recognizes gzip and zstd compressed input by its magic bytes and
+ * decompresses it on the fly; other input is passed through unchanged.
+ *
+ * Only a small buffer of compressed data is held at any time, the
+ * decompressed input is never stored as a whole. Concatenated gzip members
+ * and zstd frames are decompressed one after another. Support for each
+ * format depends on the libraries found at build time; compressed input
+ * of a format that is not supported throws std::runtime_error.
+ */
+class DecompressingInputSource: public IInputSource
+{
+public:
+    enum class Format
+    {
+        Plain,
+        Gzip,
+        Zstd
+    };
+
+    /** \brief Reads the first bytes of in to detect the format. */
+    explicit DecompressingInputSource(IInputSource &in);
+    virtual ~DecompressingInputSource();
+
+    virtual size_t read(uint8_t *buf, size_t len) override;
+
+    Format GetFormat() const;
+
+private:
+    DecompressingInputSource(const DecompressingInputSource &) = delete;
+    DecompressingInputSource &operator=(const DecompressingInputSource &) = delete;
+
+    Format m_Format;
+
+    /** \brief in, with the bytes read for detection put back in front. */
+    std::unique_ptr<IInputSource> m_Raw;
+
+    /** \brief Decompressor reading m_Raw, nullptr for plain input. */
+    std::unique_ptr<IInputSource> m_Decoder;
+};
+
+#endif /*DECOMPRESSINGINPUTSOURCE_H_*/
@@ -0,0 +1,604 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <ios>
+#include <stdexcept>
+
+#include "DisplayList.h"
+
+namespace
+{
+    enum Opcode
+    {
+        OP_HOME = 1,
+        OP_NEW_LINE,
+        OP_CARRIAGE_RETURN,
+        OP_LINE_FEED,
+        OP_NEW_PAGE,
+        OP_INITIALIZE,
+        OP_PAGE_SIZE,       // double width, double height
+        OP_FONT_NAME,       // uint16_t length, characters
+        OP_FONT_SIZE,       // double
+        OP_FONT_WEIGHT,     // uint8_t
+        OP_FONT_SLANT,      // uint8_t
+        OP_STRETCH_FONT,    // double x, double y
+        OP_USE_CURRENT_FONT,
+        OP_GLYPHS           // uint8_t count, count code points as base 128 varints
+    };
+
+    /** \brief Longest varint of a code point (21 bits). */
+    const size_t MAX_GLYPH_SIZE = 3;
+
+    const char MAGIC[4] = { 'D', 'P', 'I', 'R' };
+    const uint32_t VERSION = 1;
+
+    /** \brief Reads the byte code of a page, throwing on truncated data. */
+    class Cursor
+    {
+    public:
+        Cursor(const uint8_t *p, const uint8_t *end):
+            m_p(p),
+            m_End(end)
+        {}
+
+        bool AtEnd() const
+        {
+            return m_p == m_End;
+        }
+
+        const uint8_t *Take(size_t len)
+        {
+            if ((size_t) (m_End - m_p) < len)
+                throw std::runtime_error("Corrupt display list");
+
+            const uint8_t *p = m_p;
+            m_p += len;
+            return p;
+        }
+
+        uint8_t Byte()
+        {
+            return *Take(1);
+        }
+
+        double Double()
+        {
+            double d;
+            memcpy(&d, Take(sizeof(d)), sizeof(d));
+            return d;
+        }
+
+        gunichar Varint()
+        {
+            gunichar c = 0;
+
+            for (unsigned shift = 0; shift < 7 * MAX_GLYPH_SIZE; shift += 7)
+            {
+                uint8_t b = Byte();
+                c |= (gunichar) (b & 0x7f) << shift;
+                if (!(b & 0x80))
+                    return c;
+            }
+
+            throw std::runtime_error("Corrupt display list");
+        }
+
+    private:
+        const uint8_t *m_p;
+        const uint8_t *m_End;
+    };
+}
+
+const size_t DisplayPage::BLOCK_SIZE = 16 << 10;
+
+DisplayPage::DisplayPage():
+    m_Run(nullptr)
+{}
+
+uint8_t *DisplayPage::Reserve(size_t len)
+{
+    if (m_Blocks.empty() || m_Blocks.back().m_Capacity - m_Blocks.back().m_Used < len)
+    {
+        Block b;
+        b.m_Capacity = std::max(BLOCK_SIZE, len);
+        b.m_Data.reset(new uint8_t[b.m_Capacity]);
+        b.m_Used = 0;
+        m_Blocks.push_back(std::move(b));
+
+        // A glyph run never continues into the next block.
+        m_Run = nullptr;
+    }
+
+    return m_Blocks.back().m_Data.get() + m_Blocks.back().m_Used;
+}
+
+void DisplayPage::Op(uint8_t op)
+{
+    *Reserve(1) = op;
+    m_Blocks.back().m_Used += 1;
+    m_Run = nullptr;
+}
+
+void DisplayPage::OpDouble(uint8_t op, double d)
+{
+    uint8_t *p = Reserve(1 + sizeof(d));
+    p[0] = op;
+    memcpy(p + 1, &d, sizeof(d));
+    m_Blocks.back().m_Used += 1 + sizeof(d);
+    m_Run = nullptr;
+}
+
+void DisplayPage::Home()
+{
+    Op(OP_HOME);
+}
+
+void DisplayPage::NewLine()
+{
+    Op(OP_NEW_LINE);
+}
+
+void DisplayPage::CarriageReturn()
+{
+    Op(OP_CARRIAGE_RETURN);
+}
+
+void DisplayPage::LineFeed()
+{
+    Op(OP_LINE_FEED);
+}
+
+void DisplayPage::NewPage()
+{
+    Op(OP_NEW_PAGE);
+}
+
+void DisplayPage::Initialize()
+{
+    Op(OP_INITIALIZE);
+}
+
+void DisplayPage::SetPageSize(const PageSize &p)
+{
+    uint8_t *q = Reserve(1 + 2 * sizeof(double));
+    q[0] = OP_PAGE_SIZE;
+    memcpy(q + 1, &p.m_Width, sizeof(double));
+    memcpy(q + 1 + sizeof(double), &p.m_Height, sizeof(double));
+    m_Blocks.back().m_Used += 1 + 2 * sizeof(double);
+    m_Run = nullptr;
+}
+
+void DisplayPage::SetFontName(const std::string &family)
+{
+    uint16_t len = (uint16_t) std::min<size_t>(family.size(), UINT16_MAX);
+
+    uint8_t *p = Reserve(1 + sizeof(len) + len);
+    p[0] = OP_FONT_NAME;
+    memcpy(p + 1, &len, sizeof(len));
+    memcpy(p + 1 + sizeof(len), family.data(), len);
+    m_Blocks.back().m_Used += 1 + sizeof(len) + len;
+    m_Run = nullptr;
+}
+
+void DisplayPage::SetFontSize(double size)
+{
+    OpDouble(OP_FONT_SIZE, size);
+}
+
+void DisplayPage::SetFontWeight(FontWeight weight)
+{
+    uint8_t *p = Reserve(2);
+    p[0] = OP_FONT_WEIGHT;
+    p[1] = (uint8_t) weight;
+    m_Blocks.back().m_Used += 2;
+    m_Run = nullptr;
+}
+
+void DisplayPage::SetFontSlant(FontSlant slant)
+{
+    uint8_t *p = Reserve(2);
+    p[0] = OP_FONT_SLANT;
+    p[1] = (uint8_t) slant;
+    m_Blocks.back().m_Used += 2;
+    m_Run = nullptr;
+}
+
+void DisplayPage::StretchFont(double stretch_x, double stretch_y)
+{
+    uint8_t *p = Reserve(1 + 2 * sizeof(double));
+    p[0] = OP_STRETCH_FONT;
+    memcpy(p + 1, &stretch_x, sizeof(double));
+    memcpy(p + 1 + sizeof(double), &stretch_y, sizeof(double));
+    m_Blocks.back().m_Used += 1 + 2 * sizeof(double);
+    m_Run = nullptr;
+}
+
+void DisplayPage::UseCurrentFont()
+{
+    Op(OP_USE_CURRENT_FONT);
+}
+
+void DisplayPage::Glyph(gunichar c)
+{
+    // Room for a run header and the glyph, so that both end up in the same block.
+    uint8_t *p = Reserve(2 + MAX_GLYPH_SIZE);
+
+    if (m_Run == nullptr || *m_Run == UINT8_MAX)
+    {
+        p[0] = OP_GLYPHS;
+        p[1] = 0;
+        m_Run = p + 1;
+        p += 2;
+        m_Blocks.back().m_Used += 2;
+    }
+
+    size_t n = 0;
+    do
+    {
+        uint8_t b = c & 0x7f;
+        c >>= 7;
+        p[n++] = c ? (b | 0x80) : b;
+    } while (c && n < MAX_GLYPH_SIZE);
+
+    m_Blocks.back().m_Used += n;
+    ++*m_Run;
+}
+
+void DisplayPage::Replay(ICairoTTYProtected &ctty) const
+{
+    for (const Block &b : m_Blocks)
+    {
+        Cursor in(b.m_Data.get(), b.m_Data.get() + b.m_Used);
+
+        while (!in.AtEnd())
+        {
+            switch (in.Byte())
+            {
+            case OP_HOME:
+                ctty.Home();
+                break;
+            case OP_NEW_LINE:
+                ctty.NewLine();
+                break;
+            case OP_CARRIAGE_RETURN:
+                ctty.CarriageReturn();
+                break;
+            case OP_LINE_FEED:
+                ctty.LineFeed();
+                break;
+            case OP_NEW_PAGE:
+                ctty.NewPage();
+                break;
+            case OP_INITIALIZE:
+                ctty.Initialize();
+                break;
+            case OP_PAGE_SIZE:
+                {
+                    double w = in.Double();
+                    double h = in.Double();
+                    ctty.SetPageSize(PageSize(w, h));
+                }
+                break;
+            case OP_FONT_NAME:
+                {
+                    uint16_t len;
+                    memcpy(&len, in.Take(sizeof(len)), sizeof(len));
+                    const char *s = (const char *) in.Take(len);
+                    ctty.SetFontName(std::string(s, len));
+                }
+                break;
+            case OP_FONT_SIZE:
+                ctty.SetFontSize(in.Double());
+                break;
+            case OP_FONT_WEIGHT:
+                ctty.SetFontWeight((FontWeight) in.Byte());
+                break;
+            case OP_FONT_SLANT:
+                ctty.SetFontSlant((FontSlant) in.Byte());
+                break;
+            case OP_STRETCH_FONT:
+                {
+                    double x = in.Double();
+                    double y = in.Double();
+                    ctty.StretchFont(x, y);
+                }
+                break;
+            case OP_USE_CURRENT_FONT:
+                ctty.UseCurrentFont();
+                break;
+            case OP_GLYPHS:
+                for (uint8_t n = in.Byte(); n > 0; --n)
+                    ctty.append(in.Varint());
+                break;
+            default:
+                throw std::runtime_error("Corrupt display list");
+            }
+        }
+    }
+}
+
+size_t DisplayPage::GetSize() const
+{
+    size_t size = 0;
+    for (const Block &b : m_Blocks)
+        size += b.m_Used;
+
+    return size;
+}
+
+void DisplayPage::Save(std::ostream &out) const
+{
+    for (const Block &b : m_Blocks)
+        out.write((const char *) b.m_Data.get(), b.m_Used);
+}
+
+void DisplayPage::Load(const uint8_t *data, size_t size)
+{
+    m_Blocks.clear();
+    m_Run = nullptr;
+
+    if (size == 0)
+        return;
+
+    memcpy(Reserve(size), data, size);
+    m_Blocks.back().m_Used += size;
+    m_Run = nullptr;
+}
+
+DisplayListRecorder::DisplayListRecorder(IDisplayPageSink &sink, ICharPreprocessor *preprocessor, ICodepageTranslator *translator):
+    m_Sink(sink),
+    m_Preprocessor(preprocessor),
+    m_CpTranslator(translator ? translator : &m_AsciiTranslator),
+    m_Page(new DisplayPage())
+{
+    if (m_Preprocessor)
+        m_Preprocessor->SetTranslator(m_CpTranslator);
+}
+
+void DisplayListRecorder::write(const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (m_Preprocessor)
+            m_Preprocessor->process(*this, buf[i]);
+        else
+            append((char) buf[i]);
+    }
+}
+
+void DisplayListRecorder::Finish()
+{
+    if (m_Page->GetSize() > 0)
+        m_Sink.AddPage(std::move(m_Page));
+
+    m_Page.reset(new DisplayPage());
+}
+
+void DisplayListRecorder::SetPageSize(const PageSize &p)
+{
+    m_Page->SetPageSize(p);
+}
+
+void DisplayListRecorder::Home()
+{
+    m_Page->Home();
+}
+
+void DisplayListRecorder::NewLine()
+{
+    m_Page->NewLine();
+}
+
+void DisplayListRecorder::CarriageReturn()
+{
+    m_Page->CarriageReturn();
+}
+
+void DisplayListRecorder::LineFeed()
+{
+    m_Page->LineFeed();
+}
+
+void DisplayListRecorder::NewPage()
+{
+    m_Page->NewPage();
+
+    // Hand the page over as soon as it is complete.
+    m_Sink.AddPage(std::move(m_Page));
+    m_Page.reset(new DisplayPage());
+}
+
+void DisplayListRecorder::Initialize()
+{
+    m_Page->Initialize();
+}
+
+void DisplayListRecorder::SetFontName(const std::string family)
+{
+    m_Page->SetFontName(family);
+}
+
+void DisplayListRecorder::SetFontSize(const double size)
+{
+    m_Page->SetFontSize(size);
+}
+
+void DisplayListRecorder::SetFontWeight(const FontWeight weight)
+{
+    m_Page->SetFontWeight(weight);
+}
+
+void DisplayListRecorder::SetFontSlant(const FontSlant slant)
+{
+    m_Page->SetFontSlant(slant);
+}
+
+void DisplayListRecorder::StretchFont(double stretch_x, double stretch_y)
+{
+    m_Page->StretchFont(stretch_x, stretch_y);
+}
+
+void DisplayListRecorder::UseCurrentFont()
+{
+    m_Page->UseCurrentFont();
+}
+
+void DisplayListRecorder::append(char c)
+{
+    gunichar uc;
+
+    if (m_CpTranslator->translate(c, uc))
+        append(uc);
+}
+
+void DisplayListRecorder::append(gunichar c)
+{
+    m_Page->Glyph(c);
+}
+
+DisplayListWriter::DisplayListWriter(std::ostream &out, IDisplayPageSink *next):
+    m_Out(out),
+    m_Next(next)
+{
+    m_Out.write(MAGIC, sizeof(MAGIC));
+    m_Out.write((const char *) &VERSION, sizeof(VERSION));
+}
+
+void DisplayListWriter::AddPage(std::unique_ptr<DisplayPage> page)
+{
+    uint32_t size = page->GetSize();
+
+    m_Out.write((const char *) &size, sizeof(size));
+    page->Save(m_Out);
+
+    if (!m_Out)
+        throw std::ios_base::failure("Unable to write the display list");
+
+    if (m_Next)
+        m_Next->AddPage(std::move(page));
+}
+
+DisplayListReader::DisplayListReader(IInputSource &in):
+    m_In(in),
+    m_BytesRead(0)
+{
+    uint8_t header[sizeof(MAGIC) + sizeof(VERSION)];
+    uint32_t version;
+
+    if (!ReadFully(header, sizeof(header)) || memcmp(header, MAGIC, sizeof(MAGIC)))
+        throw std::runtime_error("Not a display list");
+
+    memcpy(&version, header + sizeof(MAGIC), sizeof(version));
+    if (version != VERSION)
+        throw std::runtime_error("Unsupported display list version " + std::to_string(version));
+}
+
+bool DisplayListReader::ReadFully(uint8_t *buf, size_t len)
+{
+    size_t done = 0;
+
+    while (done < len)
+    {
+        size_t n = m_In.read(buf + done, len - done);
+        if (n == 0)
+        {
+            if (done == 0)
+                return false;
+            throw std::runtime_error("Truncated display list");
+        }
+        done += n;
+    }
+
+    m_BytesRead += len;
+    return true;
+}
+
+std::unique_ptr<DisplayPage> DisplayListReader::Next()
+{
+    uint32_t size;
+
+    if (!ReadFully((uint8_t *) &size, sizeof(size)))
+        return nullptr;
+
+    m_Buffer.resize(size);
+    if (size > 0 && !ReadFully(m_Buffer.data(), size))
+        throw std::runtime_error("Truncated display list");
+
+    std::unique_ptr<DisplayPage> page(new DisplayPage());
+    page->Load(m_Buffer.data(), size);
+
+    return page;
+}
+
+uint64_t DisplayListReader::GetBytesRead() const
+{
+    return m_BytesRead;
+}
+
+DisplayPageQueue::DisplayPageQueue(size_t capacity):
+    m_Capacity(std::max<size_t>(capacity, 1)),
+    m_Closed(false),
+    m_Aborted(false)
+{}
+
+void DisplayPageQueue::AddPage(std::unique_ptr<DisplayPage> page)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    m_Changed.wait(lock, [this]() { return m_Aborted || m_Pages.size() < m_Capacity; });
+    if (m_Aborted)
+        throw std::runtime_error("Rendering aborted");
+
+    m_Pages.push_back(std::move(page));
+    m_Changed.notify_all();
+}
+
+void DisplayPageQueue::Close()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Closed = true;
+    m_Changed.notify_all();
+}
+
+void DisplayPageQueue::Abort()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Aborted = true;
+    m_Pages.clear();
+    m_Changed.notify_all();
+}
+
+std::unique_ptr<DisplayPage> DisplayPageQueue::Pop()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    m_Changed.wait(lock, [this]() { return m_Closed || m_Aborted || !m_Pages.empty(); });
+    if (m_Aborted || m_Pages.empty())
+        return nullptr;
+
+    std::unique_ptr<DisplayPage> page = std::move(m_Pages.front());
+    m_Pages.pop_front();
+    m_Changed.notify_all();
+
+    return page;
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISPLAYLIST_H_
+#define DISPLAYLIST_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "AsciiCodepageTranslator.h"
+#include "CairoTTY.h"
+#include "InputSource.h"
+
+/**
+ * \brief Recorded ICairoTTYProtected calls up to and including one explicit page break.
+ *
+ * The calls are stored as a compact byte code in blocks of an arena owned
+ * by the page, an operation never spans two blocks. Consecutive characters
+ * are stored as a single glyph run. The code points are recorded already
+ * translated, layout (line wrapping, forced page breaks) is left to the
+ * CairoTTY the page is replayed into, so the same recording can be
+ * rendered with any font or page size.
+ */
+class DisplayPage
+{
+public:
+    /** \brief Size of the arena blocks. */
+    static const size_t BLOCK_SIZE;
+
+    DisplayPage();
+
+    void Home();
+    void NewLine();
+    void CarriageReturn();
+    void LineFeed();
+    void NewPage();
+    void Initialize();
+    void SetPageSize(const PageSize &p);
+    void SetFontName(const std::string &family);
+    void SetFontSize(double size);
+    void SetFontWeight(FontWeight weight);
+    void SetFontSlant(FontSlant slant);
+    void StretchFont(double stretch_x, double stretch_y);
+    void UseCurrentFont();
+    void Glyph(gunichar c);
+
+    /** \brief Calls the recorded methods on ctty, in order. */
+    void Replay(ICairoTTYProtected &ctty) const;
+
+    /** \brief Size of the byte code. */
+    size_t GetSize() const;
+
+    /** \brief Writes the byte code of the page, without any framing. */
+    void Save(std::ostream &out) const;
+
+    /** \brief Replaces the contents by size bytes of byte code written by Save(). */
+    void Load(const uint8_t *data, size_t size);
+
+private:
+    DisplayPage(const DisplayPage &) = delete;
+    DisplayPage &operator=(const DisplayPage &) = delete;
+
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> m_Data;
+        size_t m_Capacity;
+        size_t m_Used;
+    };
+
+    /** \brief Returns room for len contiguous bytes, starting a new block if needed. */
+    uint8_t *Reserve(size_t len);
+
+    void Op(uint8_t op);
+    void OpDouble(uint8_t op, double d);
+
+    std::vector<Block> m_Blocks;
+
+    /** \brief Glyph count of the run being recorded, nullptr if the last operation was not a glyph. */
+    uint8_t *m_Run;
+};
+
+/** \brief Receives the pages of a DisplayListRecorder as they are completed. */
+class IDisplayPageSink
+{
+public:
+    virtual void AddPage(std::unique_ptr<DisplayPage> page) = 0;
+
+    virtual ~IDisplayPageSink()
+    {}
+};
+
+/**
+ * \brief Stands in for CairoTTY in front of a preprocessor and records
+ * everything it is told to do.
+ */
+class DisplayListRecorder: public ICairoTTYProtected
+{
+public:
+    DisplayListRecorder(IDisplayPageSink &sink, ICharPreprocessor *preprocessor, ICodepageTranslator *translator);
+
+    /** \brief Feeds len bytes through the preprocessor. */
+    void write(const uint8_t *buf, size_t len);
+
+    /** \brief Passes the last, possibly unfinished, page to the sink. */
+    void Finish();
+
+    virtual void SetPageSize(const PageSize &p) override;
+
+    virtual void Home() override;
+    virtual void NewLine() override;
+    virtual void CarriageReturn() override;
+    virtual void LineFeed() override;
+    virtual void NewPage() override;
+    virtual void Initialize() override;
+
+    virtual void SetFontName(const std::string family) override;
+    virtual void SetFontSize(const double size) override;
+    virtual void SetFontWeight(const FontWeight weight) override;
+    virtual void SetFontSlant(const FontSlant slant) override;
+    virtual void StretchFont(double stretch_x, double stretch_y = 1.0) override;
+    virtual void UseCurrentFont() override;
+
+    virtual void append(char c) override;
+    virtual void append(gunichar c) override;
+
+private:
+    IDisplayPageSink &m_Sink;
+    ICharPreprocessor *m_Preprocessor;
+    ICodepageTranslator *m_CpTranslator;
+    AsciiCodepageTranslator m_AsciiTranslator;
+
+    std::unique_ptr<DisplayPage> m_Page;
+};
+
+/**
+ * \brief Writes pages to a display list file and passes them on to next, if set.
+ *
+ * The file starts with a header (magic and version), every page follows as
+ * a 32 bit length and its byte code. Numbers are stored in the byte order
+ * of the host, the files are meant as a cache, not for exchange.
+ */
+class DisplayListWriter: public IDisplayPageSink
+{
+public:
+    DisplayListWriter(std::ostream &out, IDisplayPageSink *next = nullptr);
+
+    virtual void AddPage(std::unique_ptr<DisplayPage> page) override;
+
+private:
+    std::ostream &m_Out;
+    IDisplayPageSink *m_Next;
+};
+
+/** \brief Reads the pages of a display list file written by DisplayListWriter. */
+class DisplayListReader
+{
+public:
+    /** \brief Checks the header, throws std::runtime_error if in is not a display list. */
+    explicit DisplayListReader(IInputSource &in);
+
+    /** \brief Returns the next page, nullptr at the end of the file. */
+    std::unique_ptr<DisplayPage> Next();
+
+    /** \brief Bytes read so far. */
+    uint64_t GetBytesRead() const;
+
+private:
+    /** \brief Reads exactly len bytes. Returns false at the end of the input, throws if it ends within. */
+    bool ReadFully(uint8_t *buf, size_t len);
+
+    IInputSource &m_In;
+    std::vector<uint8_t> m_Buffer;
+    uint64_t m_BytesRead;
+};
+
+/**
+ * \brief Hands pages from the parsing thread over to a rendering thread.
+ *
+ * At most capacity pages are queued, AddPage() blocks while the queue is full.
+ */
+class DisplayPageQueue: public IDisplayPageSink
+{
+public:
+    explicit DisplayPageQueue(size_t capacity);
+
+    /** \brief Queues page. Throws std::runtime_error if the consumer has aborted. */
+    virtual void AddPage(std::unique_ptr<DisplayPage> page) override;
+
+    /** \brief No more pages will be added. */
+    void Close();
+
+    /** \brief The consumer gives up, pending and further pages are dropped. */
+    void Abort();
+
+    /** \brief Waits for the next page, returns nullptr once the queue is closed and empty. */
+    std::unique_ptr<DisplayPage> Pop();
+
+private:
+    size_t m_Capacity;
+    bool m_Closed;
+    bool m_Aborted;
+    std::deque<std::unique_ptr<DisplayPage>> m_Pages;
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+};
+
+#endif /*DISPLAYLIST_H_*/
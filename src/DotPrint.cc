@@ -17,52 +17,174 @@
  * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <iomanip>
 #include <iostream>
-#include <fstream>
-#include <stdexcept>
+#include <memory>
 
-#include <assert.h>
+#include <stdlib.h>
+#include <sys/resource.h>
 
-#include <getopt.h>
-
-#include "CairoTTY.h"
-#include "PageSizeFactory.h"
 #include "CmdLineParser.h"
+#include "Converter.h"
+#include "DecompressingInputSource.h"
+#include "FontCoverage.h"
+#include "InputSource.h"
+#include "MetricsServer.h"
+#include "PrinterStream.h"
+#include "ReadAheadInputSource.h"
+#include "ResultCache.h"
+#include "SpoolWatcher.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * \brief When the process started: DOTPRINT_EXEC_TIME, set by whoever
+     * started it (nanoseconds of the monotonic clock, as dotprint_bench does),
+     * or else the start of main().
+     */
+    Clock::time_point ProcessStart()
+    {
+        Clock::time_point start = Clock::now();
+
+        if (const char *exec = getenv("DOTPRINT_EXEC_TIME"))
+        {
+            Clock::time_point t(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(strtoll(exec, nullptr, 10))));
+            if (t <= start)
+                start = t;
+        }
+
+        return start;
+    }
+
+    void PrintStats(const ConversionStats &stats, Clock::time_point start)
+    {
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+
+        std::cerr << "input bytes:  " << stats.m_InputBytes << std::endl;
+        if (stats.m_CacheHit)
+            std::cerr << "pages:        (cached)" << std::endl;
+        else
+            std::cerr << "pages:        " << stats.m_Pages << std::endl;
+        std::cerr << "output files: " << stats.m_OutputFiles << std::endl;
+        std::cerr << "output bytes: " << stats.m_OutputBytes << std::endl;
+        if (stats.m_FirstByte != Clock::time_point())
+            std::cerr << "startup:      " << std::chrono::duration<double>(stats.m_FirstByte - start).count() << " s" << std::endl;
+        std::cerr << "time:         " << seconds << " s" << std::endl;
+        std::cerr << "peak RSS:     " << ru.ru_maxrss << " kB" << std::endl;
+    }
+
+    /** \brief Tells before converting which characters of the translator no installed font has. */
+    void WarnUncovered(const char *prog, const ConversionSettings &settings)
+    {
+        if (settings.m_FontFiles.IsSet())
+            return; // no fontconfig, no fallback fonts
+
+        std::shared_ptr<const FontCoverage> coverage = FontCoverage::Get(settings.m_FontFace, settings.m_Translator, settings.m_Preprocessor);
+        if (!coverage || coverage->GetUncovered().empty())
+            return;
+
+        std::cerr << prog << ": warning: no font has";
+        for (gunichar c : coverage->GetUncovered())
+            std::cerr << " U+" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << c;
+        std::cerr << std::dec << std::setfill(' ') << ", see --font-coverage" << std::endl;
+    }
+}
 
 int main(int argc, char *argv[])
 {
+    Clock::time_point start = ProcessStart();
     CmdLineParser cmdline(argc, argv);
 
-    PageSize p = cmdline.GetPageSize();
-    if (cmdline.GetLandscape())
-        p.Landscape();
+    const ConversionSettings &settings = cmdline.GetConversionSettings();
+
+    if (!cmdline.GetWatchDir().empty())
+    {
+        WarnUncovered(argv[0], settings);
+        SpoolWatcher watcher(cmdline.GetWatchDir(), cmdline.GetOutputFile(), settings, cmdline.GetSchedulerSettings());
+        std::unique_ptr<MetricsServer> metrics;
+        if (!cmdline.GetMetricsAddress().empty())
+            metrics.reset(new MetricsServer(cmdline.GetMetricsAddress(), &watcher.GetScheduler()));
+        watcher.Run();
+        return 0;
+    }
+
+    if (cmdline.GetStream())
+    {
+        WarnUncovered(argv[0], settings);
+        PrinterStream stream(cmdline.GetInputFile(), cmdline.GetOutputFile(), settings, cmdline.GetSchedulerSettings(),
+            cmdline.GetFormFeedIdle(), cmdline.GetIdleTimeout(), cmdline.GetMaxJobSize());
+        std::unique_ptr<MetricsServer> metrics;
+        if (!cmdline.GetMetricsAddress().empty())
+            metrics.reset(new MetricsServer(cmdline.GetMetricsAddress(), &stream.GetScheduler()));
+        stream.Run();
+        return 0;
+    }
 
-    ICharPreprocessor *preproc = cmdline.GetPreprocessor();
-    ICodepageTranslator *translator = cmdline.GetCodepageTranslator();
+    if (cmdline.GetMerge())
+    {
+        WarnUncovered(argv[0], settings);
+        ConversionStats stats = Converter(settings).ConvertMerged(cmdline.GetInputFiles(), cmdline.GetOutputFile());
+        if (cmdline.GetStats())
+            PrintStats(stats, start);
+        return 0;
+    }
 
-    Cairo::RefPtr<Cairo::PdfSurface> cs = Cairo::PdfSurface::create(cmdline.GetOutputFile(), p.m_Width, p.m_Height);
-    assert(cs);
+    std::unique_ptr<ResultCache> cache;
+    uint64_t key = 0;
+    if (!cmdline.GetCacheDir().empty() && ResultCache::IsCacheable(cmdline.GetInputFile(), settings))
+    {
+        cache.reset(new ResultCache(cmdline.GetCacheDir(), cmdline.GetCacheSize()));
+        key = ResultCache::Key(cmdline.GetInputFile(), settings);
 
-    Margins m = cmdline.GetPageMargins();
+        ConversionStats stats;
+        if (cache->Fetch(key, cmdline.GetOutputFile(), stats))
+        {
+            if (cmdline.GetStats())
+                PrintStats(stats, start);
+            return 0;
+        }
+    }
 
-    CairoTTY ctty(cs, p, m, preproc, translator);
+    // Not on cache hits, they draw nothing.
+    WarnUncovered(argv[0], settings);
 
-    // Set the font
-    ctty.SetFontName(cmdline.GetFontFace());
-    ctty.SetFontSize(cmdline.GetFontSize());
-    ctty.UseCurrentFont();
+    FileInputSource file(cmdline.GetInputFile());
+    IInputSource *in = &file;
 
-    std::fstream f(cmdline.GetInputFile(), std::fstream::in | std::fstream::binary);
-    if (!f.is_open())
+    // Input offsets of --incremental refer to the file itself.
+    std::unique_ptr<DecompressingInputSource> decompressed;
+    if (cmdline.GetCheckpointFile().empty())
     {
-        throw std::ios_base::failure("Unable to open file \"" + cmdline.GetInputFile() + "\"");
+        decompressed.reset(new DecompressingInputSource(*in));
+        in = decompressed.get();
     }
-    char c;
-    while (!f.get(c).eof())
+
+    // Decompression, if any, then happens on the read-ahead thread too.
+    std::unique_ptr<ReadAheadInputSource> readAhead;
+    if (cmdline.GetReadAheadDepth() > 0)
     {
-        uint8_t uc = (uint8_t) c;
-        ctty << uc;
+        readAhead.reset(new ReadAheadInputSource(*in, cmdline.GetReadAheadDepth(), cmdline.GetReadBlockSize()));
+        in = readAhead.get();
     }
 
+    Converter converter(settings);
+    ConversionStats stats;
+
+    if (!cmdline.GetCheckpointFile().empty())
+        stats = converter.ConvertIncremental(file, cmdline.GetOutputFile(), cmdline.GetCheckpointFile());
+    else
+        stats = converter.Convert(*in, cmdline.GetOutputFile());
+
+    if (cache)
+        cache->Store(key, cmdline.GetOutputFile());
+
+    if (cmdline.GetStats())
+        PrintStats(stats, start);
+
     return 0;
 }
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#ifdef HAVE_FONTCONFIG
+#include <fontconfig/fontconfig.h>
+#endif
+
+#include "AsciiCodepageTranslator.h"
+#include "FontCoverage.h"
+#include "Metrics.h"
+#include "PreprocessorFactory.h"
+
+namespace
+{
+    /** \brief Printable characters translator produces, in byte order. */
+    std::vector<gunichar> TranslatedChars(const ICodepageTranslator &translator)
+    {
+        std::vector<gunichar> chars;
+
+        for (unsigned b = 0; b < 256; ++b)
+        {
+            gunichar c;
+            if (translator.lookup((uint8_t) b, c) && c != 0x09 && !Glib::Unicode::iscntrl(c))
+                chars.push_back(c);
+        }
+
+        return chars;
+    }
+
+#ifdef HAVE_FONTCONFIG
+    std::string FamilyOf(FcPattern *font)
+    {
+        FcChar8 *family = nullptr;
+        if (FcPatternGetString(font, FC_FAMILY, 0, &family) != FcResultMatch)
+            return std::string();
+
+        return (const char *) family;
+    }
+#endif
+}
+
+FontCoverage::Fallback::Fallback(const std::string &family):
+    m_Family(family)
+{
+    for (int style = 0; style < 4; ++style)
+    {
+        m_Faces[style] = cairo_toy_font_face_create(family.c_str(),
+            (style & 2) ? CAIRO_FONT_SLANT_ITALIC : CAIRO_FONT_SLANT_NORMAL,
+            (style & 1) ? CAIRO_FONT_WEIGHT_BOLD : CAIRO_FONT_WEIGHT_NORMAL);
+    }
+}
+
+FontCoverage::Fallback::~Fallback()
+{
+    for (cairo_font_face_t *face : m_Faces)
+        cairo_font_face_destroy(face);
+}
+
+FontCoverage::FontCoverage():
+    m_MaybeMissing(0x10000, false)
+{}
+
+std::shared_ptr<const FontCoverage> FontCoverage::Get(const std::string &family, const ICodepageTranslator *translator,
+    const std::string &preprocessor)
+{
+#ifdef HAVE_FONTCONFIG
+    typedef std::tuple<std::string, uint64_t, std::string> Key;
+    static std::mutex mutex;
+    static std::map<Key, std::shared_ptr<const FontCoverage>> cache;
+
+    AsciiCodepageTranslator ascii;
+    if (!translator)
+        translator = &ascii;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Key key(family, translator->GetFingerprint(), preprocessor);
+    std::map<Key, std::shared_ptr<const FontCoverage>>::iterator i = cache.find(key);
+    if (i != cache.end())
+    {
+        Metrics::Add(Metrics::FONT_CACHE_HITS);
+        return i->second;
+    }
+    Metrics::Add(Metrics::FONT_CACHE_MISSES);
+
+    std::shared_ptr<FontCoverage> coverage(new FontCoverage());
+    coverage->m_Family = family;
+    coverage->m_Chars = TranslatedChars(*translator);
+
+    // Characters of tables the preprocessor switches to, ESC R for epson
+    std::unique_ptr<ICharPreprocessor> p = PreprocessorFactory::Create(preprocessor);
+    std::vector<gunichar> extra;
+    if (p)
+        p->GetExtraChars(extra);
+    for (gunichar c : extra)
+    {
+        if (std::find(coverage->m_Chars.begin(), coverage->m_Chars.end(), c) == coverage->m_Chars.end())
+            coverage->m_Chars.push_back(c);
+    }
+
+    // The same resolution cairo's toy font API does
+    FcPattern *pattern = FcNameParse((const FcChar8 *) family.c_str());
+    FcConfigSubstitute(nullptr, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+
+    FcResult result;
+    FcPattern *match = FcFontMatch(nullptr, pattern, &result);
+    FcCharSet *charset = nullptr;
+
+    if (match)
+    {
+        coverage->m_Font = FamilyOf(match);
+        FcPatternGetCharSet(match, FC_CHARSET, 0, &charset);
+    }
+
+    FcFontSet *candidates = nullptr;
+
+    for (gunichar c : coverage->m_Chars)
+    {
+        if (charset && FcCharSetHasChar(charset, c))
+            continue;
+
+        // Fonts ordered by how close they are to the requested one
+        if (!candidates)
+            candidates = FcFontSort(nullptr, pattern, FcFalse, nullptr, &result);
+
+        std::string fallback;
+        for (int f = 0; candidates && f < candidates->nfont; ++f)
+        {
+            FcCharSet *cs = nullptr;
+            if (FcPatternGetCharSet(candidates->fonts[f], FC_CHARSET, 0, &cs) == FcResultMatch && FcCharSetHasChar(cs, c))
+            {
+                fallback = FamilyOf(candidates->fonts[f]);
+                break;
+            }
+        }
+
+        if (fallback.empty())
+        {
+            coverage->m_Uncovered.push_back(c);
+            continue;
+        }
+
+        std::unique_ptr<Fallback> &font = coverage->m_Fonts[fallback];
+        if (!font)
+            font.reset(new Fallback(fallback));
+
+        coverage->m_Fallbacks[c] = font.get();
+        if (c < coverage->m_MaybeMissing.size())
+            coverage->m_MaybeMissing[c] = true;
+    }
+
+    if (candidates)
+        FcFontSetDestroy(candidates);
+    if (match)
+        FcPatternDestroy(match);
+    FcPatternDestroy(pattern);
+
+    cache[key] = coverage;
+    return coverage;
+#else
+    (void) family;
+    (void) translator;
+    (void) preprocessor;
+    return nullptr;
+#endif
+}
+
+const std::vector<gunichar> &FontCoverage::GetUncovered() const
+{
+    return m_Uncovered;
+}
+
+void FontCoverage::Print(std::ostream &out) const
+{
+    out << "font: " << m_Font << std::endl;
+    out << "characters: " << m_Chars.size() << ", from other fonts: " << m_Fallbacks.size()
+        << ", missing: " << m_Uncovered.size() << std::endl;
+
+    for (gunichar c : m_Chars)
+    {
+        std::unordered_map<gunichar, const Fallback *>::const_iterator i = m_Fallbacks.find(c);
+        if (i != m_Fallbacks.end())
+            out << "  U+" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << c
+                << std::dec << " " << Glib::ustring(1, c).raw() << "  " << i->second->GetFamily() << std::endl;
+    }
+
+    for (gunichar c : m_Uncovered)
+        out << "  U+" << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << c
+            << std::dec << "    (none)" << std::endl;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FONTCOVERAGE_H_
+#define FONTCOVERAGE_H_
+
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CairoTTY.h"
+
+/**
+ * \brief Which of the characters a translation table produces a font lacks,
+ * and which font to draw each of them with instead.
+ *
+ * Computed once per font and table with fontconfig: the charset of the
+ * font the family name resolves to is checked for every code point the
+ * table translates a byte to; for each missing one the closest font that
+ * has it is looked up, and its faces are created. So drawing never
+ * searches for a font, and the gaps are known before the first page.
+ *
+ * Without fontconfig nothing is known, Get() returns nullptr.
+ */
+class FontCoverage
+{
+public:
+    /** \brief A font missing characters are drawn with instead. */
+    class Fallback
+    {
+    public:
+        explicit Fallback(const std::string &family);
+        ~Fallback();
+
+        const std::string &GetFamily() const
+        {
+            return m_Family;
+        }
+
+        /** \brief The face of the family for the style, owned by the fallback. */
+        cairo_font_face_t *GetFace(FontWeight weight, FontSlant slant) const
+        {
+            return m_Faces[(weight == FontWeight::Bold ? 1 : 0) | (slant == FontSlant::Italic ? 2 : 0)];
+        }
+
+    private:
+        Fallback(const Fallback &) = delete;
+        Fallback &operator=(const Fallback &) = delete;
+
+        std::string m_Family;
+
+        /** \brief Regular, bold, italic, bold italic. */
+        cairo_font_face_t *m_Faces[4];
+    };
+
+    /**
+     * \brief The coverage of family for translator (nullptr for ASCII) and
+     * the extra characters of the preprocessor, by PreprocessorFactory name.
+     *
+     * Results are kept per family, table contents and preprocessor, so
+     * further calls (other jobs of the same process) cost a lookup. Thread safe.
+     */
+    static std::shared_ptr<const FontCoverage> Get(const std::string &family, const ICodepageTranslator *translator,
+        const std::string &preprocessor);
+
+    /** \brief The family name coverage was computed for. */
+    const std::string &GetFamily() const
+    {
+        return m_Family;
+    }
+
+    /** \brief Font to draw c with, nullptr if the font has c (or no font has it). */
+    const Fallback *GetFallback(gunichar c) const
+    {
+        // Most characters are covered, a bit tells.
+        if (c < m_MaybeMissing.size() && !m_MaybeMissing[c])
+            return nullptr;
+
+        std::unordered_map<gunichar, const Fallback *>::const_iterator i = m_Fallbacks.find(c);
+        return i != m_Fallbacks.end() ? i->second : nullptr;
+    }
+
+    /** \brief Characters no font has. */
+    const std::vector<gunichar> &GetUncovered() const;
+
+    /** \brief Lists the matched font and every missing character with its fallback. */
+    void Print(std::ostream &out) const;
+
+private:
+    FontCoverage();
+
+    std::string m_Family;
+
+    /** \brief Family the requested name resolved to. */
+    std::string m_Font;
+
+    /** \brief Characters the table produces. */
+    std::vector<gunichar> m_Chars;
+
+    std::unordered_map<gunichar, const Fallback *> m_Fallbacks;
+
+    /** \brief The fonts of m_Fallbacks, by family. */
+    std::map<std::string, std::unique_ptr<Fallback>> m_Fonts;
+    std::vector<gunichar> m_Uncovered;
+
+    /** \brief Set for the characters of the BMP in m_Fallbacks. */
+    std::vector<bool> m_MaybeMissing;
+};
+
+#endif /*FONTCOVERAGE_H_*/
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+#ifdef HAVE_FREETYPE
+#include <cairo-ft.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#endif
+
+#include "FontFiles.h"
+#include "Metrics.h"
+
+namespace
+{
+    enum Style
+    {
+        STYLE_BOLD = 1,
+        STYLE_ITALIC = 2
+    };
+
+#ifdef HAVE_FREETYPE
+    /** \brief The style whose file style is drawn with, the closest one given. */
+    int SourceStyle(const std::string *const files[4], int style)
+    {
+        if (!files[style]->empty())
+            return style;
+
+        if (style == (STYLE_BOLD | STYLE_ITALIC))
+        {
+            if (!files[STYLE_BOLD]->empty())
+                return STYLE_BOLD;
+            if (!files[STYLE_ITALIC]->empty())
+                return STYLE_ITALIC;
+        }
+
+        return 0;
+    }
+
+    /** \brief Ties the lifetime of an FT_Face to the cairo face made of it. */
+    const cairo_user_data_key_t FT_FACE_KEY = {};
+
+    void DoneFace(void *face)
+    {
+        FT_Done_Face((FT_Face) face);
+    }
+
+    /** \brief Loads the first face of path, synthesizing the styles in synthesize it lacks. */
+    cairo_font_face_t *LoadFace(FT_Library library, const std::string &path, int synthesize)
+    {
+        FT_Face face;
+        if (FT_New_Face(library, path.c_str(), 0, &face) != 0)
+            throw std::runtime_error("Unable to load font file \"" + path + "\"");
+
+        cairo_font_face_t *cf = cairo_ft_font_face_create_for_ft_face(face, 0);
+        if (cairo_font_face_set_user_data(cf, &FT_FACE_KEY, face, &DoneFace) != CAIRO_STATUS_SUCCESS)
+        {
+            cairo_font_face_destroy(cf);
+            FT_Done_Face(face);
+            throw std::runtime_error("Unable to use font file \"" + path + "\"");
+        }
+
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 12, 0)
+        unsigned flags = 0;
+        if ((synthesize & STYLE_BOLD) && !(face->style_flags & FT_STYLE_FLAG_BOLD))
+            flags |= CAIRO_FT_SYNTHESIZE_BOLD;
+        if ((synthesize & STYLE_ITALIC) && !(face->style_flags & FT_STYLE_FLAG_ITALIC))
+            flags |= CAIRO_FT_SYNTHESIZE_OBLIQUE;
+        cairo_ft_font_face_set_synthesize(cf, flags);
+#else
+        (void) synthesize; // styles without a file look regular
+#endif
+
+        return cf;
+    }
+#endif
+}
+
+FontFileSet::FontFileSet():
+    m_Faces()
+{}
+
+FontFileSet::~FontFileSet()
+{
+    for (cairo_font_face_t *face : m_Faces)
+        if (face)
+            cairo_font_face_destroy(face);
+}
+
+std::shared_ptr<const FontFileSet> FontFileSet::Load(const FontFilePaths &paths)
+{
+#ifdef HAVE_FREETYPE
+    typedef std::tuple<std::string, std::string, std::string, std::string> Key;
+
+    static std::mutex mutex;
+    static FT_Library library = nullptr;
+    static std::map<Key, std::shared_ptr<const FontFileSet>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Key key(paths.m_Regular, paths.m_Bold, paths.m_Italic, paths.m_BoldItalic);
+    std::map<Key, std::shared_ptr<const FontFileSet>>::iterator i = cache.find(key);
+    if (i != cache.end())
+    {
+        Metrics::Add(Metrics::FONT_CACHE_HITS);
+        return i->second;
+    }
+    Metrics::Add(Metrics::FONT_CACHE_MISSES);
+
+    // Kept for the lifetime of the process, like the faces in the cache.
+    if (!library && FT_Init_FreeType(&library) != 0)
+        throw std::runtime_error("Unable to initialize FreeType");
+
+    std::shared_ptr<FontFileSet> set(new FontFileSet());
+    const std::string *files[4] = { &paths.m_Regular, &paths.m_Bold, &paths.m_Italic, &paths.m_BoldItalic };
+
+    for (int style = 0; style < 4; ++style)
+    {
+        int from = SourceStyle(files, style);
+
+        // Every style a face of its own, synthesis is a property of the face.
+        set->m_Faces[style] = LoadFace(library, *files[from], style & ~from);
+    }
+
+    cache[key] = set;
+    return set;
+#else
+    (void) paths;
+    throw std::runtime_error("Font files are not supported, dotprint was built without FreeType");
+#endif
+}
+
+cairo_font_face_t *FontFileSet::GetFace(Cairo::FontSlant slant, Cairo::FontWeight weight) const
+{
+    int style = 0;
+    if (weight == Cairo::FONT_WEIGHT_BOLD)
+        style |= STYLE_BOLD;
+    if (slant != Cairo::FONT_SLANT_NORMAL)
+        style |= STYLE_ITALIC;
+
+    return m_Faces[style];
+}
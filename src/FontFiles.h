@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FONTFILES_H_
+#define FONTFILES_H_
+
+#include <memory>
+#include <string>
+
+#include <cairomm/cairomm.h>
+
+/** \brief Font files for the four styles, empty if not given. */
+struct FontFilePaths
+{
+    std::string m_Regular;
+    std::string m_Bold;
+    std::string m_Italic;
+    std::string m_BoldItalic;
+
+    /** \brief Whether fonts are loaded from files instead of by name. */
+    bool IsSet() const
+    {
+        return !m_Regular.empty();
+    }
+};
+
+/**
+ * \brief Font faces loaded from files with FreeType, bypassing fontconfig.
+ *
+ * Selecting a font by name initializes fontconfig and matches the name
+ * against every installed font, which for short jobs takes longer than
+ * the conversion itself. A face loaded from a file costs opening the file.
+ *
+ * A style without a file of its own is synthesized from the regular face
+ * (emboldened, slanted).
+ */
+class FontFileSet
+{
+public:
+    /**
+     * \brief The faces of paths, loaded on the first call for them.
+     *
+     * Thread safe. Throws std::runtime_error if a file cannot be loaded,
+     * or if dotprint was built without FreeType.
+     */
+    static std::shared_ptr<const FontFileSet> Load(const FontFilePaths &paths);
+
+    ~FontFileSet();
+
+    /** \brief The face for the style, owned by the set. */
+    cairo_font_face_t *GetFace(Cairo::FontSlant slant, Cairo::FontWeight weight) const;
+
+private:
+    FontFileSet();
+    FontFileSet(const FontFileSet &) = delete;
+    FontFileSet &operator=(const FontFileSet &) = delete;
+
+    /** \brief Regular, bold, italic, bold italic. */
+    cairo_font_face_t *m_Faces[4];
+};
+
+#endif /*FONTFILES_H_*/
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "Hash.h"
+
+namespace
+{
+    const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t Rotl(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64_t Read64(const uint8_t *p)
+    {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint32_t Read32(const uint8_t *p)
+    {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint64_t Round(uint64_t acc, uint64_t input)
+    {
+        acc += input * PRIME2;
+        acc = Rotl(acc, 31);
+        return acc * PRIME1;
+    }
+
+    inline uint64_t MergeRound(uint64_t acc, uint64_t val)
+    {
+        acc ^= Round(0, val);
+        return acc * PRIME1 + PRIME4;
+    }
+
+    inline void Stripe(uint64_t *acc, const uint8_t *p)
+    {
+        acc[0] = Round(acc[0], Read64(p));
+        acc[1] = Round(acc[1], Read64(p + 8));
+        acc[2] = Round(acc[2], Read64(p + 16));
+        acc[3] = Round(acc[3], Read64(p + 24));
+    }
+}
+
+Hash64::Hash64(uint64_t seed):
+    m_Seed(seed),
+    m_Length(0),
+    m_Buffered(0)
+{
+    m_Acc[0] = seed + PRIME1 + PRIME2;
+    m_Acc[1] = seed + PRIME2;
+    m_Acc[2] = seed;
+    m_Acc[3] = seed - PRIME1;
+}
+
+void Hash64::Update(const void *data, size_t len)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    const uint8_t *end = p + len;
+
+    m_Length += len;
+
+    if (m_Buffered + len < sizeof(m_Buffer))
+    {
+        memcpy(m_Buffer + m_Buffered, p, len);
+        m_Buffered += len;
+        return;
+    }
+
+    if (m_Buffered > 0)
+    {
+        size_t fill = sizeof(m_Buffer) - m_Buffered;
+        memcpy(m_Buffer + m_Buffered, p, fill);
+        Stripe(m_Acc, m_Buffer);
+        p += fill;
+        m_Buffered = 0;
+    }
+
+    while (end - p >= 32)
+    {
+        Stripe(m_Acc, p);
+        p += 32;
+    }
+
+    m_Buffered = end - p;
+    memcpy(m_Buffer, p, m_Buffered);
+}
+
+void Hash64::Update(const std::string &s)
+{
+    Update((uint64_t) s.size());
+    Update(s.data(), s.size());
+}
+
+void Hash64::Update(uint64_t v)
+{
+    Update(&v, sizeof(v));
+}
+
+void Hash64::Update(double v)
+{
+    Update(&v, sizeof(v));
+}
+
+uint64_t Hash64::Final() const
+{
+    uint64_t h;
+
+    if (m_Length >= 32)
+    {
+        h = Rotl(m_Acc[0], 1) + Rotl(m_Acc[1], 7) + Rotl(m_Acc[2], 12) + Rotl(m_Acc[3], 18);
+        for (int i = 0; i < 4; ++i)
+            h = MergeRound(h, m_Acc[i]);
+    }
+    else
+    {
+        h = m_Seed + PRIME5;
+    }
+
+    h += m_Length;
+
+    const uint8_t *p = m_Buffer;
+    const uint8_t *end = m_Buffer + m_Buffered;
+
+    for (; end - p >= 8; p += 8)
+    {
+        h ^= Round(0, Read64(p));
+        h = Rotl(h, 27) * PRIME1 + PRIME4;
+    }
+
+    if (end - p >= 4)
+    {
+        h ^= (uint64_t) Read32(p) * PRIME1;
+        h = Rotl(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+
+    for (; p < end; ++p)
+    {
+        h ^= *p * PRIME5;
+        h = Rotl(h, 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+
+    return h;
+}
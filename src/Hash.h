@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HASH_H_
+#define HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief Streaming 64 bit non-cryptographic hash (XXH64).
+ *
+ * Hashes several GB/s, for detecting identical inputs, not for security.
+ */
+class Hash64
+{
+public:
+    explicit Hash64(uint64_t seed = 0);
+
+    void Update(const void *data, size_t len);
+
+    /** \brief Hashes the length and the characters, so that consecutive strings cannot run together. */
+    void Update(const std::string &s);
+
+    void Update(uint64_t v);
+    void Update(double v);
+
+    /** \brief Hash of everything passed to Update() so far. */
+    uint64_t Final() const;
+
+private:
+    uint64_t m_Seed;
+    uint64_t m_Acc[4];
+    uint64_t m_Length;
+
+    /** \brief Input not yet consumed by a full 32 byte stripe. */
+    uint8_t m_Buffer[32];
+    size_t m_Buffered;
+};
+
+#endif /*HASH_H_*/
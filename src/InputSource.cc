@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <ios>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "InputSource.h"
+
+FileInputSource::FileInputSource(const std::string &fileName):
+    m_FileName(fileName),
+    m_Fd(-1)
+{
+    if (m_FileName == "-")
+    {
+        m_Fd = STDIN_FILENO;
+        return;
+    }
+
+    m_Fd = open(m_FileName.c_str(), O_RDONLY);
+    if (m_Fd < 0)
+    {
+        throw std::ios_base::failure("Unable to open file \"" + m_FileName + "\"");
+    }
+
+    // The whole file is read front to back exactly once.
+    posix_fadvise(m_Fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+FileInputSource::~FileInputSource()
+{
+    if (m_Fd > STDIN_FILENO)
+        close(m_Fd);
+}
+
+size_t FileInputSource::read(uint8_t *buf, size_t len)
+{
+    while (true)
+    {
+        ssize_t n = ::read(m_Fd, buf, len);
+        if (n >= 0)
+            return n;
+
+        if (errno != EINTR)
+            throw std::ios_base::failure("Unable to read \"" + m_FileName + "\": " + strerror(errno));
+    }
+}
+
+void FileInputSource::Seek(uint64_t offset)
+{
+    if (lseek(m_Fd, offset, SEEK_SET) == (off_t) -1)
+        throw std::ios_base::failure("Unable to seek in \"" + m_FileName + "\": " + strerror(errno));
+}
+
+int FileInputSource::GetFd() const
+{
+    return m_Fd;
+}
+
+MemoryInputSource::MemoryInputSource(const void *data, size_t size):
+    m_Data(static_cast<const uint8_t *>(data)),
+    m_Size(size),
+    m_Pos(0)
+{}
+
+MemoryInputSource::MemoryInputSource(const std::string &data):
+    MemoryInputSource(data.data(), data.size())
+{}
+
+size_t MemoryInputSource::read(uint8_t *buf, size_t len)
+{
+    size_t n = std::min(len, m_Size - m_Pos);
+    std::copy(m_Data + m_Pos, m_Data + m_Pos + n, buf);
+    m_Pos += n;
+
+    return n;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUTSOURCE_H_
+#define INPUTSOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/** \brief Source of the raw spool bytes. */
+class IInputSource
+{
+public:
+    /**
+     * \brief Reads up to len bytes into buf.
+     *
+     * Blocks until at least one byte is available. Returns 0 at the end
+     * of the input, throws std::ios_base::failure on read errors.
+     */
+    virtual size_t read(uint8_t *buf, size_t len) = 0;
+
+    virtual ~IInputSource()
+    {}
+};
+
+/** \brief Reads a file, or standard input if the name is "-". */
+class FileInputSource: public IInputSource
+{
+public:
+    explicit FileInputSource(const std::string &fileName);
+    virtual ~FileInputSource();
+
+    virtual size_t read(uint8_t *buf, size_t len) override;
+
+    /** \brief Continues reading at offset. Throws std::ios_base::failure for pipes. */
+    void Seek(uint64_t offset);
+
+    int GetFd() const;
+
+private:
+    FileInputSource(const FileInputSource &) = delete;
+    FileInputSource &operator=(const FileInputSource &) = delete;
+
+    std::string m_FileName;
+    int m_Fd;
+};
+
+/** \brief Reads from a memory buffer. The buffer is not copied. */
+class MemoryInputSource: public IInputSource
+{
+public:
+    MemoryInputSource(const void *data, size_t size);
+    explicit MemoryInputSource(const std::string &data);
+
+    virtual size_t read(uint8_t *buf, size_t len) override;
+
+private:
+    const uint8_t *m_Data;
+    size_t m_Size;
+    size_t m_Pos;
+};
+
+#endif /*INPUTSOURCE_H_*/
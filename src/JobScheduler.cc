@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "JobScheduler.h"
+#include "Metrics.h"
+
+namespace
+{
+    /** \brief The scheduler whose bulk job the thread runs, nullptr on other threads. */
+    thread_local JobScheduler *t_BulkScheduler = nullptr;
+
+    /** \brief Time the job of the thread spent paused. */
+    thread_local std::chrono::steady_clock::duration t_Paused;
+
+    const unsigned INTERACTIVE = static_cast<unsigned>(JobClass::Interactive);
+    const unsigned BULK = static_cast<unsigned>(JobClass::Bulk);
+}
+
+SchedulerSettings::SchedulerSettings():
+    m_Slots(std::max(std::thread::hardware_concurrency(), 1u)),
+    m_BulkJobs(m_Slots),
+    m_BulkSize(1 << 20),
+    m_InteractiveSlo(5000)
+{}
+
+JobScheduler::JobScheduler(const SchedulerSettings &settings):
+    m_Settings(settings),
+    m_Running(),
+    m_Paused(0),
+    m_Stop(false)
+{
+    m_Settings.m_Slots = std::max(m_Settings.m_Slots, 1u);
+    m_Settings.m_BulkJobs = std::max(std::min(m_Settings.m_BulkJobs, m_Settings.m_Slots), 1u);
+
+    for (unsigned i = 0; i < m_Settings.m_Slots; ++i)
+        m_Threads.push_back(std::thread(&JobScheduler::Worker, this, JobClass::Interactive));
+    for (unsigned i = 0; i < m_Settings.m_BulkJobs; ++i)
+        m_Threads.push_back(std::thread(&JobScheduler::Worker, this, JobClass::Bulk));
+}
+
+JobScheduler::~JobScheduler()
+{
+    Shutdown(true);
+}
+
+void JobScheduler::Submit(Job job, JobClass cls)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Queues[static_cast<unsigned>(cls)].push_back(Entry { std::move(job), Clock::now() });
+    m_Changed.notify_all();
+}
+
+void JobScheduler::Shutdown(bool drain)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (!drain)
+        {
+            m_Queues[INTERACTIVE].clear();
+            m_Queues[BULK].clear();
+        }
+        m_Stop = true;
+        m_Changed.notify_all();
+    }
+
+    for (std::thread &t : m_Threads)
+    {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+void JobScheduler::PageBoundary()
+{
+    if (t_BulkScheduler)
+        t_BulkScheduler->Yield();
+}
+
+JobScheduler *JobScheduler::GetBulkScheduler()
+{
+    return t_BulkScheduler;
+}
+
+void JobScheduler::SetBulkScheduler(JobScheduler *scheduler)
+{
+    t_BulkScheduler = scheduler;
+}
+
+const SchedulerSettings &JobScheduler::GetSettings() const
+{
+    return m_Settings;
+}
+
+size_t JobScheduler::GetQueued(JobClass cls) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_Queues[static_cast<unsigned>(cls)].size();
+}
+
+size_t JobScheduler::GetRunning(JobClass cls) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_Running[static_cast<unsigned>(cls)];
+}
+
+size_t JobScheduler::GetPaused() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    return m_Paused;
+}
+
+bool JobScheduler::CanStart(JobClass cls) const
+{
+    if (m_Queues[static_cast<unsigned>(cls)].empty() || m_Running[INTERACTIVE] + m_Running[BULK] >= m_Settings.m_Slots)
+        return false;
+
+    // Bulk jobs give way to waiting interactive jobs and let paused ones continue first.
+    return cls == JobClass::Interactive || (m_Queues[INTERACTIVE].empty() && m_Paused == 0);
+}
+
+void JobScheduler::Yield()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    if (m_Queues[INTERACTIVE].empty() || m_Running[INTERACTIVE] + m_Running[BULK] < m_Settings.m_Slots)
+        return; // nobody waits, or a slot is free anyway
+
+    --m_Running[BULK];
+    ++m_Paused;
+    Metrics::Add(Metrics::BULK_YIELDS);
+    m_Changed.notify_all();
+
+    Clock::time_point start = Clock::now();
+    m_Changed.wait(lock, [this]() {
+        return m_Queues[INTERACTIVE].empty() && m_Running[INTERACTIVE] + m_Running[BULK] < m_Settings.m_Slots;
+    });
+    t_Paused += Clock::now() - start;
+
+    --m_Paused;
+    ++m_Running[BULK];
+}
+
+void JobScheduler::Worker(JobClass cls)
+{
+    unsigned c = static_cast<unsigned>(cls);
+    if (cls == JobClass::Bulk)
+        t_BulkScheduler = this;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+        m_Changed.wait(lock, [this, cls, c]() { return (m_Stop && m_Queues[c].empty()) || CanStart(cls); });
+        if (m_Queues[c].empty())
+            return; // stopped and drained
+
+        Entry entry = std::move(m_Queues[c].front());
+        m_Queues[c].pop_front();
+        ++m_Running[c];
+
+        lock.unlock();
+        Clock::time_point start = Clock::now();
+        t_Paused = Clock::duration::zero();
+        entry.m_Job();
+        Clock::time_point end = Clock::now();
+
+        Metrics::Add(Metrics::BUSY_MICROSECONDS, std::chrono::duration_cast<std::chrono::microseconds>(end - start - t_Paused).count());
+        if (cls == JobClass::Interactive)
+        {
+            Metrics::Add(Metrics::INTERACTIVE_JOBS);
+            if (end - entry.m_Queued > m_Settings.m_InteractiveSlo)
+                Metrics::Add(Metrics::INTERACTIVE_SLO_MISSES);
+        }
+        else
+        {
+            Metrics::Add(Metrics::BULK_JOBS);
+        }
+        lock.lock();
+
+        --m_Running[c];
+        m_Changed.notify_all();
+    }
+}
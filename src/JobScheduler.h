@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOBSCHEDULER_H_
+#define JOBSCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class JobClass
+{
+    /** \brief Small jobs someone is waiting for, e.g. a reprint. */
+    Interactive,
+
+    /** \brief Large jobs, e.g. month-end runs, that may be paused. */
+    Bulk
+};
+
+struct SchedulerSettings
+{
+    SchedulerSettings();
+
+    /** \brief Jobs converting at the same time (--jobs). */
+    unsigned m_Slots;
+
+    /** \brief Bulk jobs converting or paused at the same time (--bulk-jobs), at most m_Slots. */
+    unsigned m_BulkJobs;
+
+    /** \brief Input size from which a job is bulk (--bulk-size). */
+    uint64_t m_BulkSize;
+
+    /** \brief Time from queueing to completion interactive jobs should stay within (--interactive-slo). */
+    std::chrono::milliseconds m_InteractiveSlo;
+
+    JobClass Classify(uint64_t inputBytes) const
+    {
+        return inputBytes >= m_BulkSize ? JobClass::Bulk : JobClass::Interactive;
+    }
+};
+
+/**
+ * \brief Runs submitted jobs in two classes, with interactive jobs first.
+ *
+ * At most m_Slots jobs convert at the same time, each holding a slot.
+ * Waiting interactive jobs get the next free slot, bulk jobs only start
+ * while none is waiting. A bulk job that reaches a page boundary
+ * (PageBoundary(), called by CairoTTY::NewPage()) while an interactive
+ * job waits for a slot hands its slot over and pauses until no
+ * interactive job waits any more. So a one page reprint does not queue
+ * behind a run of ten thousand pages, and the bulk job continues exactly
+ * where it paused.
+ *
+ * Each class has threads of its own, as many as the class may run
+ * (m_Slots and m_BulkJobs), so a paused bulk job never blocks an
+ * interactive one from getting a thread.
+ */
+class JobScheduler
+{
+public:
+    typedef std::function<void()> Job;
+
+    explicit JobScheduler(const SchedulerSettings &settings);
+
+    /** \brief Same as Shutdown(true). */
+    ~JobScheduler();
+
+    /** \brief Queues job. Jobs must not throw. */
+    void Submit(Job job, JobClass cls);
+
+    /**
+     * \brief Stops the threads after the jobs running now, and if drain
+     * is set, all queued jobs too. Queued jobs are dropped otherwise.
+     */
+    void Shutdown(bool drain);
+
+    /**
+     * \brief Pauses the bulk job of the calling thread while an interactive
+     * job waits for a slot. Does nothing on other threads.
+     */
+    static void PageBoundary();
+
+    /** \brief The scheduler whose bulk job the calling thread runs, nullptr if none. */
+    static JobScheduler *GetBulkScheduler();
+
+    /**
+     * \brief Makes PageBoundary() on the calling thread pause for scheduler,
+     * for threads a bulk job starts to draw its pages (--render-thread).
+     */
+    static void SetBulkScheduler(JobScheduler *scheduler);
+
+    const SchedulerSettings &GetSettings() const;
+
+    /** \brief Jobs of cls waiting for a slot. */
+    size_t GetQueued(JobClass cls) const;
+
+    /** \brief Jobs of cls converting now, without paused ones. */
+    size_t GetRunning(JobClass cls) const;
+
+    /** \brief Bulk jobs paused for interactive ones. */
+    size_t GetPaused() const;
+
+private:
+    JobScheduler(const JobScheduler &) = delete;
+    JobScheduler &operator=(const JobScheduler &) = delete;
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        Job m_Job;
+        Clock::time_point m_Queued;
+    };
+
+    void Worker(JobClass cls);
+
+    /** \brief Whether a thread of cls may take a job now. Call with m_Mutex held. */
+    bool CanStart(JobClass cls) const;
+
+    /** \brief PageBoundary() of a bulk job run by this scheduler. */
+    void Yield();
+
+    SchedulerSettings m_Settings;
+
+    std::vector<std::thread> m_Threads;
+    std::deque<Entry> m_Queues[2];
+
+    /** \brief Jobs holding a slot, by class. */
+    size_t m_Running[2];
+    size_t m_Paused;
+    bool m_Stop;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+};
+
+#endif /*JOBSCHEDULER_H_*/
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include "Hash.h"
+#include "LineTemplates.h"
+#include "Metrics.h"
+
+const size_t LineTemplates::MIN_GLYPHS = 8;
+const size_t LineTemplates::MAX_CANDIDATES = 1 << 16;
+const size_t LineTemplates::MAX_TEMPLATES = 1024;
+
+LineTemplates::LineTemplates():
+    m_Style(0)
+{}
+
+void LineTemplates::SetStyle(const Cairo::RefPtr<Cairo::FontFace> &face, double size)
+{
+    // Only a handful of styles per document. Every get_font_face() returns
+    // a new wrapper, so the cairo objects are compared.
+    for (unsigned i = 0; i < m_Styles.size(); ++i)
+    {
+        if (m_Styles[i].m_Face->cobj() == face->cobj() && m_Styles[i].m_Size == size)
+        {
+            m_Style = i;
+            return;
+        }
+    }
+
+    m_Styles.push_back(Style { face, size });
+    m_Style = m_Styles.size() - 1;
+}
+
+void LineTemplates::AddGlyph(const Glib::ustring &s, double x, double y, double stretchX, double stretchY)
+{
+    // Mostly the current line; overstrike (CR) and reverse feeds find older ones.
+    Line *line = nullptr;
+    for (size_t i = m_Lines.size(); i > 0; --i)
+    {
+        if (m_Lines[i - 1].m_Y == y)
+        {
+            line = &m_Lines[i - 1];
+            break;
+        }
+    }
+
+    if (!line)
+    {
+        m_Lines.push_back(Line { y, std::vector<Glyph>() });
+        line = &m_Lines.back();
+    }
+
+    line->m_Glyphs.push_back(Glyph { s, x, stretchX, stretchY, m_Style });
+}
+
+uint64_t LineTemplates::Key(const Line &line) const
+{
+    Hash64 h;
+
+    h.Update(line.m_Y);
+    for (const Glyph &g : line.m_Glyphs)
+    {
+        h.Update(g.m_Text.raw());
+        h.Update(g.m_X);
+        h.Update(g.m_StretchX);
+        h.Update(g.m_StretchY);
+        h.Update((uint64_t) g.m_Style);
+    }
+
+    return h.Final();
+}
+
+bool LineTemplates::Equal(const Line &a, const Line &b)
+{
+    if (a.m_Y != b.m_Y || a.m_Glyphs.size() != b.m_Glyphs.size())
+        return false;
+
+    for (size_t i = 0; i < a.m_Glyphs.size(); ++i)
+    {
+        const Glyph &ga = a.m_Glyphs[i];
+        const Glyph &gb = b.m_Glyphs[i];
+
+        if (ga.m_Text != gb.m_Text || ga.m_X != gb.m_X || ga.m_StretchX != gb.m_StretchX
+            || ga.m_StretchY != gb.m_StretchY || ga.m_Style != gb.m_Style)
+            return false;
+    }
+
+    return true;
+}
+
+void LineTemplates::Draw(const Cairo::RefPtr<Cairo::Context> &cr, const Line &line) const
+{
+    unsigned style = std::numeric_limits<unsigned>::max();
+
+    cr->save();
+    for (const Glyph &g : line.m_Glyphs)
+    {
+        if (g.m_Style != style)
+        {
+            style = g.m_Style;
+            cr->set_font_face(m_Styles[style].m_Face);
+            cr->set_font_size(m_Styles[style].m_Size);
+        }
+
+        // Same as CairoTTY::DrawGlyph()
+        cr->save();
+        cr->move_to(g.m_X, line.m_Y);
+        cr->scale(g.m_StretchX, g.m_StretchY);
+        cr->show_text(g.m_Text);
+        cr->restore();
+    }
+    cr->restore();
+}
+
+Cairo::RefPtr<Cairo::Surface> LineTemplates::Record(const Line &line) const
+{
+    // Generous bounds around the glyph origins: from the left of the first
+    // glyph to well beyond the last, the line height above and below.
+    double left = line.m_Glyphs.front().m_X;
+    double right = left;
+    double size = 0.0;
+    for (const Glyph &g : line.m_Glyphs)
+    {
+        left = std::min(left, g.m_X);
+        right = std::max(right, g.m_X);
+        size = std::max(size, m_Styles[g.m_Style].m_Size * std::max(g.m_StretchX, g.m_StretchY));
+    }
+
+    cairo_rectangle_t extents = { left - size, line.m_Y - 2.0 * size, right - left + 4.0 * size, 3.0 * size };
+
+    Cairo::RefPtr<Cairo::Surface> surface(new Cairo::Surface(cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents), true));
+    {
+        Cairo::RefPtr<Cairo::Context> cr = Cairo::Context::create(surface);
+        Draw(cr, line);
+    }
+    surface->finish();
+
+    return surface;
+}
+
+void LineTemplates::Flush(const Cairo::RefPtr<Cairo::Context> &cr)
+{
+    for (const Line &line : m_Lines)
+    {
+        if (line.m_Glyphs.size() < MIN_GLYPHS)
+        {
+            Draw(cr, line);
+            continue;
+        }
+
+        uint64_t key = Key(line);
+
+        std::unordered_map<uint64_t, Template>::iterator t = m_Templates.find(key);
+        if (t == m_Templates.end() && m_Candidates.count(key) && m_Templates.size() < MAX_TEMPLATES)
+        {
+            // Seen on an earlier page: from now on it is a template.
+            m_Candidates.erase(key);
+            t = m_Templates.insert(std::make_pair(key, Template { line, Record(line) })).first;
+        }
+
+        if (t != m_Templates.end() && Equal(t->second.m_Line, line))
+        {
+            Metrics::Add(Metrics::TEMPLATE_HITS);
+            cr->save();
+            cr->set_source(t->second.m_Surface, 0.0, 0.0);
+            cr->paint();
+            cr->restore();
+            continue;
+        }
+
+        if (m_Candidates.size() >= MAX_CANDIDATES)
+            m_Candidates.clear();
+        m_Candidates.insert(key);
+
+        Metrics::Add(Metrics::TEMPLATE_MISSES);
+        Draw(cr, line);
+    }
+
+    m_Lines.clear();
+}
+
+size_t LineTemplates::GetTemplateCount() const
+{
+    return m_Templates.size();
+}
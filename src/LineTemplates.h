@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINETEMPLATES_H_
+#define LINETEMPLATES_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <glibmm.h>
+#include <cairomm/cairomm.h>
+
+/**
+ * \brief Draws lines that repeat on many pages (headers, footers, column
+ * titles) from a shared template.
+ *
+ * The glyphs of a page are collected per line (baseline) and drawn when the
+ * page is complete. A line is identified by a hash of its glyphs, their
+ * positions and styles. The first time a line is seen it is drawn directly;
+ * when the same line appears on a later page it is drawn once onto a
+ * recording surface, which is painted on that and every further page. Cairo
+ * writes a recording surface painted on several pages of a PDF as a single
+ * form XObject, so the glyphs of a repeated line are stored only once per
+ * output file.
+ */
+class LineTemplates
+{
+public:
+    LineTemplates();
+
+    /** \brief Font of the following glyphs. */
+    void SetStyle(const Cairo::RefPtr<Cairo::FontFace> &face, double size);
+
+    /** \brief Adds the glyph s with its origin at (x, y), stretched like CairoTTY::DrawGlyph(). */
+    void AddGlyph(const Glib::ustring &s, double x, double y, double stretchX, double stretchY);
+
+    /** \brief Draws the lines added since the last call on cr, then forgets them. */
+    void Flush(const Cairo::RefPtr<Cairo::Context> &cr);
+
+    /** \brief Number of templates created so far. */
+    size_t GetTemplateCount() const;
+
+private:
+    LineTemplates(const LineTemplates &) = delete;
+    LineTemplates &operator=(const LineTemplates &) = delete;
+
+    struct Style
+    {
+        Cairo::RefPtr<Cairo::FontFace> m_Face;
+        double m_Size;
+    };
+
+    struct Glyph
+    {
+        Glib::ustring m_Text;
+        double m_X;
+        double m_StretchX;
+        double m_StretchY;
+        unsigned m_Style;
+    };
+
+    struct Line
+    {
+        double m_Y;
+        std::vector<Glyph> m_Glyphs;
+    };
+
+    struct Template
+    {
+        Line m_Line;
+        Cairo::RefPtr<Cairo::Surface> m_Surface;
+    };
+
+    /** \brief Lines with fewer glyphs are not worth a template. */
+    static const size_t MIN_GLYPHS;
+
+    /** \brief Lines remembered as candidates; beyond that the list starts over. */
+    static const size_t MAX_CANDIDATES;
+
+    static const size_t MAX_TEMPLATES;
+
+    uint64_t Key(const Line &line) const;
+    static bool Equal(const Line &a, const Line &b);
+
+    void Draw(const Cairo::RefPtr<Cairo::Context> &cr, const Line &line) const;
+
+    /** \brief Creates a recording surface holding line. */
+    Cairo::RefPtr<Cairo::Surface> Record(const Line &line) const;
+
+    std::vector<Style> m_Styles;
+    unsigned m_Style;
+
+    /** \brief Lines of the current page, in the order they were begun. */
+    std::vector<Line> m_Lines;
+
+    /** \brief Keys of lines drawn directly so far. */
+    std::unordered_set<uint64_t> m_Candidates;
+
+    std::unordered_map<uint64_t, Template> m_Templates;
+};
+
+#endif /*LINETEMPLATES_H_*/
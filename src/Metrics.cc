@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "JobScheduler.h"
+#include "Metrics.h"
+
+const unsigned Metrics::MAX_TRANSLATORS;
+const unsigned Metrics::LATENCY_BUCKET_COUNT;
+const double Metrics::LATENCY_BUCKETS[] = { 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0 };
+
+namespace
+{
+    /** \brief Counters of one thread, on cache lines of their own. */
+    struct alignas(64) Block
+    {
+        Block()
+        {
+            for (std::atomic<uint64_t> &v : m_Values)
+                v.store(0, std::memory_order_relaxed);
+        }
+
+        std::atomic<uint64_t> m_Values[Metrics::COUNTERS];
+    };
+
+    struct Registry
+    {
+        std::mutex m_Mutex;
+        std::set<const Block *> m_Live;
+
+        /** \brief Counts of threads that have ended. */
+        uint64_t m_Retired[Metrics::COUNTERS] = {};
+
+        std::vector<std::string> m_Translators;
+    };
+
+    /** \brief Never destroyed: threads may still end after main() returns. */
+    Registry &GetRegistry()
+    {
+        static Registry *registry = new Registry();
+        return *registry;
+    }
+
+    /** \brief Registers the block of a thread for its lifetime. */
+    struct ThreadBlock
+    {
+        ThreadBlock()
+        {
+            Registry &r = GetRegistry();
+            std::lock_guard<std::mutex> lock(r.m_Mutex);
+            r.m_Live.insert(&m_Block);
+        }
+
+        ~ThreadBlock()
+        {
+            Registry &r = GetRegistry();
+            std::lock_guard<std::mutex> lock(r.m_Mutex);
+            for (unsigned i = 0; i < Metrics::COUNTERS; ++i)
+                r.m_Retired[i] += m_Block.m_Values[i].load(std::memory_order_relaxed);
+            r.m_Live.erase(&m_Block);
+        }
+
+        Block m_Block;
+    };
+
+    Block &LocalBlock()
+    {
+        thread_local ThreadBlock block;
+        return block.m_Block;
+    }
+
+    void WriteHeader(std::ostream &out, const char *name, const char *type, const char *help)
+    {
+        out << "# HELP " << name << " " << help << "\n";
+        out << "# TYPE " << name << " " << type << "\n";
+    }
+
+    template<typename T>
+    void WriteMetric(std::ostream &out, const char *name, const char *type, const char *help, T value)
+    {
+        WriteHeader(out, name, type, help);
+        out << name << " " << value << "\n";
+    }
+
+    /** \brief Escapes a label value: backslash, double quote and line feed. */
+    std::string LabelValue(const std::string &s)
+    {
+        std::string escaped;
+        for (char c : s)
+        {
+            if (c == '\n')
+            {
+                escaped += "\\n";
+                continue;
+            }
+            if (c == '\\' || c == '"')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
+void Metrics::Add(Counter counter, uint64_t n)
+{
+    // Only this thread writes the value, so no read-modify-write is needed.
+    std::atomic<uint64_t> &v = LocalBlock().m_Values[counter];
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void Metrics::AddJob(double seconds, bool failed)
+{
+    Add(JOBS);
+    if (failed)
+        Add(JOBS_FAILED);
+    Add(LATENCY_MICROSECONDS, (uint64_t) (seconds * 1e6));
+
+    // Counted in the first bucket it fits, summed up by Write().
+    unsigned bucket = std::lower_bound(LATENCY_BUCKETS, LATENCY_BUCKETS + LATENCY_BUCKET_COUNT, seconds) - LATENCY_BUCKETS;
+    if (bucket < LATENCY_BUCKET_COUNT)
+        Add((Counter) (LATENCY_BUCKET + bucket));
+}
+
+unsigned Metrics::RegisterTranslator(const std::string &name)
+{
+    Registry &r = GetRegistry();
+    std::lock_guard<std::mutex> lock(r.m_Mutex);
+
+    std::vector<std::string>::iterator i = std::find(r.m_Translators.begin(), r.m_Translators.end(), name);
+    if (i != r.m_Translators.end())
+        return i - r.m_Translators.begin();
+
+    if (r.m_Translators.size() == MAX_TRANSLATORS - 1)
+        r.m_Translators.push_back("other");
+    if (r.m_Translators.size() == MAX_TRANSLATORS)
+        return MAX_TRANSLATORS - 1;
+
+    r.m_Translators.push_back(name);
+    return r.m_Translators.size() - 1;
+}
+
+void Metrics::AddUnknownByte(unsigned translator)
+{
+    Add((Counter) (UNKNOWN_BYTES + translator));
+}
+
+void Metrics::Write(std::ostream &out, const JobScheduler *scheduler)
+{
+    uint64_t v[COUNTERS];
+    std::vector<std::string> translators;
+
+    {
+        Registry &r = GetRegistry();
+        std::lock_guard<std::mutex> lock(r.m_Mutex);
+
+        std::copy(r.m_Retired, r.m_Retired + COUNTERS, v);
+        for (const Block *b : r.m_Live)
+        {
+            for (unsigned i = 0; i < COUNTERS; ++i)
+                v[i] += b->m_Values[i].load(std::memory_order_relaxed);
+        }
+        translators = r.m_Translators;
+    }
+
+    WriteMetric(out, "dotprint_jobs_total", "counter", "Inputs converted, including failed ones.", v[JOBS]);
+    WriteMetric(out, "dotprint_jobs_failed_total", "counter", "Inputs that could not be converted.", v[JOBS_FAILED]);
+
+    WriteHeader(out, "dotprint_job_duration_seconds", "histogram", "Time from queueing an input until its output was complete.");
+    uint64_t cumulative = 0;
+    for (unsigned i = 0; i < LATENCY_BUCKET_COUNT; ++i)
+    {
+        cumulative += v[LATENCY_BUCKET + i];
+        out << "dotprint_job_duration_seconds_bucket{le=\"" << LATENCY_BUCKETS[i] << "\"} " << cumulative << "\n";
+    }
+    out << "dotprint_job_duration_seconds_bucket{le=\"+Inf\"} " << v[JOBS] << "\n";
+    out << "dotprint_job_duration_seconds_sum " << v[LATENCY_MICROSECONDS] / 1e6 << "\n";
+    out << "dotprint_job_duration_seconds_count " << v[JOBS] << "\n";
+
+    WriteMetric(out, "dotprint_input_bytes_total", "counter", "Spool bytes converted.", v[INPUT_BYTES]);
+    WriteMetric(out, "dotprint_pages_total", "counter", "Pages written.", v[PAGES]);
+    WriteMetric(out, "dotprint_glyphs_total", "counter", "Characters drawn.", v[GLYPHS]);
+    WriteMetric(out, "dotprint_output_bytes_total", "counter", "Bytes of the output files.", v[OUTPUT_BYTES]);
+
+    WriteHeader(out, "dotprint_font_cache_requests_total", "counter", "Font files and coverage looked up, by whether they were loaded already.");
+    out << "dotprint_font_cache_requests_total{result=\"hit\"} " << v[FONT_CACHE_HITS] << "\n";
+    out << "dotprint_font_cache_requests_total{result=\"miss\"} " << v[FONT_CACHE_MISSES] << "\n";
+
+    WriteHeader(out, "dotprint_template_requests_total", "counter", "Lines eligible for --templates, by whether a template was drawn.");
+    out << "dotprint_template_requests_total{result=\"hit\"} " << v[TEMPLATE_HITS] << "\n";
+    out << "dotprint_template_requests_total{result=\"miss\"} " << v[TEMPLATE_MISSES] << "\n";
+
+    WriteHeader(out, "dotprint_unknown_bytes_total", "counter", "Input bytes the translator had no character for.");
+    for (unsigned i = 0; i < translators.size(); ++i)
+        out << "dotprint_unknown_bytes_total{translator=\"" << LabelValue(translators[i]) << "\"} " << v[UNKNOWN_BYTES + i] << "\n";
+
+    WriteMetric(out, "dotprint_worker_busy_seconds_total", "counter", "Time worker threads spent converting.", v[BUSY_MICROSECONDS] / 1e6);
+    WriteMetric(out, "dotprint_raster_busy_seconds_total", "counter", "Time raster threads spent drawing pages of PNG and PBM output.", v[RASTER_BUSY_MICROSECONDS] / 1e6);
+
+    WriteHeader(out, "dotprint_scheduled_jobs_total", "counter", "Jobs finished by the scheduler, by class.");
+    out << "dotprint_scheduled_jobs_total{class=\"interactive\"} " << v[INTERACTIVE_JOBS] << "\n";
+    out << "dotprint_scheduled_jobs_total{class=\"bulk\"} " << v[BULK_JOBS] << "\n";
+    WriteMetric(out, "dotprint_interactive_slo_misses_total", "counter", "Interactive jobs that took longer than --interactive-slo from queueing to completion.", v[INTERACTIVE_SLO_MISSES]);
+    WriteMetric(out, "dotprint_bulk_yields_total", "counter", "Times a bulk job paused at a page boundary for an interactive one.", v[BULK_YIELDS]);
+
+    if (scheduler)
+    {
+        const SchedulerSettings &settings = scheduler->GetSettings();
+        WriteMetric(out, "dotprint_interactive_slo_seconds", "gauge", "Latency objective of interactive jobs (--interactive-slo).", settings.m_InteractiveSlo.count() / 1e3);
+        WriteMetric(out, "dotprint_workers", "gauge", "Jobs that may convert at the same time.", settings.m_Slots);
+
+        WriteHeader(out, "dotprint_workers_busy", "gauge", "Jobs converting right now, by class.");
+        out << "dotprint_workers_busy{class=\"interactive\"} " << scheduler->GetRunning(JobClass::Interactive) << "\n";
+        out << "dotprint_workers_busy{class=\"bulk\"} " << scheduler->GetRunning(JobClass::Bulk) << "\n";
+
+        WriteHeader(out, "dotprint_queue_depth", "gauge", "Inputs waiting for a worker, by class.");
+        out << "dotprint_queue_depth{class=\"interactive\"} " << scheduler->GetQueued(JobClass::Interactive) << "\n";
+        out << "dotprint_queue_depth{class=\"bulk\"} " << scheduler->GetQueued(JobClass::Bulk) << "\n";
+
+        WriteMetric(out, "dotprint_jobs_paused", "gauge", "Bulk jobs paused for interactive ones.", scheduler->GetPaused());
+    }
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+class JobScheduler;
+
+/**
+ * \brief Process-wide counters, written in the Prometheus text format.
+ *
+ * Every thread counts into a block of its own, which only that thread
+ * writes to, so counting takes neither a lock nor an atomic read-modify-
+ * write. Write() sums the blocks of all threads, plus what threads that
+ * have ended left behind. Rates (bytes per second...) are left to the
+ * scraper.
+ */
+class Metrics
+{
+public:
+    /** \brief Translators whose unknown bytes are counted separately, further ones share the last slot. */
+    static const unsigned MAX_TRANSLATORS = 8;
+
+    /** \brief Upper bounds of the job latency histogram buckets, in seconds. */
+    static const double LATENCY_BUCKETS[];
+    static const unsigned LATENCY_BUCKET_COUNT = 9;
+
+    enum Counter
+    {
+        INPUT_BYTES,
+        PAGES,
+        GLYPHS,
+        OUTPUT_BYTES,
+
+        /** \brief Time JobScheduler threads spent running jobs, without paused time. */
+        BUSY_MICROSECONDS,
+
+        /** \brief Time WorkerPool threads spent rasterizing pages, apart from
+         * BUSY_MICROSECONDS as the job waiting for them counts that time too. */
+        RASTER_BUSY_MICROSECONDS,
+
+        FONT_CACHE_HITS,
+        FONT_CACHE_MISSES,
+
+        /** \brief Repeated lines drawn from a LineTemplates template, or not. */
+        TEMPLATE_HITS,
+        TEMPLATE_MISSES,
+
+        JOBS,
+        JOBS_FAILED,
+        LATENCY_MICROSECONDS,
+
+        /** \brief Jobs finished by a JobScheduler, by class, and interactive ones that took longer than the SLO. */
+        INTERACTIVE_JOBS,
+        INTERACTIVE_SLO_MISSES,
+        BULK_JOBS,
+
+        /** \brief Times a bulk job paused at a page boundary for an interactive one. */
+        BULK_YIELDS,
+
+        /** \brief First of the MAX_TRANSLATORS counters, see AddUnknownByte(). */
+        UNKNOWN_BYTES,
+
+        /** \brief First of the LATENCY_BUCKET_COUNT counters, see AddJob(). */
+        LATENCY_BUCKET = UNKNOWN_BYTES + MAX_TRANSLATORS,
+
+        COUNTERS = LATENCY_BUCKET + LATENCY_BUCKET_COUNT
+    };
+
+    static void Add(Counter counter, uint64_t n = 1);
+
+    /** \brief Counts a finished job (conversion of one input) that took seconds. */
+    static void AddJob(double seconds, bool failed);
+
+    /** \brief Slot of the translator called name, for AddUnknownByte(). */
+    static unsigned RegisterTranslator(const std::string &name);
+
+    static void AddUnknownByte(unsigned translator);
+
+    /** \brief Writes all metrics, and the queue and thread gauges of scheduler if not null. */
+    static void Write(std::ostream &out, const JobScheduler *scheduler);
+};
+
+#endif /*METRICS_H_*/
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <sstream>
+#include <stdexcept>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "Metrics.h"
+#include "MetricsServer.h"
+
+namespace
+{
+    /** \brief Clients taking longer than this to send their request or to take
+     * a part of the response are dropped. */
+    const int REQUEST_TIMEOUT_MS = 1000;
+
+    const size_t MAX_REQUEST = 8192;
+
+    void SendAll(int fd, const std::string &data)
+    {
+        for (size_t sent = 0; sent < data.size(); )
+        {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return; // the client is gone
+            }
+            sent += n;
+        }
+    }
+
+    std::string Response(const char *status, const char *contentType, const std::string &body)
+    {
+        std::ostringstream r;
+        r << "HTTP/1.0 " << status << "\r\n"
+            << "Content-Type: " << contentType << "\r\n"
+            << "Content-Length: " << body.size() << "\r\n"
+            << "Connection: close\r\n\r\n"
+            << body;
+        return r.str();
+    }
+}
+
+MetricsServer::MetricsServer(const std::string &address, const JobScheduler *scheduler):
+    m_Address(address),
+    m_Scheduler(scheduler),
+    m_Listen(-1)
+{
+    if (address.find('/') != std::string::npos)
+        ListenUnix(address);
+    else
+        ListenTcp(address);
+
+    if (listen(m_Listen, 16) != 0 || pipe2(m_Wakeup, O_CLOEXEC) != 0)
+    {
+        std::string error = strerror(errno);
+        close(m_Listen);
+        throw std::runtime_error("Unable to listen on \"" + m_Address + "\": " + error);
+    }
+
+    m_Thread = std::thread(&MetricsServer::Serve, this);
+}
+
+MetricsServer::~MetricsServer()
+{
+    char c = 0;
+    while (write(m_Wakeup[1], &c, 1) < 0 && errno == EINTR)
+        ;
+    m_Thread.join();
+
+    close(m_Wakeup[0]);
+    close(m_Wakeup[1]);
+    close(m_Listen);
+
+    if (!m_SocketPath.empty())
+        unlink(m_SocketPath.c_str());
+}
+
+void MetricsServer::ListenUnix(const std::string &path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+        throw std::runtime_error("Socket path too long: \"" + path + "\"");
+    strcpy(addr.sun_path, path.c_str());
+
+    // Left behind by a previous run that did not end cleanly.
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path.c_str());
+
+    m_Listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_Listen < 0 || bind(m_Listen, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+        std::string error = strerror(errno);
+        if (m_Listen >= 0)
+            close(m_Listen);
+        throw std::runtime_error("Unable to listen on \"" + path + "\": " + error);
+    }
+
+    m_SocketPath = path;
+}
+
+void MetricsServer::ListenTcp(const std::string &address)
+{
+    std::string::size_type colon = address.rfind(':');
+    std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+    std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+
+    // [::1]:9100
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+        host = host.substr(1, host.size() - 2);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    struct addrinfo *ai = nullptr;
+    int rc = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &ai);
+    if (rc != 0)
+        throw std::runtime_error("Unable to listen on \"" + address + "\": " + gai_strerror(rc));
+
+    std::string error = "no address";
+    for (struct addrinfo *a = ai; a != nullptr; a = a->ai_next)
+    {
+        int fd = socket(a->ai_family, a->ai_socktype | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0)
+        {
+            error = strerror(errno);
+            continue;
+        }
+
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        if (bind(fd, a->ai_addr, a->ai_addrlen) == 0)
+        {
+            m_Listen = fd;
+            break;
+        }
+
+        error = strerror(errno);
+        close(fd);
+    }
+    freeaddrinfo(ai);
+
+    if (m_Listen < 0)
+        throw std::runtime_error("Unable to listen on \"" + address + "\": " + error);
+}
+
+void MetricsServer::Serve()
+{
+    while (true)
+    {
+        struct pollfd fds[2] = { { m_Listen, POLLIN, 0 }, { m_Wakeup[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        if (fds[1].revents != 0)
+            return; // destructor
+
+        int fd = accept4(m_Listen, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        // A client that stops reading must not hold up the only serving thread
+        // and with it the destructor.
+        struct timeval timeout = { REQUEST_TIMEOUT_MS / 1000, (REQUEST_TIMEOUT_MS % 1000) * 1000 };
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        Answer(fd);
+        close(fd);
+    }
+}
+
+void MetricsServer::Answer(int fd)
+{
+    std::string request;
+    char buffer[1024];
+
+    while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos)
+    {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, REQUEST_TIMEOUT_MS) <= 0)
+            return;
+
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+            return;
+
+        request.append(buffer, n);
+        if (request.size() > MAX_REQUEST)
+            return;
+    }
+
+    std::istringstream line(request.substr(0, request.find('\n')));
+    std::string method, path;
+    line >> method >> path;
+
+    // The query string does not matter.
+    path = path.substr(0, path.find('?'));
+
+    if (method != "GET" && method != "HEAD")
+    {
+        SendAll(fd, Response("405 Method Not Allowed", "text/plain", "Only GET is supported.\n"));
+        return;
+    }
+
+    if (path != "/metrics")
+    {
+        SendAll(fd, Response("404 Not Found", "text/plain", "Metrics are at /metrics.\n"));
+        return;
+    }
+
+    std::ostringstream body;
+    Metrics::Write(body, m_Scheduler);
+
+    std::string response = Response("200 OK", "text/plain; version=0.0.4", body.str());
+    if (method == "HEAD")
+        response.erase(response.find("\r\n\r\n") + 4);
+
+    SendAll(fd, response);
+}
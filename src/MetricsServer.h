@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef METRICSSERVER_H_
+#define METRICSSERVER_H_
+
+#include <string>
+#include <thread>
+
+class JobScheduler;
+
+/**
+ * \brief Serves Metrics over HTTP, for Prometheus to scrape.
+ *
+ * address is a Unix socket if it contains a slash, else [HOST:]PORT, with
+ * HOST defaulting to 127.0.0.1. Requests are answered one at a time on a
+ * thread of their own: GET /metrics gets the metrics, anything else 404.
+ */
+class MetricsServer
+{
+public:
+    /** \brief Starts listening, throws std::runtime_error if that is not possible. */
+    MetricsServer(const std::string &address, const JobScheduler *scheduler);
+
+    /** \brief Stops listening and removes the Unix socket. */
+    ~MetricsServer();
+
+private:
+    MetricsServer(const MetricsServer &) = delete;
+    MetricsServer &operator=(const MetricsServer &) = delete;
+
+    void ListenUnix(const std::string &path);
+    void ListenTcp(const std::string &address);
+
+    void Serve();
+
+    /** \brief Reads one request from fd and writes the response. */
+    void Answer(int fd);
+
+    std::string m_Address;
+    const JobScheduler *m_Scheduler;
+
+    /** \brief Path of the Unix socket, empty for TCP. */
+    std::string m_SocketPath;
+    int m_Listen;
+
+    /** \brief Written to by the destructor, to stop Serve(). */
+    int m_Wakeup[2];
+
+    std::thread m_Thread;
+};
+
+#endif /*METRICSSERVER_H_*/
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "Overstrike.h"
+
+void OverstrikeCompositor::Add(gunichar c, double x, double advance, const TextStyle &style, uint64_t offset)
+{
+    Cell cell = { c, x, advance, style, false, false, offset };
+
+    // A cell is hit if it starts less than half a glyph away.
+    double tolerance = advance / 2.0;
+
+    if (m_Cells.empty() || m_Cells.back().m_X + tolerance <= x)
+    {
+        // The usual case, the first pass over the line
+        m_Cells.push_back(cell);
+        return;
+    }
+
+    auto it = std::lower_bound(m_Cells.begin(), m_Cells.end(), x - tolerance,
+        [](const Cell &other, double pos) { return other.m_X <= pos; });
+
+    for (; it != m_Cells.end() && it->m_X < x + tolerance; ++it)
+    {
+        if (Merge(*it, c, advance, style))
+            return;
+    }
+
+    // Different characters on top of each other are both drawn.
+    m_Cells.insert(it, cell);
+}
+
+bool OverstrikeCompositor::Merge(Cell &cell, gunichar c, double advance, const TextStyle &style)
+{
+    if (c == cell.m_Char)
+    {
+        cell.m_Bold = true;
+    }
+    else if (c == '_')
+    {
+        cell.m_Underline = true;
+    }
+    else if (cell.m_Char == '_')
+    {
+        // Underscores first, the text over them
+        cell.m_Char = c;
+        cell.m_Advance = advance;
+        cell.m_Style = style;
+        cell.m_Underline = true;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OVERSTRIKE_H_
+#define OVERSTRIKE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include <glibmm.h>
+
+#include "TextSidecar.h"
+
+/**
+ * \brief Collects the glyphs of a line and collapses overstrikes.
+ *
+ * Programs without printer specific bold and underline print a line, go
+ * back with a carriage return or backspaces and print over it again. A
+ * glyph added onto a cell that already holds the same character makes
+ * that cell bold, an underscore added onto a cell (or a character added
+ * onto an underscore) underlines it. Any other character is kept as a
+ * cell of its own, drawn on top as before. So every cell is drawn once,
+ * with the resulting style, when the line is complete.
+ */
+class OverstrikeCompositor
+{
+public:
+    struct Cell
+    {
+        gunichar m_Char;
+
+        /** \brief Position from the left margin and width. */
+        double m_X;
+        double m_Advance;
+
+        TextStyle m_Style;
+        bool m_Bold;
+        bool m_Underline;
+
+        /** \brief Input byte offset of the first glyph of the cell. */
+        uint64_t m_Offset;
+    };
+
+    /** \brief Adds c at x, advance wide, merging it into a cell there if it overstrikes one. */
+    void Add(gunichar c, double x, double advance, const TextStyle &style, uint64_t offset);
+
+    bool IsEmpty() const
+    {
+        return m_Cells.empty();
+    }
+
+    /** \brief The cells of the line, from left to right. */
+    const std::vector<Cell> &GetCells() const
+    {
+        return m_Cells;
+    }
+
+    void Clear()
+    {
+        m_Cells.clear();
+    }
+
+private:
+    /** \brief Merges c into cell, returns false if c does not overstrike it. */
+    static bool Merge(Cell &cell, gunichar c, double advance, const TextStyle &style);
+
+    /** \brief Ordered by m_X. */
+    std::vector<Cell> m_Cells;
+};
+
+#endif /*OVERSTRIKE_H_*/
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <stdexcept>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef HAVE_QPDF
+#include <qpdf/qpdf-c.h>
+#endif
+
+#include "PdfLinearizer.h"
+
+bool PdfLinearizer::IsAvailable()
+{
+#ifdef HAVE_QPDF
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef HAVE_QPDF
+
+namespace
+{
+    /** \brief Owns a qpdf_data handle. */
+    class QpdfHandle
+    {
+    public:
+        QpdfHandle():
+            m_Qpdf(qpdf_init())
+        {
+            qpdf_set_suppress_warnings(m_Qpdf, QPDF_TRUE);
+        }
+
+        ~QpdfHandle()
+        {
+            qpdf_cleanup(&m_Qpdf);
+        }
+
+        /** \brief Throws if code reports an error. */
+        void Check(QPDF_ERROR_CODE code, const std::string &what)
+        {
+            if (!(code & QPDF_ERRORS))
+                return;
+
+            std::string message = what;
+            if (qpdf_has_error(m_Qpdf))
+                message += ": " + std::string(qpdf_get_error_full_text(m_Qpdf, qpdf_get_error(m_Qpdf)));
+
+            throw std::runtime_error(message);
+        }
+
+        qpdf_data Get() const
+        {
+            return m_Qpdf;
+        }
+
+    private:
+        QpdfHandle(const QpdfHandle &) = delete;
+        QpdfHandle &operator=(const QpdfHandle &) = delete;
+
+        qpdf_data m_Qpdf;
+    };
+}
+
+void PdfLinearizer::Linearize(const std::string &fileName)
+{
+    std::string temp = fileName + ".lin";
+
+    try
+    {
+        QpdfHandle q;
+
+        q.Check(qpdf_read(q.Get(), fileName.c_str(), nullptr), "Unable to read \"" + fileName + "\"");
+
+        qpdf_set_linearization(q.Get(), QPDF_TRUE);
+        qpdf_set_deterministic_ID(q.Get(), QPDF_TRUE);
+
+        q.Check(qpdf_init_write(q.Get(), temp.c_str()), "Unable to create \"" + temp + "\"");
+        q.Check(qpdf_write(q.Get()), "Unable to linearize \"" + fileName + "\"");
+    }
+    catch (...)
+    {
+        unlink(temp.c_str());
+        throw;
+    }
+
+    if (rename(temp.c_str(), fileName.c_str()) != 0)
+    {
+        int err = errno;
+        unlink(temp.c_str());
+        throw std::runtime_error("Unable to rename \"" + temp + "\": " + strerror(err));
+    }
+}
+
+#else
+
+void PdfLinearizer::Linearize(const std::string &)
+{
+    throw std::runtime_error("Linearized output needs qpdf, which dotprint was built without");
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PDFLINEARIZER_H_
+#define PDFLINEARIZER_H_
+
+#include <string>
+
+/**
+ * \brief Rewrites PDF files linearized ("fast web view") using qpdf.
+ *
+ * A linearized file has the objects of the first page and the hint tables
+ * at its start, so a viewer can show page 1 after fetching only a prefix.
+ * The file ID is derived from the contents, so the same input gives the
+ * same bytes.
+ */
+class PdfLinearizer
+{
+public:
+    /** \brief Whether dotprint was built with qpdf. */
+    static bool IsAvailable();
+
+    /**
+     * \brief Replaces fileName by its linearized version.
+     *
+     * The result is written next to it and renamed over it. Throws
+     * std::runtime_error if qpdf fails or is not available.
+     */
+    static void Linearize(const std::string &fileName);
+};
+
+#endif /*PDFLINEARIZER_H_*/
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <ios>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cairo-pdf.h>
+
+#include "PdfLinearizer.h"
+#include "PdfOutput.h"
+
+namespace
+{
+    /** \brief Replaces the current time cairo writes as the creation date by a fixed one. */
+    Cairo::RefPtr<Cairo::Surface> FixCreationDate(Cairo::RefPtr<Cairo::PdfSurface> surface, bool deterministic)
+    {
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
+        // Older versions write no date at all.
+        if (deterministic)
+            cairo_pdf_surface_set_metadata(surface->cobj(), CAIRO_PDF_METADATA_CREATE_DATE, "2000-01-01T00:00:00Z");
+#else
+        (void) deterministic;
+#endif
+        return surface;
+    }
+}
+
+PdfFileOutput::PdfFileOutput(const std::string &fileName, bool chunked, bool deterministic, bool linearize):
+    m_FileName(fileName),
+    m_Chunked(chunked),
+    m_Deterministic(deterministic),
+    m_Linearize(linearize),
+    m_Chunk(0),
+    m_OutputBytes(0)
+{}
+
+std::string PdfFileOutput::ChunkName(const std::string &fileName, unsigned n)
+{
+    char number[16];
+    snprintf(number, sizeof(number), "-%04u", n);
+
+    std::string::size_type dot = fileName.rfind('.');
+    std::string::size_type slash = fileName.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return fileName + number;
+
+    return fileName.substr(0, dot) + number + fileName.substr(dot);
+}
+
+Cairo::RefPtr<Cairo::Surface> PdfFileOutput::OpenSurface(const PageSize &p)
+{
+    ++m_Chunk;
+
+    if (!m_Chunked)
+    {
+        m_CurrentName = m_FileName;
+        return FixCreationDate(Cairo::PdfSurface::create(m_CurrentName, p.m_Width, p.m_Height), m_Deterministic);
+    }
+
+    m_CurrentName = ChunkName(m_FileName, m_Chunk);
+    return FixCreationDate(Cairo::PdfSurface::create(m_CurrentName + ".part", p.m_Width, p.m_Height), m_Deterministic);
+}
+
+void PdfFileOutput::CloseSurface(Cairo::RefPtr<Cairo::Surface> surface, bool empty)
+{
+    surface->finish();
+
+    if (m_Chunked)
+    {
+        std::string part = m_CurrentName + ".part";
+
+        if (empty && m_Chunk > 1)
+        {
+            unlink(part.c_str());
+            return;
+        }
+
+        if (m_Linearize)
+            PdfLinearizer::Linearize(part);
+
+        if (rename(part.c_str(), m_CurrentName.c_str()) != 0)
+            throw std::ios_base::failure("Unable to rename \"" + part + "\": " + strerror(errno));
+    }
+    else if (m_Linearize)
+    {
+        PdfLinearizer::Linearize(m_CurrentName);
+    }
+
+    struct stat st;
+    if (stat(m_CurrentName.c_str(), &st) == 0)
+        m_OutputBytes += st.st_size;
+
+    m_Files.push_back(m_CurrentName);
+}
+
+const std::vector<std::string> &PdfFileOutput::GetFiles() const
+{
+    return m_Files;
+}
+
+uint64_t PdfFileOutput::GetOutputBytes() const
+{
+    return m_OutputBytes;
+}
+
+PdfStreamOutput::PdfStreamOutput(const Cairo::Surface::SlotWriteFunc &write, bool deterministic):
+    m_Write(write),
+    m_Deterministic(deterministic),
+    m_OutputBytes(0)
+{}
+
+Cairo::RefPtr<Cairo::Surface> PdfStreamOutput::OpenSurface(const PageSize &p)
+{
+    return FixCreationDate(Cairo::PdfSurface::create_for_stream(sigc::mem_fun(*this, &PdfStreamOutput::Write), p.m_Width, p.m_Height), m_Deterministic);
+}
+
+void PdfStreamOutput::CloseSurface(Cairo::RefPtr<Cairo::Surface> surface, bool)
+{
+    surface->finish();
+}
+
+uint64_t PdfStreamOutput::GetOutputBytes() const
+{
+    return m_OutputBytes;
+}
+
+Cairo::ErrorStatus PdfStreamOutput::Write(const unsigned char *data, unsigned int length)
+{
+    m_OutputBytes += length;
+    return m_Write(data, length);
+}
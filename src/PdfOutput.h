@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PDFOUTPUT_H_
+#define PDFOUTPUT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CairoTTY.h"
+
+/**
+ * \brief Writes the output into a PDF file, or into a series of PDF files.
+ *
+ * In chunked mode "out.pdf" becomes "out-0001.pdf", "out-0002.pdf" and so on.
+ * Each chunk is written under a ".part" name and renamed once it is complete,
+ * so a chunk file that exists can be processed right away. Empty chunks
+ * (e.g. after a trailing reset) are dropped, except the first one.
+ *
+ * If deterministic is set, the creation date is fixed, so that the same
+ * input always gives the same bytes. If linearize is set, every file is
+ * linearized by PdfLinearizer once cairo has finished it (before the
+ * rename, for chunks).
+ */
+class PdfFileOutput: public ISurfaceProvider
+{
+public:
+    PdfFileOutput(const std::string &fileName, bool chunked, bool deterministic = false, bool linearize = false);
+
+    virtual Cairo::RefPtr<Cairo::Surface> OpenSurface(const PageSize &p) override;
+    virtual void CloseSurface(Cairo::RefPtr<Cairo::Surface> surface, bool empty) override;
+
+    /** \brief Files written so far. */
+    const std::vector<std::string> &GetFiles() const;
+    uint64_t GetOutputBytes() const;
+
+    /** \brief Name of the n-th chunk (counting from 1) of fileName. */
+    static std::string ChunkName(const std::string &fileName, unsigned n);
+
+private:
+    std::string m_FileName;
+    bool m_Chunked;
+    bool m_Deterministic;
+    bool m_Linearize;
+    unsigned m_Chunk;
+    std::string m_CurrentName;
+    std::vector<std::string> m_Files;
+    uint64_t m_OutputBytes;
+};
+
+/** \brief Passes the PDF data to a write function. */
+class PdfStreamOutput: public ISurfaceProvider
+{
+public:
+    explicit PdfStreamOutput(const Cairo::Surface::SlotWriteFunc &write, bool deterministic = false);
+
+    virtual Cairo::RefPtr<Cairo::Surface> OpenSurface(const PageSize &p) override;
+    virtual void CloseSurface(Cairo::RefPtr<Cairo::Surface> surface, bool empty) override;
+
+    uint64_t GetOutputBytes() const;
+
+private:
+    Cairo::ErrorStatus Write(const unsigned char *data, unsigned int length);
+
+    Cairo::Surface::SlotWriteFunc m_Write;
+    bool m_Deterministic;
+    uint64_t m_OutputBytes;
+};
+
+#endif /*PDFOUTPUT_H_*/
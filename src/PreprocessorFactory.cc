@@ -26,18 +26,38 @@
 
 namespace
 {
-    SimplePreprocessor Simple;
-    CRLFPreprocessor CRLF;
-    EpsonPreprocessor Epson;
+    typedef ICharPreprocessor *(*Creator)();
 
-    const std::map<std::string, ICharPreprocessor*> Preprocessors =
+    struct Entry
     {
-        { "simple", &Simple },
-        { "crlf", &CRLF },
-        { "epson", &Epson }
+        Creator m_Create;
+
+        /** \brief The pipeline specialized for the preprocessor with each translator. */
+        StaticWriteFunc m_WriteAscii;
+        StaticWriteFunc m_WriteTable;
+    };
+
+    template <class T>
+    ICharPreprocessor *Create()
+    {
+        return new T();
+    }
+
+    template <class T>
+    Entry Make()
+    {
+        return Entry { &Create<T>, &StaticWrite<T, AsciiCodepageTranslator>, &StaticWrite<T, CodepageTranslator> };
+    }
+
+    // Preprocessors keep state between bytes, so every conversion gets its own instance.
+    const std::map<std::string, Entry> Preprocessors =
+    {
+        { "simple", Make<SimplePreprocessor>() },
+        { "crlf", Make<CRLFPreprocessor>() },
+        { "epson", Make<EpsonPreprocessor>() }
     };
 
-    ICharPreprocessor* DefaultPreprocessor = &Simple;
+    const std::string DefaultPreprocessor = "simple";
 }
 
 void PreprocessorFactory::Print(std::ostream &s)
@@ -45,19 +65,38 @@ void PreprocessorFactory::Print(std::ostream &s)
     for (const auto& preprocessor: Preprocessors)
     {
         s << preprocessor.first;
-        if (preprocessor.second == DefaultPreprocessor)
+        if (preprocessor.first == DefaultPreprocessor)
             s << " [default]";
         s << std::endl;
     }
 }
 
-ICharPreprocessor* PreprocessorFactory::Lookup(const std::string& name)
+bool PreprocessorFactory::Lookup(const std::string& name)
+{
+    return Preprocessors.find(name) != Preprocessors.end();
+}
+
+std::unique_ptr<ICharPreprocessor> PreprocessorFactory::Create(const std::string& name)
 {
     auto it = Preprocessors.find(name);
-    return it != Preprocessors.end() ? it->second : nullptr;
+    return std::unique_ptr<ICharPreprocessor>(it != Preprocessors.end() ? it->second.m_Create() : nullptr);
+}
+
+StaticWriteFunc PreprocessorFactory::LookupStatic(const std::string& name, const ICodepageTranslator *translator)
+{
+    auto it = Preprocessors.find(name);
+    if (it == Preprocessors.end())
+        return nullptr;
+
+    if (!translator || dynamic_cast<const AsciiCodepageTranslator *>(translator))
+        return it->second.m_WriteAscii;
+    if (dynamic_cast<const CodepageTranslator *>(translator))
+        return it->second.m_WriteTable;
+
+    return nullptr;
 }
 
-ICharPreprocessor* PreprocessorFactory::GetDefault()
+const std::string &PreprocessorFactory::GetDefault()
 {
-    return Preprocessors.begin()->second;
+    return Preprocessors.begin()->first;
 }
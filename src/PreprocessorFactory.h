@@ -21,16 +21,25 @@
 #define PREPROCESSORFACTORY_H_
 
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "CairoTTY.h"
+#include "StaticPipeline.h"
 
 class PreprocessorFactory
 {
 public:
     static void Print(std::ostream &s);
-    static ICharPreprocessor* Lookup(const std::string& name);
-    static ICharPreprocessor* GetDefault();
+    static bool Lookup(const std::string& name);
+    static std::unique_ptr<ICharPreprocessor> Create(const std::string& name);
+
+    /**
+     * \brief StaticWrite() for the preprocessor name with translator, nullptr if
+     * that combination is not compiled in and must go through CairoTTY::write().
+     */
+    static StaticWriteFunc LookupStatic(const std::string& name, const ICodepageTranslator *translator);
+    static const std::string &GetDefault();
 
     PreprocessorFactory() = delete;
 };
@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "DaemonJob.h"
+#include "InputSource.h"
+#include "PdfOutput.h"
+#include "PreprocessorFactory.h"
+#include "PrinterStream.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const uint8_t ESC = 0x1b;
+
+    volatile sig_atomic_t g_StopRequested = 0;
+
+    void RequestStop(int)
+    {
+        g_StopRequested = 1;
+    }
+}
+
+/** \brief Stands in for CairoTTY in front of the preprocessor and notes what ends a job. */
+class PrinterStream::Probe: public ICairoTTYProtected
+{
+public:
+    Probe():
+        m_Content(false),
+        m_Ejected(false),
+        m_PageEnd(false),
+        m_Reset(false)
+    {}
+
+    virtual void SetPageSize(const PageSize &) override {}
+    virtual void Home() override {}
+    virtual void NewLine() override {}
+    virtual void CarriageReturn() override {}
+    virtual void LineFeed() override {}
+    virtual void NewPage() override { m_Ejected = m_Content; m_PageEnd = true; }
+    virtual void Initialize() override { m_Reset = true; }
+    virtual void SetFontName(const std::string) override {}
+    virtual void SetFontSize(const double) override {}
+    virtual void SetFontWeight(const FontWeight) override {}
+    virtual void SetFontSlant(const FontSlant) override {}
+    virtual void StretchFont(double, double) override {}
+    virtual void UseCurrentFont() override {}
+    virtual void append(char) override { Printed(); }
+    virtual void append(gunichar) override { Printed(); }
+
+    /** \brief Something was printed in the current job. */
+    bool m_Content;
+
+    /** \brief The page was ejected (form feed) after the last character printed. */
+    bool m_Ejected;
+
+    /** \brief The last byte ended a page. */
+    bool m_PageEnd;
+
+    /** \brief The last byte completed a printer reset. */
+    bool m_Reset;
+
+private:
+    void Printed()
+    {
+        m_Content = true;
+        m_Ejected = false;
+    }
+};
+
+PrinterStream::PrinterStream(const std::string &input, const std::string &outputTemplate, const ConversionSettings &settings,
+    const SchedulerSettings &scheduler, std::chrono::milliseconds formFeedIdle, std::chrono::milliseconds idleTimeout,
+    uint64_t maxJobSize):
+    m_Input(input),
+    m_OutputTemplate(outputTemplate),
+    m_Settings(settings),
+    m_FormFeedIdle(formFeedIdle),
+    m_IdleTimeout(idleTimeout),
+    m_MaxJobSize(maxJobSize),
+    m_Fd(-1),
+    m_Preprocessor(PreprocessorFactory::Create(settings.m_Preprocessor)),
+    m_Probe(new Probe()),
+    m_JobStart(0),
+    m_JobNumber(0),
+    m_Scheduler(scheduler)
+{
+    // Jobs are converted in parallel already.
+    m_Settings.m_RasterThreads = 1;
+
+    if (m_Input == "-")
+    {
+        m_Fd = STDIN_FILENO;
+        return;
+    }
+
+    // Read and write, so that the FIFO does not reach its end whenever the writer closes it.
+    struct stat st;
+    int flags = stat(m_Input.c_str(), &st) == 0 && S_ISFIFO(st.st_mode) ? O_RDWR : O_RDONLY;
+
+    m_Fd = open(m_Input.c_str(), flags | O_CLOEXEC);
+    if (m_Fd < 0)
+        throw std::ios_base::failure("Unable to open \"" + m_Input + "\": " + strerror(errno));
+}
+
+PrinterStream::~PrinterStream()
+{
+    m_Scheduler.Shutdown(false);
+    if (m_Fd > STDIN_FILENO)
+        close(m_Fd);
+}
+
+void PrinterStream::Run()
+{
+    struct sigaction sa, oldInt, oldTerm;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = RequestStop; // no SA_RESTART, so that poll() returns
+    sigaction(SIGINT, &sa, &oldInt);
+    sigaction(SIGTERM, &sa, &oldTerm);
+
+    DaemonJob::Log("Reading " + m_Input);
+
+    uint8_t buffer[64 * 1024];
+    Clock::time_point lastInput = Clock::now();
+
+    while (!g_StopRequested)
+    {
+        int timeout = -1;
+        if (!m_Job.empty())
+        {
+            Clock::duration idle = m_Probe->m_Ejected ? m_FormFeedIdle : m_IdleTimeout;
+            Clock::duration left = lastInput + idle - Clock::now();
+            timeout = left > Clock::duration::zero() ? (int) std::chrono::duration_cast<std::chrono::milliseconds>(left).count() + 1 : 0;
+        }
+
+        struct pollfd pfd = { m_Fd, POLLIN, 0 };
+        int r = poll(&pfd, 1, timeout);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("poll: ") + strerror(errno));
+        }
+
+        if (r == 0)
+        {
+            EndJob(m_Job.size()); // idle
+            continue;
+        }
+
+        ssize_t n = read(m_Fd, buffer, sizeof(buffer));
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            throw std::ios_base::failure("Unable to read \"" + m_Input + "\": " + strerror(errno));
+        }
+
+        if (n == 0)
+            break; // end of input
+
+        lastInput = Clock::now();
+        Feed(buffer, n);
+    }
+
+    if (!m_Job.empty())
+        EndJob(m_Job.size());
+
+    m_Scheduler.Shutdown(true);
+
+    sigaction(SIGINT, &oldInt, nullptr);
+    sigaction(SIGTERM, &oldTerm, nullptr);
+}
+
+const JobScheduler &PrinterStream::GetScheduler() const
+{
+    return m_Scheduler;
+}
+
+void PrinterStream::Feed(const uint8_t *buf, size_t len)
+{
+    if (m_Job.empty())
+        m_JobStart = time(nullptr);
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        m_Job.push_back(buf[i]);
+
+        m_Probe->m_Reset = false;
+        m_Probe->m_PageEnd = false;
+        m_Preprocessor->process(*m_Probe, buf[i]);
+
+        if (m_Probe->m_Reset && m_Probe->m_Content)
+        {
+            // The reset starts the next job.
+            size_t end = m_Job.size() - 1;
+            if (end > 0 && (uint8_t) m_Job[end - 1] == ESC)
+                --end;
+
+            EndJob(end);
+            m_JobStart = time(nullptr);
+        }
+        else if (TooLarge())
+        {
+            DaemonJob::Log("Job of " + std::to_string(m_Job.size()) + " bytes ended at --max-job-size");
+            EndJob(m_Job.size());
+            m_JobStart = time(nullptr);
+        }
+    }
+}
+
+bool PrinterStream::TooLarge() const
+{
+    if (m_Job.size() >= m_MaxJobSize)
+        return true;
+
+    // The next job starts with a page of its own.
+    return m_Job.size() >= m_MaxJobSize / 2 && m_Probe->m_PageEnd;
+}
+
+void PrinterStream::EndJob(size_t len)
+{
+    // The job is handed over, only the few bytes of a reset that starts the next one stay.
+    std::shared_ptr<std::string> data = std::make_shared<std::string>(m_Job, len);
+    data->swap(m_Job);
+    data->resize(len);
+    bool content = m_Probe->m_Content;
+
+    m_Probe->m_Content = false;
+    m_Probe->m_Ejected = false;
+
+    if (m_Job.empty())
+    {
+        // Idle: the next job starts from scratch, like its conversion.
+        m_Preprocessor = PreprocessorFactory::Create(m_Settings.m_Preprocessor);
+    }
+
+    if (!content)
+        return; // nothing printed, e.g. a lone reset
+
+    std::string output;
+    do
+    {
+        output = OutputName(m_OutputTemplate, ++m_JobNumber, m_JobStart);
+    }
+    while (access((m_Settings.IsMultiFile() ? PdfFileOutput::ChunkName(output, 1) : output).c_str(), F_OK) == 0);
+
+    Clock::time_point end = Clock::now();
+    m_Scheduler.Submit([this, output, data, end]() { Process(output, *data, end); }, m_Scheduler.GetSettings().Classify(data->size()));
+}
+
+std::string PrinterStream::OutputName(const std::string &outputTemplate, unsigned n, time_t time)
+{
+    char number[16];
+    snprintf(number, sizeof(number), "%04u", n);
+
+    std::string pattern = outputTemplate;
+    if (pattern.find("%N") == std::string::npos)
+    {
+        std::string::size_type slash = pattern.rfind('/');
+        std::string::size_type dot = pattern.rfind('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            dot = pattern.size();
+        pattern.insert(dot, "-%N");
+    }
+
+    // %N first, so that strftime() does not see it; %% stays for strftime().
+    std::string expanded;
+    for (std::string::size_type i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] == '%' && i + 1 < pattern.size())
+        {
+            if (pattern[i + 1] == 'N')
+            {
+                expanded += number;
+                ++i;
+                continue;
+            }
+            expanded += pattern[i++];
+        }
+        expanded += pattern[i];
+    }
+
+    struct tm local;
+    localtime_r(&time, &local);
+
+    std::vector<char> name(expanded.size() + 256);
+    size_t size = strftime(name.data(), name.size(), expanded.c_str(), &local);
+
+    return size > 0 ? std::string(name.data(), size) : expanded;
+}
+
+void PrinterStream::Process(const std::string &output, const std::string &data, Clock::time_point end)
+{
+    std::ostringstream message;
+    bool failed = false;
+
+    try
+    {
+        MemoryInputSource in(data);
+        ConversionStats stats = DaemonJob::Convert(m_Settings, in, output);
+
+        message << output << ": " << data.size() << " bytes, " << stats.m_Pages << " pages, "
+            << std::chrono::duration<double>(Clock::now() - end).count() << " s after the job ended";
+    }
+    catch (const std::exception &e)
+    {
+        message << output << ": " << e.what();
+        failed = true;
+    }
+
+    DaemonJob::Finish(end, failed, message.str());
+}
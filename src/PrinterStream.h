@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef PRINTERSTREAM_H_
+#define PRINTERSTREAM_H_
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+
+#include "Converter.h"
+#include "JobScheduler.h"
+
+/**
+ * \brief Converts an endless printer port stream (a FIFO, or standard
+ * input) into one output file per print job.
+ *
+ * The stream is fed through a preprocessor of its own as it arrives, only
+ * to see where jobs end: a job ends before a printer reset (ESC @) that
+ * follows printed text, when a form feed is followed by formFeedIdle
+ * without input, or after idleTimeout without input in any case. So that
+ * memory stays bounded, a job also ends at the first page end from half of
+ * maxJobSize bytes on, and at maxJobSize bytes in any case. Each job
+ * is then converted on a JobScheduler with a fresh Converter, so no state
+ * carries over from one job to the next. Jobs of at least
+ * SchedulerSettings::m_BulkSize bytes run as bulk jobs. Jobs that print
+ * nothing are dropped.
+ *
+ * Output names come from a template, see OutputName(). A FIFO is opened
+ * for writing too, so that the stream does not end when the writer closes
+ * it; standard input and regular files are read up to their end.
+ */
+class PrinterStream
+{
+public:
+    PrinterStream(const std::string &input, const std::string &outputTemplate, const ConversionSettings &settings,
+        const SchedulerSettings &scheduler, std::chrono::milliseconds formFeedIdle, std::chrono::milliseconds idleTimeout,
+        uint64_t maxJobSize);
+    ~PrinterStream();
+
+    /** \brief Runs until the end of the input or SIGINT or SIGTERM, then converts the last job. */
+    void Run();
+
+    /**
+     * \brief Expands outputTemplate for job n, started at time.
+     *
+     * %N stands for the job number (4 digits), everything else is passed to
+     * strftime(). Without %N, "-%N" is inserted before the extension.
+     */
+    static std::string OutputName(const std::string &outputTemplate, unsigned n, time_t time);
+
+    const JobScheduler &GetScheduler() const;
+
+private:
+    PrinterStream(const PrinterStream &) = delete;
+    PrinterStream &operator=(const PrinterStream &) = delete;
+
+    class Probe;
+
+    /** \brief Appends len bytes to the current job, ending it at printer resets. */
+    void Feed(const uint8_t *buf, size_t len);
+
+    /** \brief Converts the first len bytes of the current job if they print anything, the rest starts the next job. */
+    void EndJob(size_t len);
+
+    void Process(const std::string &output, const std::string &data, std::chrono::steady_clock::time_point end);
+
+    /** \brief Whether the current job is large enough to end after its last byte. */
+    bool TooLarge() const;
+
+    std::string m_Input;
+    std::string m_OutputTemplate;
+    ConversionSettings m_Settings;
+    std::chrono::milliseconds m_FormFeedIdle;
+    std::chrono::milliseconds m_IdleTimeout;
+    uint64_t m_MaxJobSize;
+    int m_Fd;
+
+    std::string m_Job;
+    std::unique_ptr<ICharPreprocessor> m_Preprocessor;
+    std::unique_ptr<Probe> m_Probe;
+
+    /** \brief When the first byte of the current job arrived, for OutputName(). */
+    time_t m_JobStart;
+
+    /** \brief Number of the last job, see OutputName(). */
+    unsigned m_JobNumber;
+
+    JobScheduler m_Scheduler;
+};
+
+#endif /*PRINTERSTREAM_H_*/
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <thread>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "PdfOutput.h"
+#include "RasterOutput.h"
+
+namespace
+{
+    /** \brief Releases a cairo surface reference when going out of scope. */
+    struct SurfaceReference
+    {
+        explicit SurfaceReference(cairo_surface_t *s):
+            m_Surface(s)
+        {}
+
+        ~SurfaceReference()
+        {
+            cairo_surface_destroy(m_Surface);
+        }
+
+        cairo_surface_t *m_Surface;
+    };
+
+    unsigned DefaultThreads(unsigned threads)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+
+        return threads > 0 ? threads : 1;
+    }
+}
+
+RasterOutput::RasterOutput(const std::string &fileName, OutputFormat format, double dpi, bool firstPageOnly, unsigned threads):
+    m_FileName(fileName),
+    m_Format(format),
+    m_Dpi(dpi),
+    m_FirstPageOnly(firstPageOnly),
+    m_Threads(DefaultThreads(threads)),
+    m_Page(0),
+    m_OutputBytes(0),
+    m_Pool(m_Threads)
+{}
+
+RasterOutput::~RasterOutput()
+{
+    m_Pool.Shutdown(true);
+}
+
+Cairo::RefPtr<Cairo::Surface> RasterOutput::OpenSurface(const PageSize &p)
+{
+    ++m_Page;
+    m_PageSize = p;
+
+    cairo_rectangle_t extents = { 0.0, 0.0, p.m_Width, p.m_Height };
+
+    // Pages after the first are dropped anyway, they need no size.
+    if (m_FirstPageOnly && m_Page > 1)
+        extents.width = extents.height = 1.0;
+
+    return Cairo::RefPtr<Cairo::Surface>(new Cairo::Surface(cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents), true));
+}
+
+void RasterOutput::CloseSurface(Cairo::RefPtr<Cairo::Surface> surface, bool empty)
+{
+    surface->finish();
+
+    // Like PdfFileOutput: the first page is always output, even if blank.
+    if ((empty && m_Page > 1) || (m_FirstPageOnly && m_Page > 1))
+        return;
+
+    std::string fileName = m_FirstPageOnly ? m_FileName : PdfFileOutput::ChunkName(m_FileName, m_Files.size() + 1);
+    m_Files.push_back(fileName);
+
+    // Cairo::RefPtr counts references without atomics, so the worker gets a
+    // reference of cairo's own.
+    cairo_surface_t *page = cairo_surface_reference(surface->cobj());
+    PageSize size = m_PageSize;
+
+    m_Pool.Wait(2 * m_Threads);
+    m_Pool.Submit([this, page, size, fileName]() { Rasterize(page, size, fileName); });
+}
+
+void RasterOutput::Finish()
+{
+    m_Pool.Wait(0);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Error)
+        std::rethrow_exception(m_Error);
+}
+
+const std::vector<std::string> &RasterOutput::GetFiles() const
+{
+    return m_Files;
+}
+
+uint64_t RasterOutput::GetOutputBytes() const
+{
+    return m_OutputBytes;
+}
+
+void RasterOutput::Rasterize(cairo_surface_t *page, PageSize size, const std::string &fileName)
+{
+    SurfaceReference recording(page);
+    std::string part = fileName + ".part";
+
+    try
+    {
+        int width = (int) std::ceil(size.m_Width * m_Dpi / 72.0);
+        int height = (int) std::ceil(size.m_Height * m_Dpi / 72.0);
+
+        // PBM only needs the coverage of the (black) text.
+        SurfaceReference image(cairo_image_surface_create(m_Format == OutputFormat::Pbm ? CAIRO_FORMAT_A8 : CAIRO_FORMAT_RGB24, width, height));
+        if (cairo_surface_status(image.m_Surface) != CAIRO_STATUS_SUCCESS)
+            throw std::runtime_error("Unable to create a " + std::to_string(width) + "x" + std::to_string(height) + " image");
+
+        cairo_t *cr = cairo_create(image.m_Surface);
+        if (m_Format != OutputFormat::Pbm)
+        {
+            cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+            cairo_paint(cr);
+        }
+        cairo_scale(cr, m_Dpi / 72.0, m_Dpi / 72.0);
+        cairo_set_source_surface(cr, recording.m_Surface, 0.0, 0.0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+        cairo_surface_flush(image.m_Surface);
+
+        if (m_Format == OutputFormat::Pbm)
+        {
+            WritePbm(image.m_Surface, part);
+        }
+        else if (cairo_surface_write_to_png(image.m_Surface, part.c_str()) != CAIRO_STATUS_SUCCESS)
+        {
+            throw std::ios_base::failure("Unable to write \"" + part + "\"");
+        }
+
+        if (rename(part.c_str(), fileName.c_str()) != 0)
+            throw std::ios_base::failure("Unable to rename \"" + part + "\": " + strerror(errno));
+
+        struct stat st;
+        if (stat(fileName.c_str(), &st) == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_OutputBytes += st.st_size;
+        }
+    }
+    catch (...)
+    {
+        unlink(part.c_str());
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Error)
+            m_Error = std::current_exception();
+    }
+}
+
+void RasterOutput::WritePbm(cairo_surface_t *image, const std::string &fileName)
+{
+    int width = cairo_image_surface_get_width(image);
+    int height = cairo_image_surface_get_height(image);
+    int stride = cairo_image_surface_get_stride(image);
+    const unsigned char *data = cairo_image_surface_get_data(image);
+
+    std::ofstream out(fileName, std::ofstream::binary);
+    if (!out.is_open())
+        throw std::ios_base::failure("Unable to open \"" + fileName + "\"");
+
+    out << "P4\n" << width << " " << height << "\n";
+
+    // Rows are padded to whole bytes, the most significant bit comes first.
+    std::vector<char> row((width + 7) / 8);
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char *pixel = data + (size_t) y * stride;
+
+        std::fill(row.begin(), row.end(), 0);
+        for (int x = 0; x < width; ++x)
+        {
+            if (pixel[x] >= 0x80)
+                row[x >> 3] |= (char) (0x80 >> (x & 7));
+        }
+
+        out.write(row.data(), row.size());
+    }
+
+    out.close();
+    if (out.fail())
+        throw std::ios_base::failure("Unable to write \"" + fileName + "\"");
+}
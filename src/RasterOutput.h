@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RASTEROUTPUT_H_
+#define RASTEROUTPUT_H_
+
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CairoTTY.h"
+#include "Converter.h"
+#include "WorkerPool.h"
+
+/**
+ * \brief Writes every page as an image file, PNG or 1 bit PBM.
+ *
+ * Meant to be used with a CairoTTY splitting after every page: each page is
+ * drawn on a recording surface of its own, which CloseSurface() hands to a
+ * worker thread to be rasterized at the requested resolution and encoded.
+ * So layout stays on the calling thread while the pages are rasterized in
+ * parallel. At most two pages per thread are pending, so memory use does
+ * not depend on the page count.
+ *
+ * "out.png" becomes "out-0001.png", "out-0002.png" and so on, each written
+ * under a ".part" name and renamed once complete. Blank pages after the
+ * first are skipped, they cannot be told from the empty page following a
+ * final form feed. With firstPageOnly only the first page is rasterized,
+ * into fileName itself.
+ */
+class RasterOutput: public ISurfaceProvider
+{
+public:
+    RasterOutput(const std::string &fileName, OutputFormat format, double dpi, bool firstPageOnly, unsigned threads);
+
+    /** \brief Waits for the pages still being rasterized. */
+    virtual ~RasterOutput();
+
+    virtual Cairo::RefPtr<Cairo::Surface> OpenSurface(const PageSize &p) override;
+    virtual void CloseSurface(Cairo::RefPtr<Cairo::Surface> surface, bool empty) override;
+
+    /** \brief Waits for all pages, then rethrows the first error of a worker, if any. */
+    void Finish();
+
+    /** \brief Files written, in page order. Complete after Finish(). */
+    const std::vector<std::string> &GetFiles() const;
+    uint64_t GetOutputBytes() const;
+
+private:
+    RasterOutput(const RasterOutput &) = delete;
+    RasterOutput &operator=(const RasterOutput &) = delete;
+
+    /** \brief Rasterizes page (owning a reference) and writes it to fileName. Runs on a worker. */
+    void Rasterize(cairo_surface_t *page, PageSize size, const std::string &fileName);
+
+    /** \brief Writes an A8 image as PBM, pixels with at least half coverage are black. */
+    static void WritePbm(cairo_surface_t *image, const std::string &fileName);
+
+    std::string m_FileName;
+    OutputFormat m_Format;
+    double m_Dpi;
+    bool m_FirstPageOnly;
+    unsigned m_Threads;
+
+    unsigned m_Page;
+    PageSize m_PageSize;
+    std::vector<std::string> m_Files;
+
+    std::mutex m_Mutex;
+    uint64_t m_OutputBytes;
+    std::exception_ptr m_Error;
+
+    WorkerPool m_Pool;
+};
+
+#endif /*RASTEROUTPUT_H_*/
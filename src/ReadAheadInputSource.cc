@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <assert.h>
+
+#include "ReadAheadInputSource.h"
+
+ReadAheadInputSource::ReadAheadInputSource(IInputSource &source, unsigned depth, size_t blockSize):
+    m_Source(source),
+    m_Ring(std::max(depth, 1u)),
+    m_Head(0),
+    m_Tail(0),
+    m_Stop(false),
+    m_Offset(0)
+{
+    assert(blockSize > 0);
+
+    for (Block &b : m_Ring)
+    {
+        b.m_Data.resize(blockSize);
+        b.m_Size = 0;
+    }
+
+    m_Thread = std::thread(&ReadAheadInputSource::Reader, this);
+}
+
+ReadAheadInputSource::~ReadAheadInputSource()
+{
+    m_Stop.store(true, std::memory_order_relaxed);
+    m_Thread.join();
+}
+
+void ReadAheadInputSource::Wait(unsigned &round)
+{
+    // Spin first, then yield, then sleep for up to a millisecond.
+    if (round >= 128)
+        std::this_thread::sleep_for(std::chrono::microseconds(std::min(50u << std::min(round - 128, 5u), 1000u)));
+    else if (round >= 64)
+        std::this_thread::yield();
+
+    ++round;
+}
+
+void ReadAheadInputSource::Reader()
+{
+    size_t head = m_Head.load(std::memory_order_relaxed);
+
+    while (!m_Stop.load(std::memory_order_relaxed))
+    {
+        // Backpressure: wait for the consumer to free a block.
+        unsigned round = 0;
+        while (head - m_Tail.load(std::memory_order_acquire) == m_Ring.size())
+        {
+            if (m_Stop.load(std::memory_order_relaxed))
+                return;
+            Wait(round);
+        }
+
+        Block &b = m_Ring[head % m_Ring.size()];
+        try
+        {
+            b.m_Size = m_Source.read(b.m_Data.data(), b.m_Data.size());
+        }
+        catch (...)
+        {
+            m_Error = std::current_exception();
+            b.m_Size = 0;
+        }
+
+        // Publish the block; release makes its contents visible to the consumer.
+        m_Head.store(++head, std::memory_order_release);
+
+        if (b.m_Size == 0)
+            return; // end of input (or error)
+    }
+}
+
+size_t ReadAheadInputSource::read(uint8_t *buf, size_t len)
+{
+    size_t tail = m_Tail.load(std::memory_order_relaxed);
+
+    unsigned round = 0;
+    while (m_Head.load(std::memory_order_acquire) == tail)
+        Wait(round);
+
+    Block &b = m_Ring[tail % m_Ring.size()];
+    if (b.m_Size == 0)
+    {
+        // Leave the marker in place so that further reads return 0 too.
+        if (m_Error)
+            std::rethrow_exception(m_Error);
+        return 0;
+    }
+
+    size_t n = std::min(len, b.m_Size - m_Offset);
+    std::memcpy(buf, b.m_Data.data() + m_Offset, n);
+    m_Offset += n;
+
+    if (m_Offset == b.m_Size)
+    {
+        // Hand the block back to the reader.
+        m_Offset = 0;
+        m_Tail.store(tail + 1, std::memory_order_release);
+    }
+
+    return n;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef READAHEADINPUTSOURCE_H_
+#define READAHEADINPUTSOURCE_H_
+
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "InputSource.h"
+
+/**
+ * \brief Reads another source on a separate thread, ahead of the consumer.
+ *
+ * The reader thread fills a single-producer/single-consumer ring of
+ * depth blocks of blockSize bytes each. The ring needs no locks: the
+ * producer only advances m_Head, the consumer only advances m_Tail.
+ * When all blocks are full the reader waits for the consumer
+ * (backpressure), so at most depth * blockSize bytes are buffered.
+ *
+ * Read errors of the underlying source are rethrown by read().
+ */
+class ReadAheadInputSource: public IInputSource
+{
+public:
+    ReadAheadInputSource(IInputSource &source, unsigned depth, size_t blockSize);
+
+    /** \brief Waits for the reader thread, which finishes its current read first. */
+    virtual ~ReadAheadInputSource();
+
+    virtual size_t read(uint8_t *buf, size_t len) override;
+
+private:
+    ReadAheadInputSource(const ReadAheadInputSource &) = delete;
+    ReadAheadInputSource &operator=(const ReadAheadInputSource &) = delete;
+
+    struct Block
+    {
+        std::vector<uint8_t> m_Data;
+        size_t m_Size; // 0 marks the end of the input
+    };
+
+    void Reader();
+
+    /** \brief Backs off a little longer on every call, from spinning to sleeping. */
+    static void Wait(unsigned &round);
+
+    IInputSource &m_Source;
+    std::vector<Block> m_Ring;
+
+    /** \brief Number of blocks filled so far, written by the reader only. */
+    std::atomic<size_t> m_Head;
+
+    /** \brief Number of blocks consumed so far, written by the consumer only. */
+    std::atomic<size_t> m_Tail;
+
+    std::atomic<bool> m_Stop;
+    std::exception_ptr m_Error;
+
+    /** \brief Read position within the block at m_Tail. */
+    size_t m_Offset;
+
+    std::thread m_Thread;
+};
+
+#endif /*READAHEADINPUTSOURCE_H_*/
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "Hash.h"
+#include "InputSource.h"
+#include "ResultCache.h"
+
+namespace
+{
+    /** \brief Part of every key, change it whenever the rendering changes. */
+    const char *CACHE_FORMAT = "dotprint-cache-4";
+
+    const char *ENTRY_SUFFIX = ".pdf";
+    const char *TEMP_SUFFIX = ".tmp";
+
+    /** \brief Temporary files older than this were left behind by a crashed process. */
+    const time_t STALE_TEMP_SECONDS = 3600;
+
+    bool EndsWith(const std::string &s, const std::string &suffix)
+    {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+ResultCache::ResultCache(const std::string &dir, uint64_t maxBytes):
+    m_Dir(dir),
+    m_MaxBytes(maxBytes)
+{
+    if (mkdir(m_Dir.c_str(), 0777) != 0 && errno != EEXIST)
+        throw std::ios_base::failure("Unable to create \"" + m_Dir + "\": " + strerror(errno));
+}
+
+bool ResultCache::IsCacheable(const std::string &inputFile, const ConversionSettings &settings)
+{
+    // Standard input cannot be read twice, split outputs are several files
+    // and a saved display list or text sidecar would not be written on a hit.
+    return inputFile != "-" && !settings.IsMultiFile() && settings.m_SaveDisplayList.empty()
+        && settings.m_TextFile.empty() && settings.m_LayoutFile.empty();
+}
+
+uint64_t ResultCache::Key(const std::string &inputFile, const ConversionSettings &settings)
+{
+    Hash64 h;
+
+    h.Update(std::string(CACHE_FORMAT));
+    h.Update(settings.GetFingerprint());
+    h.Update((uint64_t) settings.m_LoadDisplayList);
+    h.Update((uint64_t) settings.m_Linearize);
+    h.Update((uint64_t) settings.m_LineTemplates);
+    h.Update((uint64_t) settings.m_Format);
+    h.Update(settings.m_Dpi);
+
+    FileInputSource in(inputFile);
+    std::vector<uint8_t> buffer(1 << 20);
+
+    while (size_t n = in.read(buffer.data(), buffer.size()))
+        h.Update(buffer.data(), n);
+
+    return h.Final();
+}
+
+std::string ResultCache::EntryName(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long) key);
+
+    return m_Dir + "/" + name + ENTRY_SUFFIX;
+}
+
+bool ResultCache::Fetch(uint64_t key, const std::string &outputFile, ConversionStats &stats)
+{
+    std::string entry = EntryName(key);
+
+    if (access(entry.c_str(), R_OK) != 0)
+        return false;
+
+    try
+    {
+        stats.m_OutputBytes = CopyFile(entry, outputFile);
+    }
+    catch (const std::ios_base::failure &)
+    {
+        // Evicted by another process in the meantime
+        if (access(entry.c_str(), F_OK) != 0)
+            return false;
+        throw;
+    }
+
+    stats.m_OutputFiles = 1;
+    stats.m_CacheHit = true;
+
+    // Mark as recently used
+    utimensat(AT_FDCWD, entry.c_str(), nullptr, 0);
+
+    return true;
+}
+
+void ResultCache::Store(uint64_t key, const std::string &outputFile)
+{
+    CopyFile(outputFile, EntryName(key));
+    Evict();
+}
+
+void ResultCache::Evict()
+{
+    struct Entry
+    {
+        std::string m_Name;
+        uint64_t m_Size;
+        struct timespec m_Used;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    DIR *d = opendir(m_Dir.c_str());
+    if (!d)
+        throw std::ios_base::failure("Unable to read \"" + m_Dir + "\": " + strerror(errno));
+
+    while (struct dirent *de = readdir(d))
+    {
+        std::string name = m_Dir + "/" + de->d_name;
+        struct stat st;
+
+        if (de->d_name[0] == '.' || stat(name.c_str(), &st) != 0)
+            continue;
+
+        if (EndsWith(name, TEMP_SUFFIX) && st.st_mtime + STALE_TEMP_SECONDS < time(nullptr))
+            unlink(name.c_str());
+
+        if (!EndsWith(name, ENTRY_SUFFIX))
+            continue;
+
+        entries.push_back(Entry{name, (uint64_t) st.st_size, st.st_mtim});
+        total += st.st_size;
+    }
+
+    closedir(d);
+
+    if (total <= m_MaxBytes)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+    {
+        if (a.m_Used.tv_sec != b.m_Used.tv_sec)
+            return a.m_Used.tv_sec < b.m_Used.tv_sec;
+        return a.m_Used.tv_nsec < b.m_Used.tv_nsec;
+    });
+
+    for (const Entry &e : entries)
+    {
+        if (total <= m_MaxBytes)
+            break;
+
+        // Another process may have removed it already, that is fine.
+        unlink(e.m_Name.c_str());
+        total -= e.m_Size;
+    }
+}
+
+uint64_t ResultCache::CopyFile(const std::string &from, const std::string &to)
+{
+    std::ifstream in(from, std::ifstream::binary);
+    if (!in.is_open())
+        throw std::ios_base::failure("Unable to open \"" + from + "\"");
+
+    std::string tmp = to + "." + std::to_string(getpid()) + TEMP_SUFFIX;
+    std::ofstream out(tmp, std::ofstream::binary);
+    if (!out.is_open())
+        throw std::ios_base::failure("Unable to create \"" + tmp + "\"");
+
+    out << in.rdbuf();
+    uint64_t size = out.tellp();
+    out.close();
+
+    if (out.fail() || in.bad())
+    {
+        unlink(tmp.c_str());
+        throw std::ios_base::failure("Unable to copy \"" + from + "\" to \"" + tmp + "\"");
+    }
+
+    if (rename(tmp.c_str(), to.c_str()) != 0)
+    {
+        int err = errno;
+        unlink(tmp.c_str());
+        throw std::ios_base::failure("Unable to rename \"" + tmp + "\": " + strerror(err));
+    }
+
+    return size;
+}
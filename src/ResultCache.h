@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESULTCACHE_H_
+#define RESULTCACHE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "Converter.h"
+
+/**
+ * \brief On-disk cache of converted PDFs, keyed by the input bytes and the settings.
+ *
+ * Each entry is a file named after its key. Entries are written under a
+ * temporary name and renamed, so readers never see partial files, and
+ * several dotprint processes can share one directory. The modification
+ * time of an entry is updated on every hit; when the directory grows over
+ * the size limit the least recently used entries are removed.
+ *
+ * Hits are only valid if the conversion is deterministic, see
+ * ConversionSettings::m_Deterministic.
+ */
+class ResultCache
+{
+public:
+    /** \brief Creates dir if it does not exist yet. */
+    ResultCache(const std::string &dir, uint64_t maxBytes);
+
+    /** \brief Whether converting inputFile with settings can be cached at all. */
+    static bool IsCacheable(const std::string &inputFile, const ConversionSettings &settings);
+
+    /** \brief Hash of the contents of inputFile and of every setting that affects the output. */
+    static uint64_t Key(const std::string &inputFile, const ConversionSettings &settings);
+
+    /** \brief Copies the entry for key to outputFile. Returns false if there is none. */
+    bool Fetch(uint64_t key, const std::string &outputFile, ConversionStats &stats);
+
+    /** \brief Adds outputFile as the entry for key, then evicts old entries if needed. */
+    void Store(uint64_t key, const std::string &outputFile);
+
+private:
+    std::string EntryName(uint64_t key) const;
+
+    /** \brief Removes least recently used entries until the cache fits into m_MaxBytes. */
+    void Evict();
+
+    /** \brief Copies from to to, through a temporary file and rename(). Returns the bytes copied. */
+    static uint64_t CopyFile(const std::string &from, const std::string &to);
+
+    std::string m_Dir;
+    uint64_t m_MaxBytes;
+};
+
+#endif /*RESULTCACHE_H_*/
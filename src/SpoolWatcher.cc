@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#include "DaemonJob.h"
+#include "DecompressingInputSource.h"
+#include "SpoolWatcher.h"
+
+namespace
+{
+    const char *DONE_DIR = "done";
+    const char *FAILED_DIR = "failed";
+
+    volatile sig_atomic_t g_StopRequested = 0;
+
+    void RequestStop(int)
+    {
+        g_StopRequested = 1;
+    }
+
+    bool EndsWith(const std::string &s, const std::string &suffix)
+    {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    void MakeDir(const std::string &dir)
+    {
+        if (mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST)
+            throw std::ios_base::failure("Unable to create \"" + dir + "\": " + strerror(errno));
+    }
+}
+
+SpoolWatcher::SpoolWatcher(const std::string &dir, const std::string &outputDir, const ConversionSettings &settings,
+    const SchedulerSettings &scheduler):
+    m_Dir(dir),
+    m_OutputDir(outputDir),
+    m_Settings(settings),
+    m_Inotify(-1),
+    m_Scheduler(scheduler)
+{
+    // The files are converted in parallel already.
+    m_Settings.m_RasterThreads = 1;
+
+    MakeDir(m_Dir + "/" + DONE_DIR);
+    MakeDir(m_Dir + "/" + FAILED_DIR);
+    MakeDir(m_OutputDir);
+
+    m_Inotify = inotify_init1(IN_CLOEXEC);
+    if (m_Inotify < 0)
+        throw std::runtime_error(std::string("inotify_init1: ") + strerror(errno));
+
+    if (inotify_add_watch(m_Inotify, m_Dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR) < 0)
+    {
+        close(m_Inotify);
+        throw std::runtime_error("Unable to watch \"" + m_Dir + "\": " + strerror(errno));
+    }
+}
+
+SpoolWatcher::~SpoolWatcher()
+{
+    m_Scheduler.Shutdown(false);
+    close(m_Inotify);
+}
+
+void SpoolWatcher::Run()
+{
+    struct sigaction sa, oldInt, oldTerm;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = RequestStop; // no SA_RESTART, so that read() returns
+    sigaction(SIGINT, &sa, &oldInt);
+    sigaction(SIGTERM, &sa, &oldTerm);
+
+    // Watch first, then scan, so that no file slips through in between.
+    Scan();
+    DaemonJob::Log("Watching " + m_Dir);
+
+    alignas(struct inotify_event) char buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+
+    while (!g_StopRequested)
+    {
+        ssize_t n = read(m_Inotify, buffer, sizeof(buffer));
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Reading inotify events: ") + strerror(errno));
+        }
+
+        for (char *p = buffer; p < buffer + n; )
+        {
+            const struct inotify_event *ev = reinterpret_cast<const struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW)
+                Scan(); // events were lost
+            else if (ev->len > 0 && !(ev->mask & IN_ISDIR))
+                Enqueue(ev->name);
+        }
+    }
+
+    DaemonJob::Log("Stopping after the conversions in progress");
+    m_Scheduler.Shutdown(false);
+
+    sigaction(SIGINT, &oldInt, nullptr);
+    sigaction(SIGTERM, &oldTerm, nullptr);
+}
+
+const JobScheduler &SpoolWatcher::GetScheduler() const
+{
+    return m_Scheduler;
+}
+
+void SpoolWatcher::Scan()
+{
+    DIR *d = opendir(m_Dir.c_str());
+    if (!d)
+        throw std::runtime_error("Unable to read \"" + m_Dir + "\": " + strerror(errno));
+
+    while (struct dirent *de = readdir(d))
+        Enqueue(de->d_name);
+
+    closedir(d);
+}
+
+void SpoolWatcher::Enqueue(const std::string &name)
+{
+    if (name.empty() || name[0] == '.' || EndsWith(name, ".part") || EndsWith(name, ".tmp"))
+        return;
+
+    struct stat st;
+    if (stat((m_Dir + "/" + name).c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return; // gone already, or the done/failed directories
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Pending.insert(name).second)
+            return; // e.g. found by the scan and reported by inotify
+    }
+
+    std::chrono::steady_clock::time_point queued = std::chrono::steady_clock::now();
+    m_Scheduler.Submit([this, name, queued]() { Process(name, queued); }, m_Scheduler.GetSettings().Classify(st.st_size));
+}
+
+std::string SpoolWatcher::OutputName(const std::string &name) const
+{
+    // The whole input name, so that a.prn, a.txt and a.prn.gz do not overwrite each other.
+    return name + m_Settings.GetFileExtension();
+}
+
+void SpoolWatcher::Process(const std::string &name, std::chrono::steady_clock::time_point queued)
+{
+    std::string input = m_Dir + "/" + name;
+    std::string output = m_OutputDir + "/" + OutputName(name);
+    std::string moveTo = m_Dir + "/" + DONE_DIR + "/" + name;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::ostringstream message;
+    bool failed = false;
+
+    try
+    {
+        FileInputSource file(input);
+        DecompressingInputSource in(file);
+        ConversionStats stats = DaemonJob::Convert(m_Settings, in, output);
+
+        message << name << " -> " << output << ": " << stats.m_Pages << " pages, "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s";
+    }
+    catch (const std::exception &e)
+    {
+        moveTo = m_Dir + "/" + FAILED_DIR + "/" + name;
+        message << name << ": " << e.what();
+        failed = true;
+    }
+
+    if (rename(input.c_str(), moveTo.c_str()) != 0)
+        message << " (unable to move it to \"" << moveTo << "\": " << strerror(errno) << ")";
+
+    DaemonJob::Finish(queued, failed, message.str());
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Pending.erase(name);
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPOOLWATCHER_H_
+#define SPOOLWATCHER_H_
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "Converter.h"
+#include "JobScheduler.h"
+
+/**
+ * \brief Converts every file that appears in a spool directory.
+ *
+ * Files are picked up when they are closed after writing or moved into
+ * the directory (inotify), plus the files present at startup. Hidden
+ * files and files ending in ".part" or ".tmp" are ignored, so writers can
+ * use such names until the file is complete.
+ *
+ * The conversions run on a JobScheduler, files of at least
+ * SchedulerSettings::m_BulkSize bytes as bulk jobs. Each output is
+ * written under a temporary name and renamed into the output directory
+ * when complete.
+ * Afterwards the input is moved into the "done" (or on errors "failed")
+ * subdirectory, so it is never converted twice.
+ */
+class SpoolWatcher
+{
+public:
+    SpoolWatcher(const std::string &dir, const std::string &outputDir, const ConversionSettings &settings,
+        const SchedulerSettings &scheduler);
+    ~SpoolWatcher();
+
+    /** \brief Runs until SIGINT or SIGTERM, then finishes the conversions in progress. */
+    void Run();
+
+    const JobScheduler &GetScheduler() const;
+
+private:
+    SpoolWatcher(const SpoolWatcher &) = delete;
+    SpoolWatcher &operator=(const SpoolWatcher &) = delete;
+
+    /** \brief Queues all files already in the directory. */
+    void Scan();
+
+    /** \brief Queues name, unless it is ignored or already queued. */
+    void Enqueue(const std::string &name);
+
+    void Process(const std::string &name, std::chrono::steady_clock::time_point queued);
+
+    /** \brief Name of the output for input name: name with ".pdf" (or ".png"...) appended. */
+    std::string OutputName(const std::string &name) const;
+
+    std::string m_Dir;
+    std::string m_OutputDir;
+    ConversionSettings m_Settings;
+    int m_Inotify;
+
+    /** \brief Files queued or being converted. */
+    std::set<std::string> m_Pending;
+    std::mutex m_Mutex;
+
+    JobScheduler m_Scheduler;
+};
+
+#endif /*SPOOLWATCHER_H_*/
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef STATICPIPELINE_H_
+#define STATICPIPELINE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AsciiCodepageTranslator.h"
+#include "CairoTTY.h"
+#include "CodepageTranslator.h"
+
+/**
+ * \brief Stands in for the ICairoTTYProtected of a CairoTTY in front of a
+ * preprocessor, with every call bound at compile time.
+ *
+ * The preprocessors are templates on the type of their TTY, see
+ * EpsonPreprocessor::Process(). Instantiated with a StaticTTY, their calls
+ * to the CairoTTY (whose methods are final) and to the translator (a final
+ * class) need no vtable, and the translation is inlined.
+ */
+template <class Translator>
+class StaticTTY
+{
+public:
+    StaticTTY(CairoTTY &ctty, Translator &translator):
+        m_TTY(ctty),
+        m_Translator(translator)
+    {}
+
+    void SetPageSize(const PageSize &p) { m_TTY.SetPageSize(p); }
+    void Home() { m_TTY.Home(); }
+    void NewLine() { m_TTY.NewLine(); }
+    void CarriageReturn() { m_TTY.CarriageReturn(); }
+    void LineFeed() { m_TTY.LineFeed(); }
+    void NewPage() { m_TTY.NewPage(); }
+    void Initialize() { m_TTY.Initialize(); }
+    void SetFontName(const std::string family) { m_TTY.SetFontName(family); }
+    void SetFontSize(const double size) { m_TTY.SetFontSize(size); }
+    void SetFontWeight(const FontWeight weight) { m_TTY.SetFontWeight(weight); }
+    void SetFontSlant(const FontSlant slant) { m_TTY.SetFontSlant(slant); }
+    void StretchFont(double stretch_x, double stretch_y = 1.0) { m_TTY.StretchFont(stretch_x, stretch_y); }
+    void UseCurrentFont() { m_TTY.UseCurrentFont(); }
+
+    void append(char c)
+    {
+        gunichar uc;
+        if (m_Translator.translate((uint8_t) c, uc))
+            m_TTY.append(uc);
+    }
+
+    void append(gunichar c) { m_TTY.append(c); }
+
+private:
+    CairoTTY &m_TTY;
+    Translator &m_Translator;
+};
+
+/** \brief translator as a Translator. */
+template <class Translator>
+Translator &StaticTranslator(ICodepageTranslator *translator)
+{
+    return static_cast<Translator &>(*translator);
+}
+
+/** \brief nullptr stands for plain ASCII. */
+template <>
+inline AsciiCodepageTranslator &StaticTranslator<AsciiCodepageTranslator>(ICodepageTranslator *translator)
+{
+    // Stateless, so one instance serves all threads.
+    static AsciiCodepageTranslator ascii;
+
+    return translator ? static_cast<AsciiCodepageTranslator &>(*translator) : ascii;
+}
+
+/**
+ * \brief Feeds len bytes to ctty like CairoTTY::write(), with the types of
+ * the preprocessor and translator known at compile time.
+ *
+ * preprocessor must be a Preprocessor, translator a Translator (nullptr
+ * for AsciiCodepageTranslator). PreprocessorFactory::LookupStatic() picks
+ * the instantiation.
+ */
+template <class Preprocessor, class Translator>
+void StaticWrite(CairoTTY &ctty, ICharPreprocessor &preprocessor, ICodepageTranslator *translator, const uint8_t *buf, size_t len)
+{
+    Preprocessor &p = static_cast<Preprocessor &>(preprocessor);
+    StaticTTY<Translator> tty(ctty, StaticTranslator<Translator>(translator));
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        p.Process(tty, buf[i]);
+        ctty.ByteDone();
+    }
+}
+
+typedef void (*StaticWriteFunc)(CairoTTY &ctty, ICharPreprocessor &preprocessor, ICodepageTranslator *translator, const uint8_t *buf, size_t len);
+
+#endif /*STATICPIPELINE_H_*/
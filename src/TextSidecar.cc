@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <ios>
+
+#include "TextSidecar.h"
+
+namespace
+{
+    void AppendUtf8(std::string &out, gunichar c)
+    {
+        if (c < 0x80)
+        {
+            out += (char) c;
+        }
+        else if (c < 0x800)
+        {
+            out += (char) (0xc0 | (c >> 6));
+            out += (char) (0x80 | (c & 0x3f));
+        }
+        else if (c < 0x10000)
+        {
+            out += (char) (0xe0 | (c >> 12));
+            out += (char) (0x80 | ((c >> 6) & 0x3f));
+            out += (char) (0x80 | (c & 0x3f));
+        }
+        else
+        {
+            out += (char) (0xf0 | (c >> 18));
+            out += (char) (0x80 | ((c >> 12) & 0x3f));
+            out += (char) (0x80 | ((c >> 6) & 0x3f));
+            out += (char) (0x80 | (c & 0x3f));
+        }
+    }
+
+    /** \brief Appends utf8 as a JSON string literal. */
+    void AppendJsonString(std::string &out, const std::string &utf8)
+    {
+        out += '"';
+        for (char c : utf8)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out += '\\';
+                out += c;
+            }
+            else if ((unsigned char) c < 0x20)
+            {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", (unsigned) c);
+                out += escape;
+            }
+            else
+            {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+
+    /** \brief Appends d with at most two decimals, no trailing zeros. */
+    void AppendNumber(std::string &out, double d)
+    {
+        char buf[32];
+        int len = snprintf(buf, sizeof(buf), "%.2f", d);
+
+        while (len > 1 && buf[len - 1] == '0')
+            --len;
+        if (buf[len - 1] == '.')
+            --len;
+
+        out.append(buf, len);
+    }
+
+    void AppendNumber(std::string &out, uint64_t n)
+    {
+        out += std::to_string(n);
+    }
+
+    /** \brief What overstriking a real character with (or on) leaves it as it is. */
+    bool IsDecoration(gunichar c)
+    {
+        return c == ' ' || c == '_';
+    }
+}
+
+TextSidecar::TextSidecar(const std::string &textFile, const std::string &layoutFile, double left):
+    m_TextFile(textFile),
+    m_LayoutFile(layoutFile),
+    m_Left(left),
+    m_Pages(0),
+    m_LastY(0.0),
+    m_Styles(1, TextStyle { 0.0, 0.0, 0.0, FontWeight::Normal, FontSlant::Normal }),
+    m_Style(0)
+{
+    if (!m_TextFile.empty())
+    {
+        m_Text.open(m_TextFile, std::ofstream::binary);
+        if (!m_Text.is_open())
+            throw std::ios_base::failure("Unable to create \"" + m_TextFile + "\"");
+    }
+
+    if (!m_LayoutFile.empty())
+    {
+        m_Layout.open(m_LayoutFile, std::ofstream::binary);
+        if (!m_Layout.is_open())
+            throw std::ios_base::failure("Unable to create \"" + m_LayoutFile + "\"");
+    }
+}
+
+void TextSidecar::SetStyle(const TextStyle &style)
+{
+    // Only a handful of styles per document.
+    for (unsigned i = 0; i < m_Styles.size(); ++i)
+    {
+        if (m_Styles[i] == style)
+        {
+            m_Style = i;
+            return;
+        }
+    }
+
+    m_Styles.push_back(style);
+    m_Style = m_Styles.size() - 1;
+}
+
+void TextSidecar::EndPage()
+{
+    // Top to bottom, left to right; overstruck glyphs stay in the order drawn.
+    std::stable_sort(m_Glyphs.begin(), m_Glyphs.end(), [](const Glyph &a, const Glyph &b)
+    {
+        return a.m_Y < b.m_Y || (a.m_Y == b.m_Y && a.m_X < b.m_X);
+    });
+
+    m_LastY = -1.0;
+
+    std::vector<Glyph>::iterator begin = m_Glyphs.begin();
+    while (begin != m_Glyphs.end())
+    {
+        std::vector<Glyph>::iterator end = begin;
+        while (end != m_Glyphs.end() && end->m_Y == begin->m_Y)
+            ++end;
+
+        WriteLine(begin, end);
+        begin = end;
+    }
+
+    if (m_Text.is_open())
+        m_Text << '\f';
+
+    ++m_Pages;
+    m_Glyphs.clear();
+}
+
+void TextSidecar::WriteLine(std::vector<Glyph>::iterator begin, std::vector<Glyph>::iterator end)
+{
+    // Overstrikes: of the glyphs on the same cell, keep the first real character.
+    std::vector<Glyph>::iterator kept = begin;
+    for (std::vector<Glyph>::iterator g = begin + 1; g != end; ++g)
+    {
+        if (g->m_X < kept->m_X + kept->m_Width / 2)
+        {
+            if (IsDecoration(kept->m_Char) && !IsDecoration(g->m_Char))
+                *kept = *g;
+        }
+        else
+        {
+            *++kept = *g;
+        }
+    }
+    end = kept + 1;
+
+    if (m_Text.is_open() && m_LastY >= 0.0)
+    {
+        // Skipped lines
+        int blank = (int) ((begin->m_Y - m_LastY) / begin->m_LineHeight + 0.5) - 1;
+        for (int i = 0; i < blank; ++i)
+            m_Text << '\n';
+    }
+    m_LastY = begin->m_Y;
+
+    m_Line.clear();
+    m_Runs.clear();
+
+    double cursor = m_Left;
+    uint64_t chars = 0;
+    std::vector<Glyph>::iterator run = end;
+    uint64_t runStart = 0;
+
+    for (std::vector<Glyph>::iterator g = begin; g != end; ++g)
+    {
+        bool gap = g->m_Width > 0.0 && g->m_X > cursor + g->m_Width / 2;
+        bool newRun = m_Layout.is_open() && (run == end || gap || g->m_Style != run->m_Style);
+
+        if (newRun && run != end)
+            AppendRun(*run, *(g - 1), runStart, chars - runStart, cursor - run->m_X);
+
+        if (gap)
+        {
+            int spaces = (int) ((g->m_X - cursor) / g->m_Width + 0.5);
+            m_Line.append(spaces, ' ');
+            chars += spaces;
+        }
+
+        if (newRun)
+        {
+            run = g;
+            runStart = chars;
+        }
+
+        AppendUtf8(m_Line, g->m_Char);
+        ++chars;
+        cursor = g->m_X + g->m_Width;
+    }
+
+    if (run != end)
+        AppendRun(*run, *(end - 1), runStart, chars - runStart, cursor - run->m_X);
+
+    if (m_Text.is_open())
+    {
+        m_Text.write(m_Line.data(), m_Line.size());
+        m_Text << '\n';
+    }
+
+    if (m_Layout.is_open())
+    {
+        std::string json = "{\"page\":";
+        AppendNumber(json, (uint64_t) m_Pages + 1);
+        json += ",\"x\":";
+        AppendNumber(json, begin->m_X);
+        json += ",\"y\":";
+        AppendNumber(json, begin->m_Y);
+        json += ",\"text\":";
+        AppendJsonString(json, m_Line);
+        json += ",\"runs\":[";
+        json += m_Runs;
+        json += "]}\n";
+
+        m_Layout.write(json.data(), json.size());
+    }
+}
+
+void TextSidecar::AppendRun(const Glyph &first, const Glyph &last, uint64_t start, uint64_t length, double width)
+{
+    const TextStyle &style = m_Styles[first.m_Style];
+
+    if (!m_Runs.empty())
+        m_Runs += ',';
+
+    m_Runs += "{\"start\":";
+    AppendNumber(m_Runs, start);
+    m_Runs += ",\"length\":";
+    AppendNumber(m_Runs, length);
+    m_Runs += ",\"x\":";
+    AppendNumber(m_Runs, first.m_X);
+    m_Runs += ",\"width\":";
+    AppendNumber(m_Runs, width);
+    m_Runs += ",\"size\":";
+    AppendNumber(m_Runs, style.m_Size);
+    m_Runs += ",\"stretch\":[";
+    AppendNumber(m_Runs, style.m_StretchX);
+    m_Runs += ',';
+    AppendNumber(m_Runs, style.m_StretchY);
+    m_Runs += "],\"bold\":";
+    m_Runs += style.m_Weight == FontWeight::Bold ? "true" : "false";
+    m_Runs += ",\"italic\":";
+    m_Runs += style.m_Slant == FontSlant::Italic ? "true" : "false";
+    m_Runs += ",\"offset\":";
+    AppendNumber(m_Runs, first.m_Offset);
+    m_Runs += ",\"end\":";
+    AppendNumber(m_Runs, last.m_Offset + 1);
+    m_Runs += '}';
+}
+
+void TextSidecar::Finish()
+{
+    if (!m_Glyphs.empty())
+        EndPage();
+
+    if (m_Text.is_open())
+    {
+        m_Text.close();
+        if (m_Text.fail())
+            throw std::ios_base::failure("Unable to write \"" + m_TextFile + "\"");
+    }
+
+    if (m_Layout.is_open())
+    {
+        m_Layout.close();
+        if (m_Layout.fail())
+            throw std::ios_base::failure("Unable to write \"" + m_LayoutFile + "\"");
+    }
+}
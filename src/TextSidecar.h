@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEXTSIDECAR_H_
+#define TEXTSIDECAR_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CairoTTY.h"
+
+/** \brief Style of the glyphs passed to TextSidecar, as CairoTTY draws them. */
+struct TextStyle
+{
+    double m_Size;
+    double m_StretchX;
+    double m_StretchY;
+    FontWeight m_Weight;
+    FontSlant m_Slant;
+
+    bool operator==(const TextStyle &other) const
+    {
+        return m_Size == other.m_Size && m_StretchX == other.m_StretchX && m_StretchY == other.m_StretchY
+            && m_Weight == other.m_Weight && m_Slant == other.m_Slant;
+    }
+};
+
+/**
+ * \brief Writes the text of the pages, as laid out by CairoTTY, to a plain
+ * text file and/or a layout file, during the conversion.
+ *
+ * The glyphs of a page are collected and written when the page is complete,
+ * line by line (glyphs sharing a baseline), top to bottom and left to right.
+ * Gaps become spaces, glyphs overstruck on the same cell (bold or underlined
+ * by backspacing or carriage return) are written once.
+ *
+ * The text file is UTF-8, a form feed separates the pages. The layout file
+ * holds one JSON object per line of text (NDJSON):
+ *
+ *     {"page":1,"x":42.52,"y":70.87,"text":"Total  12.50",
+ *      "runs":[{"start":0,"length":5,"x":42.52,"width":30,"size":10,"stretch":[1,1],
+ *               "bold":true,"italic":false,"offset":1290,"end":1295},...]}
+ *
+ * Positions are in points from the top left corner of the page, y is the
+ * baseline. A run is a stretch of glyphs without gaps in one style; start
+ * and length count code points of text, offset and end the bytes of the
+ * input the run was drawn from.
+ */
+class TextSidecar
+{
+public:
+    /**
+     * \brief Either file name may be empty. Lines are indented relative to
+     * left (the left margin). Throws std::ios_base::failure if a file
+     * cannot be created.
+     */
+    TextSidecar(const std::string &textFile, const std::string &layoutFile, double left);
+
+    /** \brief Glyph c was drawn with its origin at (x, y), advancing by width, from input byte offset. */
+    void AddGlyph(gunichar c, double x, double y, double width, double lineHeight, const TextStyle &style, uint64_t offset)
+    {
+        if (!(style == m_Styles[m_Style]))
+            SetStyle(style);
+
+        m_Glyphs.push_back(Glyph { c, x, y, width, lineHeight, m_Style, offset });
+    }
+
+    /** \brief The current page is complete, writes its text. */
+    void EndPage();
+
+    /** \brief Closes the files, throws std::ios_base::failure if writing failed. */
+    void Finish();
+
+private:
+    TextSidecar(const TextSidecar &) = delete;
+    TextSidecar &operator=(const TextSidecar &) = delete;
+
+    struct Glyph
+    {
+        gunichar m_Char;
+        double m_X;
+        double m_Y;
+        double m_Width;
+        double m_LineHeight;
+        unsigned m_Style;
+        uint64_t m_Offset;
+    };
+
+    void SetStyle(const TextStyle &style);
+
+    /** \brief Writes the glyphs [begin, end), one line sorted by x, to the files. */
+    void WriteLine(std::vector<Glyph>::iterator begin, std::vector<Glyph>::iterator end);
+
+    /** \brief Appends the run of the glyphs first to last, at [start, start + length) of the line text, to m_Runs. */
+    void AppendRun(const Glyph &first, const Glyph &last, uint64_t start, uint64_t length, double width);
+
+    std::string m_TextFile;
+    std::string m_LayoutFile;
+    std::ofstream m_Text;
+    std::ofstream m_Layout;
+    double m_Left;
+
+    /** \brief Pages written so far. */
+    unsigned m_Pages;
+
+    /** \brief Baseline of the last line written on the current page, for blank lines. */
+    double m_LastY;
+
+    std::vector<TextStyle> m_Styles;
+    unsigned m_Style;
+
+    /** \brief Glyphs of the current page. */
+    std::vector<Glyph> m_Glyphs;
+
+    /** \brief Buffers reused for every line. */
+    std::string m_Line;
+    std::string m_Runs;
+};
+
+#endif /*TEXTSIDECAR_H_*/
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "TranslationTable.h"
+
+const gunichar TranslationTable::NONE;
+
+TranslationTable::TranslationTable()
+{
+    Clear();
+}
+
+void TranslationTable::Clear()
+{
+    for (gunichar &c : m_Map)
+        c = NONE;
+    std::memset(m_Utf8, 0, sizeof(m_Utf8));
+    std::memset(m_Utf8Length, 0, sizeof(m_Utf8Length));
+    m_AsciiIdentity = 0;
+}
+
+void TranslationTable::Set(uint8_t in, gunichar out)
+{
+    if (in < 0x80)
+        m_AsciiIdentity += (out == in) - (m_Map[in] == in);
+
+    m_Map[in] = out;
+    m_Utf8Length[in] = out == NONE ? 0 : g_unichar_to_utf8(out, m_Utf8[in]);
+}
+
+size_t TranslationTable::AsciiPrefix(const uint8_t *in, size_t len)
+{
+    size_t i = 0;
+
+#ifdef __SSE2__
+    for (; i + 16 <= len; i += 16)
+    {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+        if (mask != 0)
+            return i + __builtin_ctz(mask);
+    }
+#endif
+
+    while (i < len && in[i] < 0x80)
+        ++i;
+
+    return i;
+}
+
+size_t TranslationTable::Translate(const uint8_t *in, size_t len, gunichar *out, std::vector<size_t> *missing) const
+{
+    gunichar *start = out;
+    size_t i = 0;
+
+    while (i < len)
+    {
+        if (m_AsciiIdentity == 128)
+        {
+            size_t n = AsciiPrefix(in + i, len - i);
+            size_t j = 0;
+
+#ifdef __SSE2__
+            // Zero extend 16 bytes to 16 code points.
+            const __m128i zero = _mm_setzero_si128();
+            for (; j + 16 <= n; j += 16)
+            {
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + j));
+                __m128i lo = _mm_unpacklo_epi8(b, zero);
+                __m128i hi = _mm_unpackhi_epi8(b, zero);
+                __m128i *o = reinterpret_cast<__m128i *>(out + j);
+                _mm_storeu_si128(o, _mm_unpacklo_epi16(lo, zero));
+                _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo, zero));
+                _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi, zero));
+                _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi, zero));
+            }
+#endif
+            for (; j < n; ++j)
+                out[j] = in[i + j];
+
+            out += n;
+            i += n;
+            if (i == len)
+                break;
+        }
+
+        gunichar c = m_Map[in[i]];
+        if (c != NONE)
+            *out++ = c;
+        else if (missing)
+            missing->push_back(i);
+        ++i;
+    }
+
+    return out - start;
+}
+
+void TranslationTable::TranslateUtf8(const uint8_t *in, size_t len, std::string &out, std::vector<size_t> *missing) const
+{
+    size_t i = 0;
+
+    out.reserve(out.size() + len);
+
+    while (i < len)
+    {
+        if (m_AsciiIdentity == 128)
+        {
+            size_t n = AsciiPrefix(in + i, len - i);
+            out.append(reinterpret_cast<const char *>(in + i), n);
+            i += n;
+            if (i == len)
+                break;
+        }
+
+        uint8_t b = in[i];
+        if (m_Utf8Length[b] > 0)
+            out.append(m_Utf8[b], m_Utf8Length[b]);
+        else if (missing)
+            missing->push_back(i);
+        ++i;
+    }
+}
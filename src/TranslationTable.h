@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TRANSLATIONTABLE_H_
+#define TRANSLATIONTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glibmm.h>
+
+/**
+ * \brief Flat table from bytes to code points, with bulk translation.
+ *
+ * Every entry also keeps its UTF-8 encoding, so a span can be translated
+ * into UTF-32 or UTF-8 without branching on the code point. Runs of bytes
+ * below 0x80 are copied 16 at a time if the table maps them to themselves,
+ * which all shipped tables do.
+ */
+class TranslationTable
+{
+public:
+    /** \brief Entry of a byte without translation, not a valid code point. */
+    static const gunichar NONE = 0xffffffff;
+
+    TranslationTable();
+
+    /** \brief Sets the translation of in, NONE removes it. */
+    void Set(uint8_t in, gunichar out);
+
+    /** \brief Removes all entries. */
+    void Clear();
+
+    bool Get(uint8_t in, gunichar &out) const
+    {
+        out = m_Map[in];
+        return out != NONE;
+    }
+
+    /**
+     * \brief Translates len bytes into out, which must have room for len code points.
+     *
+     * Bytes without a translation are skipped, their positions in in are
+     * appended to missing if it is not null. Returns the number of code
+     * points written.
+     */
+    size_t Translate(const uint8_t *in, size_t len, gunichar *out, std::vector<size_t> *missing) const;
+
+    /** \brief Like Translate(), but appends the translation to out as UTF-8. */
+    void TranslateUtf8(const uint8_t *in, size_t len, std::string &out, std::vector<size_t> *missing) const;
+
+private:
+    /** \brief Length of the ASCII prefix of in, only bytes below 0x80. */
+    static size_t AsciiPrefix(const uint8_t *in, size_t len);
+
+    gunichar m_Map[256];
+
+    /** \brief UTF-8 encoding of each entry, m_Utf8Length[b] bytes long (0 for NONE). */
+    char m_Utf8[256][4];
+    uint8_t m_Utf8Length[256];
+
+    /** \brief Number of bytes below 0x80 that map to themselves, 128 enables the fast path. */
+    unsigned m_AsciiIdentity;
+};
+
+#endif /*TRANSLATIONTABLE_H_*/
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "Metrics.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+}
+
+WorkerPool::WorkerPool(unsigned threads):
+    m_Running(0),
+    m_Stop(false)
+{
+    for (unsigned i = 0; i < std::max(threads, 1u); ++i)
+        m_Threads.push_back(std::thread(&WorkerPool::Worker, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+    Shutdown(true);
+}
+
+void WorkerPool::Submit(Job job)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    m_Jobs.push_back(std::move(job));
+    m_Changed.notify_one();
+}
+
+void WorkerPool::Shutdown(bool drain)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (!drain)
+            m_Jobs.clear();
+        m_Stop = true;
+        m_Changed.notify_all();
+        m_Finished.notify_all();
+    }
+
+    for (std::thread &t : m_Threads)
+    {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+void WorkerPool::Wait(size_t maxPending)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    m_Finished.wait(lock, [this, maxPending]() { return m_Jobs.size() + m_Running <= maxPending; });
+}
+
+void WorkerPool::Worker()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+        m_Changed.wait(lock, [this]() { return m_Stop || !m_Jobs.empty(); });
+        if (m_Jobs.empty())
+            return; // stopped and drained
+
+        Job job = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+        ++m_Running;
+
+        lock.unlock();
+        Clock::time_point start = Clock::now();
+        job();
+        Metrics::Add(Metrics::RASTER_BUSY_MICROSECONDS, std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+        lock.lock();
+
+        --m_Running;
+        m_Finished.notify_all();
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORKERPOOL_H_
+#define WORKERPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** \brief Fixed number of threads running submitted jobs in FIFO order. */
+class WorkerPool
+{
+public:
+    typedef std::function<void()> Job;
+
+    /** \brief Starts threads threads, at least one. */
+    explicit WorkerPool(unsigned threads);
+
+    /** \brief Same as Shutdown(true). */
+    ~WorkerPool();
+
+    /** \brief Queues job. Jobs must not throw. */
+    void Submit(Job job);
+
+    /**
+     * \brief Stops the threads after the jobs running now, and if drain
+     * is set, all queued jobs too. Queued jobs are dropped otherwise.
+     */
+    void Shutdown(bool drain);
+
+    /** \brief Blocks until at most maxPending jobs are queued or running. */
+    void Wait(size_t maxPending);
+
+private:
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void Worker();
+
+    std::vector<std::thread> m_Threads;
+    std::deque<Job> m_Jobs;
+
+    /** \brief Jobs taken by a thread and not finished yet, for Wait(). */
+    size_t m_Running;
+    bool m_Stop;
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+
+    /** \brief Signalled whenever a job has finished. */
+    std::condition_variable m_Finished;
+};
+
+#endif /*WORKERPOOL_H_*/
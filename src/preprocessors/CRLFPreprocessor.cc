@@ -21,8 +21,15 @@
 #include <iomanip>
 #include <glibmm.h>
 #include "CRLFPreprocessor.h"
+#include "../StaticPipeline.h"
 
 void CRLFPreprocessor::process(ICairoTTYProtected &ctty, uint8_t c)
+{
+    Process(ctty, c);
+}
+
+template <class TTY>
+void CRLFPreprocessor::Process(TTY &ctty, uint8_t c)
 {
     if (iscntrl(c))
     {
@@ -52,3 +59,6 @@ void CRLFPreprocessor::process(ICairoTTYProtected &ctty, uint8_t c)
     else
         ctty.append((char) c);
 }
+
+template void CRLFPreprocessor::Process(StaticTTY<AsciiCodepageTranslator> &, uint8_t);
+template void CRLFPreprocessor::Process(StaticTTY<CodepageTranslator> &, uint8_t);
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "CharacterTableSet.h"
+#include "../AsciiCodepageTranslator.h"
+
+namespace
+{
+    /** \brief The bytes an international character set replaces. */
+    const uint8_t NATIONAL_BYTES[12] = { 0x23, 0x24, 0x40, 0x5b, 0x5c, 0x5d, 0x5e, 0x60, 0x7b, 0x7c, 0x7d, 0x7e };
+
+    /** \brief Their characters in each set, in the order of NATIONAL_BYTES. */
+    const gunichar NATIONAL_CHARS[][12] =
+    {
+        // 0: USA
+        { '#', '$', '@', '[', '\\', ']', '^', '`', '{', '|', '}', '~' },
+        // 1: France
+        { '#', '$', 0xe0, 0xb0, 0xe7, 0xa7, '^', '`', 0xe9, 0xf9, 0xe8, 0xa8 },
+        // 2: Germany
+        { '#', '$', 0xa7, 0xc4, 0xd6, 0xdc, '^', '`', 0xe4, 0xf6, 0xfc, 0xdf },
+        // 3: United Kingdom
+        { 0xa3, '$', '@', '[', '\\', ']', '^', '`', '{', '|', '}', '~' },
+        // 4: Denmark I
+        { '#', '$', '@', 0xc6, 0xd8, 0xc5, '^', '`', 0xe6, 0xf8, 0xe5, '~' },
+        // 5: Sweden
+        { '#', 0xa4, 0xc9, 0xc4, 0xd6, 0xc5, 0xdc, 0xe9, 0xe4, 0xf6, 0xe5, 0xfc },
+        // 6: Italy
+        { '#', '$', '@', 0xb0, '\\', 0xe9, '^', 0xf9, 0xe0, 0xf2, 0xe8, 0xec },
+        // 7: Spain I
+        { 0x20a7, '$', '@', 0xa1, 0xd1, 0xbf, '^', '`', 0xa8, 0xf1, '}', '~' },
+        // 8: Japan
+        { '#', '$', '@', '[', 0xa5, ']', '^', '`', '{', '|', '}', '~' },
+        // 9: Norway
+        { '#', 0xa4, 0xc9, 0xc6, 0xd8, 0xc5, 0xdc, 0xe9, 0xe6, 0xf8, 0xe5, 0xfc },
+        // 10: Denmark II
+        { '#', '$', 0xc9, 0xc6, 0xd8, 0xc5, 0xdc, 0xe9, 0xe6, 0xf8, 0xe5, 0xfc },
+        // 11: Spain II
+        { '#', '$', 0xe1, 0xa1, 0xd1, 0xbf, 0xe9, '`', 0xed, 0xf1, 0xf3, 0xfa },
+        // 12: Latin America
+        { '#', '$', 0xe1, 0xa1, 0xd1, 0xbf, 0xe9, 0xfc, 0xed, 0xf1, 0xf3, 0xfa },
+        // 13: Korea
+        { '#', '$', '@', '[', 0x20a9, ']', '^', '`', '{', '|', '}', '~' },
+        // 64: Legal
+        { '#', '$', 0xa7, 0xb0, '\'', '"', 0xb6, '`', 0xa9, 0xae, 0x2020, 0x2122 }
+    };
+
+    /** \brief ESC t 0. */
+    const uint8_t ITALIC_TABLE = 0;
+}
+
+CharacterTableSet::CharacterTableSet(const ICodepageTranslator *base):
+    m_Base(base)
+{
+    static_assert(sizeof(NATIONAL_CHARS) / sizeof(NATIONAL_CHARS[0]) == NATIONALS, "one row per character set");
+}
+
+bool CharacterTableSet::IsNational(uint8_t n)
+{
+    return n <= 13 || n == 64;
+}
+
+bool CharacterTableSet::IsTable(uint8_t n)
+{
+    return n <= 3;
+}
+
+void CharacterTableSet::GetNationalChars(std::vector<gunichar> &chars)
+{
+    // The italic table adds none, it repeats the characters below 0x80.
+    for (const gunichar (&national)[12] : NATIONAL_CHARS)
+    {
+        for (gunichar c : national)
+        {
+            if (c >= 0x80 && std::find(chars.begin(), chars.end(), c) == chars.end())
+                chars.push_back(c);
+        }
+    }
+}
+
+unsigned CharacterTableSet::NationalIndex(uint8_t n)
+{
+    return n == 64 ? NATIONALS - 1 : n;
+}
+
+const TranslationTable *CharacterTableSet::Get(uint8_t national, uint8_t table)
+{
+    unsigned n = NationalIndex(national);
+    bool italic = table == ITALIC_TABLE;
+
+    if (n == 0 && !italic)
+        return nullptr;
+
+    std::unique_ptr<TranslationTable> &t = m_Tables[n][italic];
+    if (t)
+        return t.get();
+
+    static AsciiCodepageTranslator ascii;
+    const ICodepageTranslator &base = m_Base ? *m_Base : ascii;
+
+    t.reset(new TranslationTable());
+    for (unsigned b = 0; b < 256; ++b)
+    {
+        gunichar c;
+        if (base.lookup((uint8_t) b, c))
+            t->Set((uint8_t) b, c);
+    }
+
+    for (unsigned i = 0; i < 12; ++i)
+        t->Set(NATIONAL_BYTES[i], NATIONAL_CHARS[n][i]);
+
+    if (italic)
+    {
+        // The italic table repeats the printable characters from 0xa0, drawn upright
+        // here. Printers treat 0x80 to 0x9f as control codes with it, see ESC 6/ESC 7.
+        for (unsigned b = 0xa0; b < 0x100; ++b)
+        {
+            gunichar c;
+            t->Set((uint8_t) b, t->Get((uint8_t) (b - 0x80), c) ? c : TranslationTable::NONE);
+        }
+    }
+
+    return t.get();
+}
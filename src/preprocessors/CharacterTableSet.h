@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHARACTER_TABLE_SET_H_
+#define CHARACTER_TABLE_SET_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../CairoTTY.h"
+#include "../TranslationTable.h"
+
+/**
+ * \brief The character tables an ESC/P printer switches between, as flat
+ * translation tables derived from the translator of the conversion.
+ *
+ * ESC R selects one of the international character sets, which replace
+ * 12 characters below 0x80. ESC t selects the table for the bytes from
+ * 0x80: the italic table repeats the characters below 0x80 there, the
+ * other tables are taken to be the one the translator describes (the
+ * code page the printer is set up with).
+ *
+ * Each combination is built the first time it is asked for and kept,
+ * switching back and forth costs nothing after that.
+ */
+class CharacterTableSet
+{
+public:
+    /** \brief base nullptr stands for AsciiCodepageTranslator. */
+    explicit CharacterTableSet(const ICodepageTranslator *base);
+
+    /** \brief Whether ESC R n selects a known international character set. */
+    static bool IsNational(uint8_t n);
+
+    /** \brief Whether ESC t n selects a known character table. */
+    static bool IsTable(uint8_t n);
+
+    /** \brief Appends the characters beyond ASCII the international character sets have, each once. */
+    static void GetNationalChars(std::vector<gunichar> &chars);
+
+    /**
+     * \brief The table for ESC R national and ESC t table, both valid.
+     *
+     * Returns nullptr if that is the base translator, the bytes are best
+     * translated by the TTY then.
+     */
+    const TranslationTable *Get(uint8_t national, uint8_t table);
+
+private:
+    CharacterTableSet(const CharacterTableSet &) = delete;
+    CharacterTableSet &operator=(const CharacterTableSet &) = delete;
+
+    /** \brief Number of international character sets, ESC R 0 to 13 and 64. */
+    static const unsigned NATIONALS = 15;
+
+    static unsigned NationalIndex(uint8_t n);
+
+    const ICodepageTranslator *m_Base;
+
+    /** \brief By national index and italic table or not. */
+    std::unique_ptr<TranslationTable> m_Tables[NATIONALS][2];
+};
+
+#endif // CHARACTER_TABLE_SET_H_
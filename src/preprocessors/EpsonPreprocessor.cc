@@ -17,229 +17,448 @@
  * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 #include <iomanip>
 #include <glibmm.h>
 #include "EpsonPreprocessor.h"
+#include "../Metrics.h"
+#include "../StaticPipeline.h"
 
 EpsonPreprocessor::EpsonPreprocessor():
     m_InputState(InputState::InputNormal),
-    m_EscapeState(EscapeState::Entered), // not used unless m_InputState is Escape
-    m_FontSizeState(FontSizeState::FontSizeNormal)
+    m_FontSizeState(FontSizeState::FontSizeNormal),
+    m_Command(0),
+    m_Params(),
+    m_ParamCount(0),
+    m_ParamsNeeded(0),
+    m_Phase(0),
+    m_DataLeft(0),
+    m_Remaining(0),
+    m_National(0),
+    m_CharacterTable(1),
+    m_UpperControl(false),
+    m_Translator(nullptr),
+    m_Table(nullptr)
 {}
 
+void EpsonPreprocessor::SaveState(std::ostream &out) const
+{
+    int32_t state[STATE_SIZE] = {
+        static_cast<int32_t>(m_InputState),
+        static_cast<int32_t>(m_FontSizeState),
+        m_Command,
+        static_cast<int32_t>(m_ParamCount),
+        static_cast<int32_t>(m_ParamsNeeded),
+        static_cast<int32_t>(m_Phase),
+        static_cast<int32_t>(m_DataLeft),
+        static_cast<int32_t>(m_Remaining),
+        m_National,
+        m_CharacterTable,
+        m_UpperControl
+    };
+    for (unsigned i = 0; i < EscpCommandTable::MAX_PARAMS; ++i)
+        state[11 + i] = m_Params[i];
+
+    out.write(reinterpret_cast<const char *>(state), sizeof(state));
+}
+
+void EpsonPreprocessor::LoadState(std::istream &in)
+{
+    int32_t state[STATE_SIZE];
+
+    if (!in.read(reinterpret_cast<char *>(state), sizeof(state))
+        || static_cast<uint32_t>(state[0]) > static_cast<uint32_t>(InputState::RleCount)
+        || static_cast<uint32_t>(state[1]) > static_cast<uint32_t>(FontSizeState::Condensed)
+        || static_cast<uint32_t>(state[2]) > 0xff
+        || static_cast<uint32_t>(state[4]) > EscpCommandTable::MAX_PARAMS
+        || static_cast<uint32_t>(state[3]) > static_cast<uint32_t>(state[4])
+        || static_cast<uint32_t>(state[8]) > 0xff || !CharacterTableSet::IsNational(state[8])
+        || static_cast<uint32_t>(state[9]) > 0xff || !CharacterTableSet::IsTable(state[9])
+        || static_cast<uint32_t>(state[10]) > 1)
+        throw std::runtime_error("EpsonPreprocessor::LoadState(): invalid state");
+
+    m_InputState = static_cast<InputState>(state[0]);
+    m_FontSizeState = static_cast<FontSizeState>(state[1]);
+    m_Command = state[2];
+    m_ParamCount = state[3];
+    m_ParamsNeeded = state[4];
+    m_Phase = state[5];
+    m_DataLeft = state[6];
+    m_Remaining = state[7];
+    m_National = state[8];
+    m_CharacterTable = state[9];
+    m_UpperControl = state[10];
+    for (unsigned i = 0; i < EscpCommandTable::MAX_PARAMS; ++i)
+        m_Params[i] = state[11 + i];
+
+    SelectTable();
+}
+
+void EpsonPreprocessor::SetTranslator(const ICodepageTranslator *translator)
+{
+    m_Translator = translator;
+    m_CharacterTables.reset();
+    SelectTable();
+}
+
+void EpsonPreprocessor::GetExtraChars(std::vector<gunichar> &chars) const
+{
+    CharacterTableSet::GetNationalChars(chars);
+}
+
+void EpsonPreprocessor::SelectTable()
+{
+    m_Table = nullptr;
+    if (m_National == 0 && m_CharacterTable != 0)
+        return; // the TTY's translator
+
+    if (!m_CharacterTables)
+        m_CharacterTables.reset(new CharacterTableSet(m_Translator));
+    m_Table = m_CharacterTables->Get(m_National, m_CharacterTable);
+}
+
+void EpsonPreprocessor::Unknown(uint8_t c)
+{
+    static const unsigned slot = Metrics::RegisterTranslator("epson");
+
+    int i = c;
+    Metrics::AddUnknownByte(slot);
+    std::cerr << "EpsonPreprocessor::process(): Dropping unknown char 0x"
+        << std::setfill('0') << std::setw(2) << std::hex << i << std::dec << " of the selected character table" << std::endl;
+}
+
 void EpsonPreprocessor::process(ICairoTTYProtected &ctty, uint8_t c)
 {
-    if (m_InputState == InputState::Escape)
-        handleEscape(ctty, c);
-    else
+    Process(ctty, c);
+}
+
+template <class TTY>
+void EpsonPreprocessor::Process(TTY &ctty, uint8_t c)
+{
+    switch (m_InputState)
     {
-        // Control codes handled here
-        switch (c)
-        {
-        case 0x0e: // Expanded printing for one line
-            ctty.StretchFont(2.0);
-            m_FontSizeState = FontSizeState::SingleLineExpanded;
-            break;
-
-        case 0x14: // Cancel one-line expanded printing
-            ctty.StretchFont(1.0);
-            m_FontSizeState = FontSizeState::FontSizeNormal;
-            break;
-
-        case 0x0f: // Condensed printing
-            ctty.StretchFont(10.0/17.0); // Change from 10 CPI to 17 CPI
-            m_FontSizeState = FontSizeState::Condensed;
-            break;
-
-        case 0x12: // Cancel condensed printing
-            ctty.StretchFont(1.0);
-            m_FontSizeState = FontSizeState::FontSizeNormal;
-            break;
-
-        case '\r': // Carriage Return
-            ctty.CarriageReturn();
-            break;
-
-        case '\n': // Line Feed
-            if (m_FontSizeState == FontSizeState::SingleLineExpanded)
-            {
-                ctty.StretchFont(1.0);
-                m_FontSizeState = FontSizeState::FontSizeNormal;
-            }
-            ctty.LineFeed();
-            break;
+    case InputState::InputNormal:
+        // With ESC 7, 0x80 to 0x9f work like the control codes 0x00 to 0x1f.
+        if (m_UpperControl && c >= 0x80 && c < 0xa0)
+            c &= 0x7f;
+        handleControl(ctty, c);
+        break;
 
-        case 0x0c: // Form Feed
-            ctty.NewPage();
-            break;
+    case InputState::Command:
+        BeginCommand(ctty, c);
+        break;
 
-        case 0x1b: // Escape
-            m_InputState = InputState::Escape;
-            m_EscapeState = EscapeState::Entered;
-            break;
+    case InputState::Params:
+        m_Params[m_ParamCount++] = c;
+        if (m_ParamCount == m_ParamsNeeded)
+            ParamsDone(ctty);
+        break;
 
-        default:
-            ctty.append((char) c);
-            break;
+    case InputState::Data:
+        if (--m_DataLeft == 0)
+            DataDone();
+        break;
+
+    case InputState::UntilNul:
+        if (c == 0)
+            m_InputState = InputState::InputNormal;
+        break;
+
+    case InputState::RleCount:
+        {
+            // A count below 128 is followed by count + 1 literal bytes,
+            // otherwise by one byte repeated 257 - count times.
+            uint32_t decoded = c < 128 ? c + 1 : 257 - c;
+            m_Remaining -= std::min(decoded, m_Remaining);
+            SkipData(c < 128 ? decoded : 1);
         }
+        break;
     }
 }
 
-void EpsonPreprocessor::handleEscape(ICairoTTYProtected &ctty, uint8_t c)
+template <class TTY>
+void EpsonPreprocessor::handleControl(TTY &ctty, uint8_t c)
 {
-    // Determine what escape code follows
-    if (m_EscapeState == EscapeState::Entered)
+    // Control codes handled here
+    switch (c)
     {
-        switch (c)
-        {
-        case 0x45: // Set bold
-            ctty.SetFontWeight(FontWeight::Bold);
-            break;
-        case 0x46: // Unset bold
-            ctty.SetFontWeight(FontWeight::Normal);
-            break;
-        case 0x34: // Set italic
-            ctty.SetFontSlant(FontSlant::Italic);
-            break;
-        case 0x35: // Unset italic
-            ctty.SetFontSlant(FontSlant::Normal);
-            break;
-        case 0x2a: // '*': Draw Graphics
-            m_GraphicAssembledBytes = 0;
-            m_EscapeState = EscapeState::DrawGraphics;
-            break;
-        case 0x2d: // Underline
-            m_EscapeState = EscapeState::Underline;
-            break;
-        case 0x33: // '3': Set n/180-inch line spacing
-            m_EscapeState = EscapeState::SetLineSpacing;
-            break;
-        case 0x40: // '@': Initialize
-            // TODO: add init for Cairo here
-            m_InputState = InputState::InputNormal; // Leave escape state
-            break;
-        case 0x44: // 'D': Set horizontal tabs
-            m_EscapeState = EscapeState::SetTabWidth;
-            break;
-        case 0x78: // 'x': Select LQ or draft
-            m_EscapeState = EscapeState::SelectQuality;
-            break;
-
-        default:
-            {
-                int i = c;
-                std::cerr << "EpsonPreprocessor::handleEscape(): ignoring unknown escape ESC 0x"
-                    << std::setfill('0') << std::setw(2) << std::hex << i << std::endl;
-                m_InputState = InputState::InputNormal; // Leave escape state
-            }
-        }
+    case 0x0e: // Expanded printing for one line
+        SetFontSize(ctty, FontSizeState::SingleLineExpanded);
+        break;
 
-        /*
-         * If still in the escape state (no change to special), assume
-         * the operation has completed, and exit the escape state.
-         *
-         * This includes the error condition, as no change is done either.
-         */
-        if (m_EscapeState == EscapeState::Entered)
+    case 0x14: // Cancel one-line expanded printing
+        SetFontSize(ctty, FontSizeState::FontSizeNormal);
+        break;
+
+    case 0x0f: // Condensed printing
+        SetFontSize(ctty, FontSizeState::Condensed);
+        break;
+
+    case 0x12: // Cancel condensed printing
+        SetFontSize(ctty, FontSizeState::FontSizeNormal);
+        break;
+
+    case '\r': // Carriage Return
+        ctty.CarriageReturn();
+        break;
+
+    case '\n': // Line Feed
+        if (m_FontSizeState == FontSizeState::SingleLineExpanded)
+            SetFontSize(ctty, FontSizeState::FontSizeNormal);
+        ctty.LineFeed();
+        break;
+
+    case 0x0c: // Form Feed
+        ctty.NewPage();
+        break;
+
+    case 0x1b: // Escape
+        m_InputState = InputState::Command;
+        break;
+
+    default:
+        if (!m_Table)
+            ctty.append((char) c);
+        else
         {
-            m_InputState = InputState::InputNormal;
+            gunichar uc;
+            if (m_Table->Get(c, uc))
+                ctty.append(uc);
+            else
+                Unknown(c);
         }
+        break;
+    }
+}
+
+template <class TTY>
+void EpsonPreprocessor::BeginCommand(TTY &ctty, uint8_t c)
+{
+    const EscpCommand &cmd = ESCP_COMMANDS[c];
 
-        // Allow font to update if it has changed.
-        ctty.UseCurrentFont();
+    m_Command = c;
+    m_Phase = 0;
 
-        return;
+    if (cmd.m_Rule == EscpRule::Unknown)
+    {
+        int i = c;
+        std::cerr << "EpsonPreprocessor::BeginCommand(): ignoring unknown escape ESC 0x"
+            << std::setfill('0') << std::setw(2) << std::hex << i << std::dec << std::endl;
+        m_InputState = InputState::InputNormal;
     }
+    else if (cmd.m_Params > 0)
+        ExpectParams(cmd.m_Params);
+    else
+        ParamsDone(ctty);
+}
 
-    // For multi-byte escapes:
-    switch (m_EscapeState)
+template <class TTY>
+void EpsonPreprocessor::ParamsDone(TTY &ctty)
+{
+    const EscpCommand &cmd = ESCP_COMMANDS[m_Command];
+    const uint8_t *p = m_Params;
+
+    m_InputState = InputState::InputNormal;
+
+    switch (cmd.m_Rule)
     {
-    case EscapeState::Underline: // ESC 0x2d u, turn underline off (0) or on (!0)
-        //std::cerr << "escape: ESC 0x2d " << std::hex << c << std::endl;
-        if (c != 0)
+    case EscpRule::Unknown:
+    case EscpRule::Fixed:
+        Apply(ctty, cmd.m_Action);
+        break;
+
+    case EscpRule::PageLength: // ESC C n, or ESC C NUL n in inches
+        if (m_Phase++ == 0 && p[0] == 0)
+            ExpectParams(1);
+        break;
+
+    case EscpRule::Columns:
+        SkipData(p[0] | p[1] << 8);
+        break;
+
+    case EscpRule::BitImage:
         {
-            // TODO: Set underline
-            //std::cerr << "EpsonPreprocessor::handleEscape(): Ignoring unsupported escape: SET UNDERLINE" << std::endl;
+            // Modes below 32 are 8 dot (9 pin), below 64 24 dot, above 48 dot.
+            uint32_t bytesPerColumn = p[0] < 32 ? 1 : p[0] < 64 ? 3 : 6;
+            SkipData((p[1] | p[2] << 8) * bytesPerColumn);
         }
-        else
+        break;
+
+    case EscpRule::BitImage9:
+        SkipData((p[1] | p[2] << 8) * 2);
+        break;
+
+    case EscpRule::Raster: // ESC . c v h m nL nH
         {
-            // TODO: Cancel underline
-            //std::cerr << "EpsonPreprocessor::handleEscape(): Ignoring unsupported escape: DROP UNDERLINE" << std::endl;
+            uint32_t bytes = p[3] * (((p[4] | p[5] << 8) + 7) / 8);
+            if (p[0] == 0)
+                SkipData(bytes);
+            else if (p[0] == 1)
+            {
+                m_Remaining = bytes;
+                DataDone();
+            }
+            else
+            {
+                int i = p[0];
+                std::cerr << "EpsonPreprocessor::ParamsDone(): unsupported raster compression " << i << std::endl;
+            }
         }
-        m_InputState = InputState::InputNormal; // Leave escape state
         break;
 
-    case EscapeState::SetLineSpacing:
-        // TODO: implement line spacing in CairoTTY
-        m_InputState = InputState::InputNormal;
+    case EscpRule::Extended:
+        SkipData(p[1] | p[2] << 8);
         break;
 
-    case EscapeState::SetTabWidth: // Set width of tabs
-        if (0 == c)
+    case EscpRule::NulTerminated:
+        m_InputState = InputState::UntilNul;
+        break;
+
+    case EscpRule::UserChars:
+        if (m_Phase++ == 0)
         {
-            m_InputState = InputState::InputNormal; // Leave escape state
+            // ESC & 0 n m
+            m_Remaining = p[2] >= p[1] ? p[2] - p[1] + 1 : 0;
+            if (m_Remaining > 0)
+                ExpectParams(3);
         }
         else
         {
-            // TODO: set tab width for CairoTTY or handle tabs here
+            // a0 a1 a2: left space, width in columns of 3 bytes, right space
+            SkipData(p[1] * 3);
         }
         break;
+    }
+}
 
-    case EscapeState::SelectQuality:
-        // TODO: select quality?
-        m_InputState = InputState::InputNormal;
+void EpsonPreprocessor::DataDone()
+{
+    m_InputState = InputState::InputNormal;
+
+    switch (ESCP_COMMANDS[m_Command].m_Rule)
+    {
+    case EscpRule::Raster:
+        if (m_Remaining > 0)
+            m_InputState = InputState::RleCount;
         break;
 
-    case EscapeState::DrawGraphics: // Insert tabs in text
-        handleGraphics(ctty, c);
+    case EscpRule::UserChars:
+        if (--m_Remaining > 0)
+            ExpectParams(3);
         break;
 
     default:
-        throw std::runtime_error("EpsonPreprocessor::handleEscape(): Internal error: entered unknown escape state "
-            + std::to_string(static_cast<int>(m_EscapeState)));
+        break;
     }
 }
 
-void EpsonPreprocessor::handleGraphics(ICairoTTYProtected &ctty, uint8_t c)
+void EpsonPreprocessor::ExpectParams(unsigned count)
 {
-    static int col;
+    m_InputState = InputState::Params;
+    m_ParamCount = 0;
+    m_ParamsNeeded = count;
+}
 
-    if (0 == m_GraphicAssembledBytes)
-    {
-        m_GraphicsMode = c;
-        m_GraphicAssembledBytes = 1;
-    }
-    else if (m_GraphicAssembledBytes == 1)
-    {
-        m_GraphicsNrColumns = (unsigned char) c;
-        m_GraphicAssembledBytes = 2;
-    }
-    else if (m_GraphicAssembledBytes == 2)
+void EpsonPreprocessor::SkipData(uint32_t count)
+{
+    if (count == 0)
+        DataDone();
+    else
     {
-        int nh = (unsigned char) c;
-        m_GraphicsNrColumns += nh * 256;
-        m_GraphicAssembledBytes = 3;
+        m_InputState = InputState::Data;
+        m_DataLeft = count;
     }
-    else
+}
+
+template <class TTY>
+void EpsonPreprocessor::Apply(TTY &ctty, EscpAction action)
+{
+    switch (action)
     {
-        if (m_GraphicAssembledBytes == 3)
+    case EscpAction::None:
+        return;
+    case EscpAction::Expanded:
+        SetFontSize(ctty, FontSizeState::SingleLineExpanded);
+        break;
+    case EscpAction::Condensed:
+        SetFontSize(ctty, FontSizeState::Condensed);
+        break;
+    case EscpAction::MasterSelect:
+        // Only condensed (bit 2), bold (bit 3) and italic (bit 6) can be rendered.
+        SetFontSize(ctty, m_Params[0] & 0x04 ? FontSizeState::Condensed : FontSizeState::FontSizeNormal);
+        ctty.SetFontWeight(m_Params[0] & 0x08 ? FontWeight::Bold : FontWeight::Normal);
+        ctty.SetFontSlant(m_Params[0] & 0x40 ? FontSlant::Italic : FontSlant::Normal);
+        break;
+    case EscpAction::Italic:
+        ctty.SetFontSlant(FontSlant::Italic);
+        break;
+    case EscpAction::ItalicOff:
+        ctty.SetFontSlant(FontSlant::Normal);
+        break;
+    case EscpAction::Initialize:
+        ctty.Initialize();
+        m_FontSizeState = FontSizeState::FontSizeNormal;
+        m_National = 0;
+        m_CharacterTable = 1;
+        m_UpperControl = false;
+        SelectTable();
+        break;
+    case EscpAction::Bold:
+        ctty.SetFontWeight(FontWeight::Bold);
+        break;
+    case EscpAction::BoldOff:
+        ctty.SetFontWeight(FontWeight::Normal);
+        break;
+    case EscpAction::NationalCharset:
+        if (CharacterTableSet::IsNational(m_Params[0]))
         {
-            m_GraphicsMaxBytes = m_GraphicsNrColumns * 3;
+            m_National = m_Params[0];
+            SelectTable();
         }
-
-        int rowGroup = m_GraphicAssembledBytes % 3;
-        col |= ((unsigned int) c) << (8 * (2 - rowGroup));
-        if (2 == rowGroup)
+        return;
+    case EscpAction::CharacterTable:
         {
-            col = 0;
+            // Both 0 to 3 and '0' to '3' are accepted.
+            uint8_t n = m_Params[0] >= '0' ? m_Params[0] - '0' : m_Params[0];
+            if (CharacterTableSet::IsTable(n))
+            {
+                m_CharacterTable = n;
+                SelectTable();
+            }
         }
+        return;
+    case EscpAction::UpperPrintable:
+        m_UpperControl = false;
+        return;
+    case EscpAction::UpperControl:
+        m_UpperControl = true;
+        return;
+    }
 
-        ++m_GraphicAssembledBytes;
-        if (m_GraphicAssembledBytes >= (m_GraphicsMaxBytes + 3))
-        {
-            m_InputState = InputState::InputNormal; // Leave escape state
-        }
+    // Allow font to update if it has changed.
+    ctty.UseCurrentFont();
+}
+
+template <class TTY>
+void EpsonPreprocessor::SetFontSize(TTY &ctty, FontSizeState state)
+{
+    switch (state)
+    {
+    case FontSizeState::FontSizeNormal:
+        ctty.StretchFont(1.0);
+        break;
+    case FontSizeState::SingleLineExpanded:
+        ctty.StretchFont(2.0);
+        break;
+    case FontSizeState::Condensed:
+        ctty.StretchFont(10.0/17.0); // Change from 10 CPI to 17 CPI
+        break;
     }
+
+    m_FontSizeState = state;
 }
+
+template void EpsonPreprocessor::Process(StaticTTY<AsciiCodepageTranslator> &, uint8_t);
+template void EpsonPreprocessor::Process(StaticTTY<CodepageTranslator> &, uint8_t);
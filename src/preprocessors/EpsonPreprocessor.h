@@ -20,33 +20,43 @@
 #ifndef EPSON_PREPROCESSOR_H_
 #define EPSON_PREPROCESSOR_H_
 
+#include <memory>
+
 #include "../CairoTTY.h"
+#include "CharacterTableSet.h"
+#include "EscpCommands.h"
 
-class EpsonPreprocessor: public ICharPreprocessor
+/**
+ * \brief Interprets ESC/P and ESC/P2 printer commands.
+ *
+ * The commands are described in EscpCommands.def. Every command's
+ * parameters and data are consumed according to its rule, so commands
+ * that are not rendered (graphics, tabs, margins, ...) never leak into
+ * the text. Each byte takes a constant amount of work.
+ */
+class EpsonPreprocessor final: public ICharPreprocessor
 {
 public:
     EpsonPreprocessor();
     virtual void process(ICairoTTYProtected &ctty, uint8_t c) override;
+    virtual void SaveState(std::ostream &out) const override;
+    virtual void LoadState(std::istream &in) override;
+    virtual void SetTranslator(const ICodepageTranslator *translator) override;
+    virtual void GetExtraChars(std::vector<gunichar> &chars) const override;
 
-private:
-    void handleEscape(ICairoTTYProtected &ctty, uint8_t c);
-    void handleGraphics(ICairoTTYProtected &ctty, uint8_t c);
+    /** \brief process() for a TTY type known at compile time, instantiated for the StaticTTY types. */
+    template <class TTY>
+    void Process(TTY &ctty, uint8_t c);
 
+private:
     enum class InputState
     {
         InputNormal,
-        Escape
-    };
-
-    enum class EscapeState
-    {
-        Entered,
-        Underline,
-        SetLineSpacing,
-        SetTabWidth,
-        SelectQuality,
-        DrawGraphics,
-        Unknown
+        Command,    // ESC seen
+        Params,     // reading m_ParamsNeeded parameter bytes
+        Data,       // skipping m_DataLeft bytes
+        UntilNul,   // skipping up to a NUL
+        RleCount    // expecting the count byte of a run length encoded raster
     };
 
     enum class FontSizeState
@@ -56,16 +66,71 @@ private:
         Condensed
     };
 
+    template <class TTY>
+    void handleControl(TTY &ctty, uint8_t c);
+
+    /** \brief c is the byte following ESC. */
+    template <class TTY>
+    void BeginCommand(TTY &ctty, uint8_t c);
+
+    /** \brief Called when the parameters of the current command have been read. */
+    template <class TTY>
+    void ParamsDone(TTY &ctty);
+
+    /** \brief Called when the data announced by the parameters has been skipped. */
+    void DataDone();
+
+    template <class TTY>
+    void Apply(TTY &ctty, EscpAction action);
+
+    void ExpectParams(unsigned count);
+    void SkipData(uint32_t count);
+
+    /** \brief Points m_Table at the table for m_National and m_CharacterTable. */
+    void SelectTable();
+
+    /** \brief Reports a byte m_Table has no character for, like the translators do. */
+    static void Unknown(uint8_t c);
+
+    /** \brief Expanded, condensed or neither, as set by SO/SI/DC2/DC4 and ESC !. */
+    template <class TTY>
+    void SetFontSize(TTY &ctty, FontSizeState state);
+
+    /** \brief Number of int32_t written by SaveState(). */
+    static const unsigned STATE_SIZE = 11 + EscpCommandTable::MAX_PARAMS;
+
     InputState m_InputState;
-    EscapeState m_EscapeState;
     FontSizeState m_FontSizeState;
-    bool m_Escape;
-    int m_GraphicAssembledBytes;
-    uint8_t m_GraphicsMode; // Graphics mode
-    int m_GraphicsDpi; // Dots per inch
-    int m_GraphicsDpc; // Dots per column
-    int m_GraphicsNrColumns; // Number of columns
-    int m_GraphicsMaxBytes; // Number of columns
+
+    /** \brief The byte following ESC of the command being read. */
+    uint8_t m_Command;
+
+    uint8_t m_Params[EscpCommandTable::MAX_PARAMS];
+    unsigned m_ParamCount;
+    unsigned m_ParamsNeeded;
+
+    /** \brief Step of a command with more than one parameter block (ESC C, ESC &). */
+    unsigned m_Phase;
+
+    uint32_t m_DataLeft;
+
+    /** \brief Characters left to define (ESC &) or raster bytes left to decode (ESC .). */
+    uint32_t m_Remaining;
+
+    /** \brief International character set (ESC R) and character table (ESC t). */
+    uint8_t m_National;
+    uint8_t m_CharacterTable;
+
+    /** \brief Whether 0x80 to 0x9f are control codes (ESC 7) or printable (ESC 6). */
+    bool m_UpperControl;
+
+    const ICodepageTranslator *m_Translator;
+
+    /** \brief Created on the first switch away from the default tables. */
+    std::unique_ptr<CharacterTableSet> m_CharacterTables;
+
+    /** \brief Translates printable bytes, nullptr while the TTY's translator does. */
+    const TranslationTable *m_Table;
 };
 
 #endif // EPSON_PREPROCESSOR_H_
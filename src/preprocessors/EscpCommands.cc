@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+
+#include "EscpCommands.h"
+
+namespace
+{
+    EscpCommandTable Build()
+    {
+        EscpCommandTable t;
+
+        for (EscpCommand &cmd : t.m_Commands)
+            cmd = EscpCommand{ EscpRule::Unknown, 0, EscpAction::None };
+
+#define ESCP_COMMAND(code, params, rule, action) \
+        static_assert(params <= EscpCommandTable::MAX_PARAMS, "too many parameters"); \
+        assert(t.m_Commands[(uint8_t) code].m_Rule == EscpRule::Unknown); \
+        t.m_Commands[(uint8_t) code] = EscpCommand{ EscpRule::rule, params, EscpAction::action };
+#include "EscpCommands.def"
+#undef ESCP_COMMAND
+
+        return t;
+    }
+}
+
+const EscpCommandTable ESCP_COMMANDS = Build();
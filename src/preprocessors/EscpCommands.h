@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ESCP_COMMANDS_H_
+#define ESCP_COMMANDS_H_
+
+#include <cstdint>
+
+/** \brief What follows the parameter bytes of an ESC/P command. */
+enum class EscpRule: uint8_t
+{
+    Unknown,       // not in EscpCommands.def, no parameters assumed
+    Fixed,         // nothing, the command is complete
+    PageLength,    // ESC C: a second byte if the first one is NUL
+    Columns,       // ESC K/L/Y/Z nL nH: nL + 256 * nH data bytes
+    BitImage,      // ESC * m nL nH: columns of 1, 3 or 6 bytes depending on m
+    BitImage9,     // ESC ^ m nL nH: columns of 2 bytes
+    Raster,        // ESC . c v h m nL nH: m rows of nL + 256 * nH dots, c selects the compression
+    Extended,      // ESC ( c nL nH: nL + 256 * nH data bytes
+    NulTerminated, // bytes up to and including a NUL
+    UserChars      // ESC & 0 n m: a header of 3 bytes and its data for each character n to m
+};
+
+/** \brief What EpsonPreprocessor does once a Fixed command is complete. */
+enum class EscpAction: uint8_t
+{
+    None,
+    Expanded,
+    Condensed,
+    MasterSelect,
+    Italic,
+    ItalicOff,
+    Initialize,
+    Bold,
+    BoldOff,
+    NationalCharset,
+    CharacterTable,
+    UpperPrintable,
+    UpperControl
+};
+
+struct EscpCommand
+{
+    EscpRule m_Rule;
+
+    /** \brief Parameter bytes read before the rule is applied. */
+    uint8_t m_Params;
+
+    EscpAction m_Action;
+};
+
+/**
+ * \brief The commands of EscpCommands.def, indexed by the byte following ESC.
+ *
+ * Built once during static initialization, a lookup is a plain array access.
+ */
+struct EscpCommandTable
+{
+    /** \brief Most parameter bytes of any command. */
+    static const unsigned MAX_PARAMS = 6;
+
+    EscpCommand m_Commands[256];
+
+    const EscpCommand &operator[](uint8_t code) const
+    {
+        return m_Commands[code];
+    }
+};
+
+extern const EscpCommandTable ESCP_COMMANDS;
+
+#endif // ESCP_COMMANDS_H_
@@ -21,8 +21,15 @@
 #include <iomanip>
 #include <glibmm.h>
 #include "SimplePreprocessor.h"
+#include "../StaticPipeline.h"
 
 void SimplePreprocessor::process(ICairoTTYProtected &ctty, uint8_t c)
+{
+    Process(ctty, c);
+}
+
+template <class TTY>
+void SimplePreprocessor::Process(TTY &ctty, uint8_t c)
 {
     if (iscntrl(c))
     {
@@ -48,3 +55,6 @@ void SimplePreprocessor::process(ICairoTTYProtected &ctty, uint8_t c)
     else
         ctty.append((char) c);
 }
+
+template void SimplePreprocessor::Process(StaticTTY<AsciiCodepageTranslator> &, uint8_t);
+template void SimplePreprocessor::Process(StaticTTY<CodepageTranslator> &, uint8_t);
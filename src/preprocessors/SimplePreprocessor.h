@@ -22,10 +22,14 @@
 
 #include "../CairoTTY.h"
 
-class SimplePreprocessor: public ICharPreprocessor
+class SimplePreprocessor final: public ICharPreprocessor
 {
 public:
     virtual void process(ICairoTTYProtected &ctty, uint8_t c) override;
+
+    /** \brief process() for a TTY type known at compile time, instantiated for the StaticTTY types. */
+    template <class TTY>
+    void Process(TTY &ctty, uint8_t c);
 };
 
 #endif // SIMPLE_PREPROCESSOR_H_
@@ -0,0 +1,864 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dotprint_bench: measures the conversion pipeline as a whole and stage by
+ * stage, over the sample spools in tests/ and over synthetic spools.
+ *
+ * Every measurement is preceded by warm-up runs and repeated; the median
+ * and the 95th percentile of the repetitions are reported.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <assert.h>
+#include <dirent.h>
+#include <getopt.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "../AsciiCodepageTranslator.h"
+#include "../CodepageTranslator.h"
+#include "../Converter.h"
+#include "../PreprocessorFactory.h"
+#include "SpoolGenerator.h"
+
+namespace
+{
+    const char *SHORT_OPTIONS = "c:T:g:w:r:S:P:F:o:b:x:u:h";
+
+    const struct option LONG_OPTIONS[] =
+    {
+        {"corpus",      required_argument,  0,  'c'},
+        {"tables",      required_argument,  0,  'T'},
+        {"synthetic",   required_argument,  0,  'g'},
+        {"warmup",      required_argument,  0,  'w'},
+        {"repeat",      required_argument,  0,  'r'},
+        {"stages",      required_argument,  0,  'S'},
+        {"preprocessor",required_argument,  0,  'P'},
+        {"font-file",   required_argument,  0,  'F'},
+        {"csv",         required_argument,  0,  'o'},
+        {"baseline",    required_argument,  0,  'b'},
+        {"tolerance",   required_argument,  0,  'x'},
+        {"startup-budget", required_argument, 0, 'u'},
+        {"help",        no_argument,        0,  'h'},
+        { 0, 0, 0, 0 }
+    };
+
+    const char *ALL_STAGES[] = { "translate", "translate-span", "preprocess", "layout", "render", "full", "startup" };
+
+    /** \brief Translation table of each codepage the sample files are named with. */
+    const std::map<std::string, std::string> TABLES =
+    {
+        { "CP850", "cp850.trans" },
+        { "CP852", "cp852.trans" },
+        { "CP895", "cp895.trans" },
+        { "KEYBCS2", "cp895.trans" } // Kamenicky is CP895
+    };
+
+    /** \brief One input the stages are run on. */
+    struct Workload
+    {
+        std::string m_Name;
+        std::string m_Path;
+        std::string m_Data;
+        ConversionSettings m_Settings;
+
+        /** \brief Path of the translation table, empty for ASCII. */
+        std::string m_Table;
+    };
+
+    /** \brief Outcome of one stage on one workload. */
+    struct Result
+    {
+        std::string m_Workload;
+        std::string m_Stage;
+        double m_Median;
+        double m_P95;
+        uint64_t m_Bytes;
+        unsigned m_Pages;
+        long m_PeakRssKb;
+        uint64_t m_OutputBytes;
+    };
+
+    /** \brief What a single run of a stage produced. */
+    struct RunOutput
+    {
+        RunOutput(unsigned pages = 0, uint64_t outputBytes = 0):
+            m_Pages(pages),
+            m_OutputBytes(outputBytes),
+            m_Seconds(-1.0),
+            m_PeakRssKb(-1)
+        {}
+
+        unsigned m_Pages;
+        uint64_t m_OutputBytes;
+
+        /** \brief Time to report instead of the duration of the run, if not negative. */
+        double m_Seconds;
+
+        /** \brief Peak RSS of a process of its own the run started, -1 if it ran in this one. */
+        long m_PeakRssKb;
+    };
+
+    /** \brief Discards what is written to std::cerr while it exists, such as the warnings of unknown bytes. */
+    class SilentCerr
+    {
+    public:
+        SilentCerr():
+            m_Buffer(std::cerr.rdbuf(nullptr))
+        {}
+
+        ~SilentCerr()
+        {
+            std::cerr.rdbuf(m_Buffer);
+            std::cerr.clear();
+        }
+
+    private:
+        std::streambuf *m_Buffer;
+    };
+
+    /** \brief Terminal that only counts pages, to time a preprocessor on its own. */
+    class NullTTY: public ICairoTTYProtected
+    {
+    public:
+        NullTTY():
+            m_Pages(1)
+        {}
+
+        virtual void SetPageSize(const PageSize &) override {}
+        virtual void Home() override {}
+        virtual void NewLine() override {}
+        virtual void CarriageReturn() override {}
+        virtual void LineFeed() override {}
+        virtual void NewPage() override { ++m_Pages; }
+        virtual void Initialize() override {}
+        virtual void SetFontName(const std::string) override {}
+        virtual void SetFontSize(const double) override {}
+        virtual void SetFontWeight(const FontWeight) override {}
+        virtual void SetFontSlant(const FontSlant) override {}
+        virtual void StretchFont(double, double) override {}
+        virtual void UseCurrentFont() override {}
+        virtual void append(char) override {}
+        virtual void append(gunichar) override {}
+
+        unsigned m_Pages;
+    };
+
+    /** \brief CairoTTY that lays out text (metrics, wrapping, paging) but draws nothing. */
+    class LayoutTTY: public CairoTTY
+    {
+    public:
+        using CairoTTY::CairoTTY;
+
+    protected:
+        virtual void DrawGlyph(const Glib::ustring &, double, double) override {}
+    };
+
+    Cairo::ErrorStatus Discard(const unsigned char *, unsigned int)
+    {
+        return CAIRO_STATUS_SUCCESS;
+    }
+
+    /** \brief Value of a kB field of /proc/self/status, e.g. VmRSS or VmHWM. */
+    long StatusKb(const std::string &field)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+
+        while (std::getline(status, line))
+            if (line.compare(0, field.size() + 1, field + ":") == 0)
+                return atol(line.c_str() + field.size() + 1);
+
+        return 0;
+    }
+
+    /** \brief Resets the RSS high-water mark to the current RSS, false if the kernel cannot (before Linux 4.0). */
+    bool ResetPeakRss()
+    {
+        std::ofstream clear("/proc/self/clear_refs");
+        clear << "5" << std::flush;
+        return clear.good();
+    }
+
+    uint64_t ParseSize(const std::string &arg)
+    {
+        char *end;
+        uint64_t value = strtoull(arg.c_str(), &end, 10);
+
+        switch (*end)
+        {
+        case 'G': case 'g':
+            value <<= 10;
+            // fall through
+        case 'M': case 'm':
+            value <<= 10;
+            // fall through
+        case 'K': case 'k':
+            value <<= 10;
+            break;
+        case '\0':
+            break;
+        default:
+            throw std::invalid_argument("wrong size: " + arg);
+        }
+
+        return value;
+    }
+
+    std::vector<std::string> Split(const std::string &s, char sep)
+    {
+        std::vector<std::string> out;
+        std::stringstream ss(s);
+        std::string item;
+
+        while (std::getline(ss, item, sep))
+            if (!item.empty())
+                out.push_back(item);
+
+        return out;
+    }
+
+    /** \brief Value at fraction q of the sorted samples, nearest rank. */
+    double Percentile(std::vector<double> samples, double q)
+    {
+        assert(!samples.empty());
+        std::sort(samples.begin(), samples.end());
+
+        size_t rank = (size_t) (q * samples.size() + 0.999999);
+        rank = std::max<size_t>(rank, 1);
+        return samples[std::min(rank, samples.size()) - 1];
+    }
+
+    class Bench
+    {
+    public:
+        Bench():
+            m_Warmup(1),
+            m_Repeat(5),
+            m_Tolerance(10.0),
+            m_StartupBudget(0.0)
+        {}
+
+        int Main(int argc, char *argv[]);
+
+    private:
+        void PrintHelp(const char *prog);
+
+        void LoadCorpus(const std::string &dir);
+        void AddSynthetic(uint64_t size);
+        ICodepageTranslator *TranslatorFor(const std::string &codepage);
+        std::string TablePathFor(const std::string &codepage) const;
+
+        template <class F>
+        Result Measure(const Workload &w, const std::string &stage, F run);
+
+        RunOutput Translate(const Workload &w);
+        RunOutput TranslateSpan(const Workload &w);
+        RunOutput Preprocess(const Workload &w);
+        RunOutput Layout(const Workload &w);
+        RunOutput Render(const Workload &w);
+        RunOutput Full(const Workload &w);
+        RunOutput Startup(const Workload &w);
+
+        void Print(const Result &r);
+        void WriteCsv(const std::string &file);
+        int CompareBaseline(const std::string &file);
+        int CheckStartupBudget();
+
+        unsigned m_Warmup;
+        unsigned m_Repeat;
+        double m_Tolerance;
+
+        /** \brief Longest acceptable median startup in seconds, 0 for no limit. */
+        double m_StartupBudget;
+        std::string m_TablesDir;
+        std::string m_Preprocessor;
+        std::string m_FontFile;
+        std::string m_TempDir;
+
+        std::vector<Workload> m_Workloads;
+        std::vector<Result> m_Results;
+        std::map<std::string, std::unique_ptr<ICodepageTranslator>> m_Translators;
+    };
+
+    int Bench::Main(int argc, char *argv[])
+    {
+        std::string corpus = DOTPRINT_TESTS_DIR;
+        std::vector<uint64_t> synthetic;
+        std::vector<std::string> stages(std::begin(ALL_STAGES), std::end(ALL_STAGES));
+        std::string csv, baseline;
+
+        m_TablesDir = DOTPRINT_TABLES_DIR;
+
+        while (true)
+        {
+            int option_index = 0;
+
+            int c = getopt_long(argc, argv, SHORT_OPTIONS, LONG_OPTIONS, &option_index);
+            if (c == -1)
+                break; // end of options
+
+            switch (c)
+            {
+            case 'c':
+                corpus = optarg;
+                break;
+            case 'T':
+                m_TablesDir = optarg;
+                break;
+            case 'g':
+                for (const auto &s : Split(optarg, ','))
+                    synthetic.push_back(ParseSize(s));
+                break;
+            case 'w':
+                m_Warmup = atoi(optarg);
+                break;
+            case 'r':
+                m_Repeat = std::max(1, atoi(optarg));
+                break;
+            case 'S':
+                stages = Split(optarg, ',');
+                break;
+            case 'P':
+                if (!PreprocessorFactory::Lookup(optarg))
+                {
+                    std::cerr << argv[0] << ": unknown preprocessor " << optarg << std::endl;
+                    return 1;
+                }
+                m_Preprocessor = optarg;
+                break;
+            case 'F':
+                m_FontFile = optarg;
+                break;
+            case 'o':
+                csv = optarg;
+                break;
+            case 'b':
+                baseline = optarg;
+                break;
+            case 'x':
+                m_Tolerance = atof(optarg);
+                break;
+            case 'u':
+                m_StartupBudget = atof(optarg) / 1e3;
+                break;
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            default:
+                return 1;
+            }
+        }
+
+        char tmpl[] = "/tmp/dotprint_bench.XXXXXX";
+        if (!mkdtemp(tmpl))
+        {
+            std::cerr << argv[0] << ": unable to create a temporary directory" << std::endl;
+            return 1;
+        }
+        m_TempDir = tmpl;
+
+        if (!corpus.empty())
+            LoadCorpus(corpus);
+        for (uint64_t size : synthetic)
+            AddSynthetic(size);
+
+        std::cout << std::left << std::setw(32) << "workload" << std::setw(16) << "stage"
+            << std::right << std::setw(11) << "median ms" << std::setw(11) << "p95 ms"
+            << std::setw(11) << "MB/s" << std::setw(11) << "pages/s"
+            << std::setw(13) << "peak RSS +kB" << std::setw(12) << "output B" << std::endl;
+
+        for (const Workload &w : m_Workloads)
+        {
+            for (const std::string &stage : stages)
+            {
+                Result r;
+                if (stage == "translate")
+                    r = Measure(w, stage, [this](const Workload &x) { return Translate(x); });
+                else if (stage == "translate-span")
+                    r = Measure(w, stage, [this](const Workload &x) { return TranslateSpan(x); });
+                else if (stage == "preprocess")
+                    r = Measure(w, stage, [this](const Workload &x) { return Preprocess(x); });
+                else if (stage == "layout")
+                    r = Measure(w, stage, [this](const Workload &x) { return Layout(x); });
+                else if (stage == "render")
+                    r = Measure(w, stage, [this](const Workload &x) { return Render(x); });
+                else if (stage == "full")
+                    r = Measure(w, stage, [this](const Workload &x) { return Full(x); });
+                else if (stage == "startup")
+                    r = Measure(w, stage, [this](const Workload &x) { return Startup(x); });
+                else
+                {
+                    std::cerr << argv[0] << ": unknown stage " << stage << std::endl;
+                    return 1;
+                }
+
+                Print(r);
+                m_Results.push_back(r);
+            }
+        }
+
+        for (const Workload &w : m_Workloads)
+            if (w.m_Path.compare(0, m_TempDir.size(), m_TempDir) == 0)
+                unlink(w.m_Path.c_str());
+        rmdir(m_TempDir.c_str());
+
+        if (!csv.empty())
+            WriteCsv(csv);
+
+        int ret = baseline.empty() ? 0 : CompareBaseline(baseline);
+        return std::max(ret, CheckStartupBudget());
+    }
+
+    void Bench::PrintHelp(const char *prog)
+    {
+        std::cout << "Usage: " << prog << " [OPTION]..." << std::endl;
+        std::cout << "Measure dotprint conversion throughput." << std::endl << std::endl;
+
+        std::cout << "  -c, --corpus        Directory with *.prn sample spools (\"\" for none)." << std::endl;
+        std::cout << "                      Default value: " << DOTPRINT_TESTS_DIR << std::endl;
+        std::cout << "  -T, --tables        Directory with the .trans translation tables." << std::endl;
+        std::cout << "  -g, --synthetic     Comma separated sizes of synthetic spools, e.g. 1M,64M." << std::endl;
+        std::cout << "  -w, --warmup        Warm-up runs before measuring. Default value: 1" << std::endl;
+        std::cout << "  -r, --repeat        Measured runs. Default value: 5" << std::endl;
+        std::cout << "  -S, --stages        Comma separated stages to run." << std::endl;
+        std::cout << "                      Default value: translate,translate-span,preprocess,layout," << std::endl;
+        std::cout << "                      render,full,startup" << std::endl;
+        std::cout << "  -P, --preprocessor  Preprocessor for the corpus. Default value: epson" << std::endl;
+        std::cout << "  -F, --font-file     Load the font from this file instead of by name." << std::endl;
+        std::cout << "  -o, --csv           Also write the results to a CSV file." << std::endl;
+        std::cout << "  -b, --baseline      Compare medians against an earlier CSV file" << std::endl;
+        std::cout << "                      and fail if any stage got slower than --tolerance." << std::endl;
+        std::cout << "  -x, --tolerance     Allowed slowdown in percent. Default value: 10" << std::endl;
+        std::cout << "  -u, --startup-budget" << std::endl;
+        std::cout << "                      Fail if the median startup of any workload exceeds this" << std::endl;
+        std::cout << "                      many milliseconds." << std::endl;
+        std::cout << "  -h, --help          Display this help." << std::endl << std::endl;
+
+        std::cout << "Stages: translate (codepage translator only, a byte at a time as the conversion" << std::endl;
+        std::cout << "calls it), translate-span (the same a block at a time, which the conversion" << std::endl;
+        std::cout << "does not use), preprocess (preprocessor without a terminal), layout" << std::endl;
+        std::cout << "(CairoTTY metrics and paging, no drawing), render (whole pipeline into an" << std::endl;
+        std::cout << "in-memory PDF), full (file to PDF file)," << std::endl;
+        std::cout << "startup (time from starting the dotprint executable until it has drawn" << std::endl;
+        std::cout << "the first block of input)." << std::endl;
+        std::cout << "Peak RSS is how far the stage raised the RSS of the benchmark above its level" << std::endl;
+        std::cout << "before the stage (-1 if the kernel cannot reset the high-water mark), for" << std::endl;
+        std::cout << "startup the peak RSS of the dotprint process." << std::endl;
+    }
+
+    void Bench::LoadCorpus(const std::string &dir)
+    {
+        DIR *d = opendir(dir.c_str());
+        if (!d)
+            throw std::runtime_error("Unable to open corpus directory \"" + dir + "\"");
+
+        std::vector<std::string> names;
+        while (struct dirent *e = readdir(d))
+        {
+            std::string name = e->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".prn") == 0)
+                names.push_back(name);
+        }
+        closedir(d);
+        std::sort(names.begin(), names.end());
+
+        for (const std::string &name : names)
+        {
+            Workload w;
+            w.m_Name = name;
+            w.m_Path = dir + "/" + name;
+
+            std::ifstream f(w.m_Path, std::ifstream::binary);
+            std::stringstream ss;
+            ss << f.rdbuf();
+            w.m_Data = ss.str();
+
+            // Sample files are named NAME.CODEPAGE.prn
+            std::vector<std::string> parts = Split(name, '.');
+            w.m_Settings.m_Preprocessor = m_Preprocessor.empty() ? "epson" : m_Preprocessor;
+            w.m_Settings.m_Translator = parts.size() >= 3 ? TranslatorFor(parts[parts.size() - 2]) : nullptr;
+            w.m_Settings.m_FontFiles.m_Regular = m_FontFile;
+            w.m_Table = parts.size() >= 3 ? TablePathFor(parts[parts.size() - 2]) : std::string();
+
+            m_Workloads.push_back(w);
+        }
+    }
+
+    void Bench::AddSynthetic(uint64_t size)
+    {
+        Workload w;
+        w.m_Name = "synthetic-" + std::to_string(size);
+        w.m_Path = m_TempDir + "/" + w.m_Name + ".prn";
+        w.m_Data = SpoolGenerator().Generate(size);
+        w.m_Settings.m_Preprocessor = "epson";
+        w.m_Settings.m_Translator = TranslatorFor("CP850");
+        w.m_Settings.m_FontFiles.m_Regular = m_FontFile;
+        w.m_Table = TablePathFor("CP850");
+
+        std::ofstream f(w.m_Path, std::ofstream::binary);
+        f.write(w.m_Data.data(), w.m_Data.size());
+
+        m_Workloads.push_back(w);
+    }
+
+    ICodepageTranslator *Bench::TranslatorFor(const std::string &codepage)
+    {
+        std::string path = TablePathFor(codepage);
+        if (path.empty())
+            return nullptr; // ASCII
+
+        auto it = m_Translators.find(path);
+        if (it == m_Translators.end())
+        {
+            CodepageTranslator *t = new CodepageTranslator();
+            t->loadTable(path);
+            it = m_Translators.insert(std::make_pair(path, std::unique_ptr<ICodepageTranslator>(t))).first;
+        }
+
+        return it->second.get();
+    }
+
+    std::string Bench::TablePathFor(const std::string &codepage) const
+    {
+        auto table = TABLES.find(codepage);
+        if (table == TABLES.end())
+            return std::string();
+
+        return m_TablesDir + "/" + table->second;
+    }
+
+    template <class F>
+    Result Bench::Measure(const Workload &w, const std::string &stage, F run)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        // All workloads are loaded already, so only the growth over the RSS before the stage says anything.
+        bool reset = ResetPeakRss();
+        long baseline = StatusKb("VmRSS");
+        long childPeak = -1;
+
+        for (unsigned i = 0; i < m_Warmup; ++i)
+            run(w);
+
+        std::vector<double> samples;
+        RunOutput out;
+
+        for (unsigned i = 0; i < m_Repeat; ++i)
+        {
+            Clock::time_point start = Clock::now();
+            out = run(w);
+            samples.push_back(out.m_Seconds >= 0.0 ? out.m_Seconds : std::chrono::duration<double>(Clock::now() - start).count());
+            childPeak = std::max(childPeak, out.m_PeakRssKb);
+        }
+
+        Result r;
+        r.m_Workload = w.m_Name;
+        r.m_Stage = stage;
+        r.m_Median = Percentile(samples, 0.5);
+        r.m_P95 = Percentile(samples, 0.95);
+        r.m_Bytes = w.m_Data.size();
+        r.m_Pages = out.m_Pages;
+        if (childPeak >= 0)
+            r.m_PeakRssKb = childPeak;
+        else
+            r.m_PeakRssKb = reset ? std::max(StatusKb("VmHWM") - baseline, 0L) : -1;
+        r.m_OutputBytes = out.m_OutputBytes;
+
+        return r;
+    }
+
+    RunOutput Bench::Translate(const Workload &w)
+    {
+        AsciiCodepageTranslator ascii;
+        ICodepageTranslator *t = w.m_Settings.m_Translator ? w.m_Settings.m_Translator : &ascii;
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(w.m_Data.data());
+
+        // Byte by byte through the interface, as CairoTTY translates.
+        SilentCerr silent;
+        volatile gunichar sink = 0;
+        for (size_t i = 0; i < w.m_Data.size(); ++i)
+        {
+            gunichar c;
+            if (t->translate(data[i], c))
+                sink = c;
+        }
+        (void) sink;
+
+        return RunOutput();
+    }
+
+    RunOutput Bench::TranslateSpan(const Workload &w)
+    {
+        AsciiCodepageTranslator ascii;
+        ICodepageTranslator *t = w.m_Settings.m_Translator ? w.m_Settings.m_Translator : &ascii;
+
+        const size_t CHUNK = 64 * 1024;
+        std::vector<gunichar> out(CHUNK);
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(w.m_Data.data());
+
+        volatile gunichar sink = 0;
+        for (size_t i = 0; i < w.m_Data.size(); i += CHUNK)
+            if (t->translateSpan(data + i, std::min(CHUNK, w.m_Data.size() - i), out.data(), nullptr) > 0)
+                sink = out[0];
+        (void) sink;
+
+        return RunOutput();
+    }
+
+    RunOutput Bench::Preprocess(const Workload &w)
+    {
+        std::unique_ptr<ICharPreprocessor> preproc(PreprocessorFactory::Create(w.m_Settings.m_Preprocessor));
+        NullTTY tty;
+
+        for (char c : w.m_Data)
+            preproc->process(tty, (uint8_t) c);
+
+        return RunOutput(tty.m_Pages);
+    }
+
+    RunOutput Bench::Layout(const Workload &w)
+    {
+        std::unique_ptr<ICharPreprocessor> preproc(PreprocessorFactory::Create(w.m_Settings.m_Preprocessor));
+        PageSize p = w.m_Settings.GetEffectivePageSize();
+
+        std::shared_ptr<const FontFileSet> fonts;
+        if (w.m_Settings.m_FontFiles.IsSet())
+            fonts = FontFileSet::Load(w.m_Settings.m_FontFiles);
+
+        LayoutTTY ctty(Cairo::PdfSurface::create_for_stream(sigc::ptr_fun(&Discard), p.m_Width, p.m_Height),
+            p, w.m_Settings.m_Margins, preproc.get(), w.m_Settings.m_Translator, fonts);
+        ctty.SetFontName(w.m_Settings.m_FontFace);
+        ctty.SetFontSize(w.m_Settings.m_FontSize);
+        ctty.UseCurrentFont();
+
+        // Same dispatch as Converter: the specialized pipeline if there is one.
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(w.m_Data.data());
+        StaticWriteFunc write = PreprocessorFactory::LookupStatic(w.m_Settings.m_Preprocessor, w.m_Settings.m_Translator);
+        if (write)
+            write(ctty, *preproc, w.m_Settings.m_Translator, data, w.m_Data.size());
+        else
+            ctty.write(data, w.m_Data.size());
+
+        return RunOutput(ctty.GetPageCount());
+    }
+
+    RunOutput Bench::Render(const Workload &w)
+    {
+        MemoryInputSource in(w.m_Data);
+        ConversionStats stats = Converter(w.m_Settings).Convert(in, sigc::ptr_fun(&Discard));
+
+        return RunOutput(stats.m_Pages, stats.m_OutputBytes);
+    }
+
+    RunOutput Bench::Full(const Workload &w)
+    {
+        std::string output = m_TempDir + "/output.pdf";
+        FileInputSource in(w.m_Path);
+        ConversionStats stats = Converter(w.m_Settings).Convert(in, output);
+        unlink(output.c_str());
+
+        return RunOutput(stats.m_Pages, stats.m_OutputBytes);
+    }
+
+    RunOutput Bench::Startup(const Workload &w)
+    {
+        std::string output = m_TempDir + "/startup.pdf";
+        std::vector<std::string> args = { DOTPRINT_EXECUTABLE, "--stats", "-P", w.m_Settings.m_Preprocessor, "-o", output };
+        if (!w.m_Table.empty())
+            args.insert(args.end(), { "-t", w.m_Table });
+        if (w.m_Settings.m_FontFiles.IsSet())
+            args.insert(args.end(), { "--font-file", w.m_Settings.m_FontFiles.m_Regular });
+        args.push_back(w.m_Path);
+
+        std::vector<char *> argv;
+        for (std::string &a : args)
+            argv.push_back(&a[0]);
+        argv.push_back(nullptr);
+
+        int fds[2];
+        if (pipe(fds) != 0)
+            throw std::runtime_error("Unable to create a pipe");
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+        posix_spawn_file_actions_addclose(&actions, fds[0]);
+        posix_spawn_file_actions_addclose(&actions, fds[1]);
+
+        // dotprint measures from the time passed in DOTPRINT_EXEC_TIME and reports on stderr.
+        std::vector<std::string> env;
+        for (char **e = environ; *e; ++e)
+            if (strncmp(*e, "DOTPRINT_EXEC_TIME=", 19) != 0)
+                env.push_back(*e);
+        env.push_back("DOTPRINT_EXEC_TIME=" + std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count()));
+
+        std::vector<char *> envp;
+        for (std::string &e : env)
+            envp.push_back(&e[0]);
+        envp.push_back(nullptr);
+
+        pid_t pid;
+        int err = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), envp.data());
+        posix_spawn_file_actions_destroy(&actions);
+        close(fds[1]);
+
+        if (err != 0)
+        {
+            close(fds[0]);
+            throw std::runtime_error(std::string("Unable to run ") + DOTPRINT_EXECUTABLE + ": " + strerror(err));
+        }
+
+        std::string report;
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buf, sizeof(buf))) > 0)
+            report.append(buf, n);
+        close(fds[0]);
+
+        int status;
+        waitpid(pid, &status, 0);
+        unlink(output.c_str());
+
+        RunOutput out;
+        std::istringstream lines(report);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            if (line.compare(0, 8, "startup:") == 0)
+                out.m_Seconds = atof(line.c_str() + 8);
+            else if (line.compare(0, 6, "pages:") == 0)
+                out.m_Pages = atoi(line.c_str() + 6);
+            else if (line.compare(0, 13, "output bytes:") == 0)
+                out.m_OutputBytes = strtoull(line.c_str() + 13, nullptr, 10);
+            else if (line.compare(0, 9, "peak RSS:") == 0)
+                out.m_PeakRssKb = atol(line.c_str() + 9);
+        }
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || out.m_Seconds < 0.0)
+            throw std::runtime_error("dotprint failed on " + w.m_Path + ":\n" + report);
+
+        return out;
+    }
+
+    void Bench::Print(const Result &r)
+    {
+        std::cout << std::left << std::setw(32) << r.m_Workload << std::setw(16) << r.m_Stage << std::right
+            << std::fixed << std::setprecision(2)
+            << std::setw(11) << r.m_Median * 1e3
+            << std::setw(11) << r.m_P95 * 1e3
+            << std::setw(11) << r.m_Bytes / r.m_Median / 1e6
+            << std::setw(11) << (r.m_Pages ? r.m_Pages / r.m_Median : 0.0)
+            << std::setw(13) << r.m_PeakRssKb
+            << std::setw(12) << r.m_OutputBytes << std::endl;
+    }
+
+    void Bench::WriteCsv(const std::string &file)
+    {
+        std::ofstream f(file);
+
+        f << "workload,stage,median_s,p95_s,bytes_per_s,pages_per_s,peak_rss_kb,output_bytes" << std::endl;
+        f << std::setprecision(9);
+        for (const Result &r : m_Results)
+        {
+            f << r.m_Workload << ',' << r.m_Stage << ',' << r.m_Median << ',' << r.m_P95 << ','
+                << r.m_Bytes / r.m_Median << ',' << (r.m_Pages ? r.m_Pages / r.m_Median : 0.0) << ','
+                << r.m_PeakRssKb << ',' << r.m_OutputBytes << std::endl;
+        }
+    }
+
+    int Bench::CompareBaseline(const std::string &file)
+    {
+        std::ifstream f(file);
+        if (!f.is_open())
+        {
+            std::cerr << "Unable to open baseline \"" << file << "\"" << std::endl;
+            return 1;
+        }
+
+        std::map<std::string, double> medians;
+        std::string line;
+        std::getline(f, line); // header
+        while (std::getline(f, line))
+        {
+            std::vector<std::string> fields = Split(line, ',');
+            if (fields.size() >= 3)
+                medians[fields[0] + "," + fields[1]] = atof(fields[2].c_str());
+        }
+
+        int ret = 0;
+        for (const Result &r : m_Results)
+        {
+            auto it = medians.find(r.m_Workload + "," + r.m_Stage);
+            if (it == medians.end() || it->second <= 0.0)
+                continue;
+
+            double change = (r.m_Median / it->second - 1.0) * 100.0;
+            if (change > m_Tolerance)
+            {
+                std::cout << "REGRESSION " << r.m_Workload << " " << r.m_Stage << ": "
+                    << std::setprecision(1) << change << "% slower than baseline" << std::endl;
+                ret = 2;
+            }
+        }
+
+        return ret;
+    }
+
+    int Bench::CheckStartupBudget()
+    {
+        if (m_StartupBudget <= 0.0)
+            return 0;
+
+        int ret = 0;
+        for (const Result &r : m_Results)
+        {
+            if (r.m_Stage == "startup" && r.m_Median > m_StartupBudget)
+            {
+                std::cout << "OVER BUDGET " << r.m_Workload << " startup: " << std::setprecision(2)
+                    << r.m_Median * 1e3 << " ms, budget " << m_StartupBudget * 1e3 << " ms" << std::endl;
+                ret = 2;
+            }
+        }
+
+        return ret;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Bench bench;
+    return bench.Main(argc, argv);
+}
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dotprint_gen: writes synthetic ESC/P spools for load testing, or with
+ * --soak keeps feeding them to the conversion engine and reports memory
+ * and latency at regular intervals.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "../CodepageTranslator.h"
+#include "../Converter.h"
+#include "../PreprocessorFactory.h"
+#include "SpoolGenerator.h"
+
+namespace
+{
+    enum LongOnlyOption
+    {
+        OPT_CODEPAGE = 256,
+        OPT_HIGH_BYTES,
+        OPT_STYLES,
+        OPT_GRAPHICS,
+        OPT_GRAPHICS_COLUMNS,
+        OPT_DENSITY,
+        OPT_LINES_PER_PAGE,
+        OPT_LINE_WIDTH,
+        OPT_SOAK,
+        OPT_REPORT
+    };
+
+    const char *SHORT_OPTIONS = "o:n:S:P:t:h";
+
+    const struct option LONG_OPTIONS[] =
+    {
+        {"output",          required_argument,  0,  'o'},
+        {"size",            required_argument,  0,  'n'},
+        {"seed",            required_argument,  0,  'S'},
+        {"codepage",        required_argument,  0,  OPT_CODEPAGE},
+        {"high-bytes",      required_argument,  0,  OPT_HIGH_BYTES},
+        {"styles",          required_argument,  0,  OPT_STYLES},
+        {"graphics",        required_argument,  0,  OPT_GRAPHICS},
+        {"graphics-columns",required_argument,  0,  OPT_GRAPHICS_COLUMNS},
+        {"density",         required_argument,  0,  OPT_DENSITY},
+        {"lines-per-page",  required_argument,  0,  OPT_LINES_PER_PAGE},
+        {"line-width",      required_argument,  0,  OPT_LINE_WIDTH},
+        {"soak",            required_argument,  0,  OPT_SOAK},
+        {"report-interval", required_argument,  0,  OPT_REPORT},
+        {"preprocessor",    required_argument,  0,  'P'},
+        {"translator",      required_argument,  0,  't'},
+        {"help",            no_argument,        0,  'h'},
+        { 0, 0, 0, 0 }
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    uint64_t ParseSize(const char *arg)
+    {
+        char *end;
+        uint64_t value = strtoull(arg, &end, 10);
+
+        switch (*end)
+        {
+        case 'G': case 'g':
+            value <<= 10;
+            // fall through
+        case 'M': case 'm':
+            value <<= 10;
+            // fall through
+        case 'K': case 'k':
+            value <<= 10;
+            break;
+        case '\0':
+            break;
+        default:
+            throw std::invalid_argument(std::string("wrong size: ") + arg);
+        }
+
+        return value;
+    }
+
+    /** \brief Parses durations like 90s, 30m or 8h, seconds without a suffix. */
+    double ParseDuration(const char *arg)
+    {
+        char *end;
+        double value = strtod(arg, &end);
+
+        switch (*end)
+        {
+        case 'h':
+            return value * 3600.0;
+        case 'm':
+            return value * 60.0;
+        case 's':
+        case '\0':
+            return value;
+        default:
+            throw std::invalid_argument(std::string("wrong duration: ") + arg);
+        }
+    }
+
+    /** \brief Resident set size right now, in kB. */
+    long CurrentRssKb()
+    {
+        std::ifstream statm("/proc/self/statm");
+        long pages = 0, resident = 0;
+        statm >> pages >> resident;
+
+        return resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+
+    long PeakRssKb()
+    {
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        return ru.ru_maxrss;
+    }
+
+    Cairo::ErrorStatus Discard(const unsigned char *, unsigned int)
+    {
+        return CAIRO_STATUS_SUCCESS;
+    }
+
+    void PrintHelp(const char *prog)
+    {
+        std::cout << "Usage: " << prog << " [OPTION]..." << std::endl;
+        std::cout << "Generate synthetic ESC/P spool files." << std::endl << std::endl;
+
+        std::cout << "  -o, --output            Output file. Default: standard output." << std::endl;
+        std::cout << "  -n, --size              Bytes to generate, K/M/G suffixes allowed. Default value: 1M" << std::endl;
+        std::cout << "  -S, --seed              Random seed, same seed gives the same output. Default value: 1" << std::endl;
+        std::cout << "      --codepage          High bytes from CP850 or CP852. Default value: CP850" << std::endl;
+        std::cout << "      --high-bytes        Probability of a high byte after a word. Default value: 0.1" << std::endl;
+        std::cout << "      --styles            Probability of a bold/italic/condensed/expanded toggle" << std::endl;
+        std::cout << "                          before a word. Default value: 0.05" << std::endl;
+        std::cout << "      --graphics          Probability of an ESC * graphics band after a line. Default value: 0" << std::endl;
+        std::cout << "      --graphics-columns  Columns of a graphics band. Default value: 480" << std::endl;
+        std::cout << "      --density           Fraction of dots set in graphics. Default value: 0.3" << std::endl;
+        std::cout << "      --lines-per-page    Lines before a form feed, 0 for none. Default value: 60" << std::endl;
+        std::cout << "      --line-width        Characters per line. Default value: 80" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Soak test:" << std::endl;
+        std::cout << "      --soak              Convert generated spools of --size bytes (each with the" << std::endl;
+        std::cout << "                          next seed) for the given time, e.g. 90s, 30m, 8h." << std::endl;
+        std::cout << "      --report-interval   Time between reports. Default value: 60s" << std::endl;
+        std::cout << "  -P, --preprocessor      Preprocessor for the soak test. Default value: epson" << std::endl;
+        std::cout << "  -t, --translator        Translation table for the soak test." << std::endl;
+        std::cout << "  -h, --help              Display this help." << std::endl;
+    }
+
+    /**
+     * \brief Converts generated spools until duration runs out.
+     *
+     * Every report line covers the jobs finished since the previous one.
+     * A steadily growing RSS column over hours points at a leak.
+     */
+    int Soak(const ConversionSettings &settings, const SpoolMix &mix, uint64_t seed, uint64_t size,
+        double duration, double interval)
+    {
+        Converter converter(settings);
+        Clock::time_point start = Clock::now();
+        Clock::time_point nextReport = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+
+        std::vector<double> latencies;
+        uint64_t jobs = 0, bytes = 0;
+        long firstRss = 0;
+
+        std::cout << std::setw(10) << "elapsed s" << std::setw(10) << "jobs" << std::setw(11) << "MB/s"
+            << std::setw(11) << "p50 ms" << std::setw(11) << "p95 ms" << std::setw(11) << "max ms"
+            << std::setw(12) << "RSS kB" << std::setw(12) << "peak kB" << std::setw(12) << "growth kB" << std::endl;
+
+        while (true)
+        {
+            // Generated as it is read, so the RSS columns are those of the engine.
+            SpoolGenerator generator(seed++, mix);
+            GeneratedInputSource in(generator, size);
+
+            Clock::time_point jobStart = Clock::now();
+            ConversionStats stats = converter.Convert(in, sigc::ptr_fun(&Discard));
+            Clock::time_point now = Clock::now();
+
+            latencies.push_back(std::chrono::duration<double>(now - jobStart).count());
+            bytes += stats.m_InputBytes;
+            ++jobs;
+
+            bool done = std::chrono::duration<double>(now - start).count() >= duration;
+            if (now < nextReport && !done)
+                continue;
+
+            std::sort(latencies.begin(), latencies.end());
+            double span = interval + std::chrono::duration<double>(now - nextReport).count();
+            long rss = CurrentRssKb();
+            if (firstRss == 0)
+                firstRss = rss;
+
+            std::cout << std::fixed << std::setprecision(1)
+                << std::setw(10) << std::chrono::duration<double>(now - start).count()
+                << std::setw(10) << jobs
+                << std::setw(11) << bytes / span / 1e6
+                << std::setw(11) << latencies[latencies.size() / 2] * 1e3
+                << std::setw(11) << latencies[latencies.size() * 95 / 100] * 1e3
+                << std::setw(11) << latencies.back() * 1e3
+                << std::setw(12) << rss
+                << std::setw(12) << PeakRssKb()
+                << std::setw(12) << rss - firstRss << std::endl;
+
+            if (done)
+                break;
+
+            latencies.clear();
+            jobs = bytes = 0;
+            nextReport = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+        }
+
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    SpoolMix mix;
+    uint64_t size = 1 << 20;
+    uint64_t seed = 1;
+    std::string output;
+    double soak = 0.0, interval = 60.0;
+    ConversionSettings settings;
+    settings.m_Preprocessor = "epson";
+
+    while (true)
+    {
+        int option_index = 0;
+
+        int c = getopt_long(argc, argv, SHORT_OPTIONS, LONG_OPTIONS, &option_index);
+        if (c == -1)
+            break; // end of options
+
+        switch (c)
+        {
+        case 'o':
+            output = optarg;
+            break;
+        case 'n':
+            size = ParseSize(optarg);
+            break;
+        case 'S':
+            seed = strtoull(optarg, nullptr, 10);
+            break;
+        case OPT_CODEPAGE:
+            mix.m_Codepage = optarg;
+            break;
+        case OPT_HIGH_BYTES:
+            mix.m_HighBytes = atof(optarg);
+            break;
+        case OPT_STYLES:
+            mix.m_StyleToggles = atof(optarg);
+            break;
+        case OPT_GRAPHICS:
+            mix.m_Graphics = atof(optarg);
+            break;
+        case OPT_GRAPHICS_COLUMNS:
+            mix.m_GraphicsColumns = atoi(optarg);
+            break;
+        case OPT_DENSITY:
+            mix.m_GraphicsDensity = atof(optarg);
+            break;
+        case OPT_LINES_PER_PAGE:
+            mix.m_LinesPerPage = atoi(optarg);
+            break;
+        case OPT_LINE_WIDTH:
+            mix.m_LineWidth = atoi(optarg);
+            break;
+        case OPT_SOAK:
+            soak = ParseDuration(optarg);
+            break;
+        case OPT_REPORT:
+            interval = ParseDuration(optarg);
+            break;
+        case 'P':
+            if (!PreprocessorFactory::Lookup(optarg))
+            {
+                std::cerr << argv[0] << ": unknown preprocessor. Use dotprint --preprocessor list to get a list." << std::endl;
+                return 1;
+            }
+            settings.m_Preprocessor = optarg;
+            break;
+        case 't':
+            {
+                CodepageTranslator *t = new CodepageTranslator();
+                t->loadTable(optarg);
+                settings.m_Translator = t;
+            }
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        default:
+            return 1;
+        }
+    }
+
+    if (soak > 0.0)
+        return Soak(settings, mix, seed, size, soak, interval);
+
+    SpoolGenerator generator(seed, mix);
+
+    if (output.empty())
+    {
+        generator.Generate(std::cout, size);
+    }
+    else
+    {
+        std::ofstream f(output, std::ofstream::binary);
+        if (!f.is_open())
+        {
+            std::cerr << argv[0] << ": unable to open \"" << output << "\"" << std::endl;
+            return 1;
+        }
+        generator.Generate(f, size);
+    }
+
+    return 0;
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "SpoolGenerator.h"
+
+namespace
+{
+    const char *Words[] =
+    {
+        "invoice", "total", "amount", "customer", "order", "delivery",
+        "date", "quantity", "price", "item", "account", "balance",
+        "tax", "net", "gross", "page", "number", "article", "stock", "due"
+    };
+
+    const unsigned NrWords = sizeof(Words) / sizeof(Words[0]);
+
+    // Accented letters and box drawing characters of the code pages.
+    const char HighBytesCP850[] =
+        "\x80\x81\x82\x83\x84\x85\x87\x88\x89\x8a\x8b\x8c\x8e\x90\x93\x94\x96\x99\x9a\xa0\xa1\xa2\xa3\xa4\xa5"
+        "\xb3\xb4\xbf\xc0\xc1\xc2\xc3\xc4\xc5\xc9\xbb\xc8\xbc\xcd\xba\xd9\xda";
+
+    const char HighBytesCP852[] =
+        "\x80\x81\x82\x83\x84\x85\x86\x87\x88\x89\x8a\x8b\x8c\x8d\x8e\x8f\x90\x91\x92\x93\x94\x95\x96\x97"
+        "\x98\x99\x9a\x9b\x9c\x9d\x9f\xa0\xa1\xa2\xa3\xa4\xa5\xa6\xa7\xa8\xa9\xd8\xe7\xfb\xfd"
+        "\xb3\xb4\xbf\xc0\xc1\xc2\xc3\xc4\xc5\xc9\xbb\xc8\xbc\xcd\xba\xd9\xda";
+
+    /** \brief Size of the precomputed pool graphics data is drawn from. */
+    const unsigned DotPoolSize = 4096;
+
+    /** \brief ESC * mode: 24 pin, 180 dpi, three bytes per column. */
+    const char GraphicsMode = 39;
+
+    /** \brief Bytes generated at a time when streaming. */
+    const size_t BlockSize = 1 << 16;
+}
+
+SpoolGenerator::SpoolGenerator(uint64_t seed, const SpoolMix &mix):
+    m_Mix(mix),
+    m_Random(seed),
+    m_LineOnPage(0),
+    m_Bold(false),
+    m_Italic(false),
+    m_Condensed(false),
+    m_Expanded(false)
+{
+    if (m_Mix.m_Codepage == "CP850")
+        m_HighBytePool.assign(HighBytesCP850, sizeof(HighBytesCP850) - 1);
+    else if (m_Mix.m_Codepage == "CP852")
+        m_HighBytePool.assign(HighBytesCP852, sizeof(HighBytesCP852) - 1);
+    else
+        throw std::invalid_argument("SpoolGenerator: unsupported codepage " + m_Mix.m_Codepage);
+
+    m_Mix.m_LineWidth = std::max(m_Mix.m_LineWidth, 16u);
+
+    // Drawing every dot separately would make multi-GB outputs slow,
+    // so the dot bytes come from a pool with the requested density.
+    std::bernoulli_distribution dot(m_Mix.m_GraphicsDensity);
+    m_DotPool.resize(DotPoolSize);
+    for (char &c : m_DotPool)
+    {
+        unsigned b = 0;
+        for (int bit = 0; bit < 8; ++bit)
+            b = (b << 1) | (dot(m_Random) ? 1 : 0);
+        c = (char) b;
+    }
+}
+
+std::string SpoolGenerator::Generate(uint64_t size)
+{
+    std::string out;
+    out.reserve(size + m_Mix.m_LineWidth * 4);
+
+    while (out.size() < size)
+        AppendLine(out);
+
+    out.resize(size);
+    return out;
+}
+
+void SpoolGenerator::Generate(std::ostream &out, uint64_t size)
+{
+    std::string block;
+    block.reserve(BlockSize * 2);
+
+    while (size > 0 && out)
+    {
+        block.clear();
+        AppendBlock(block, BlockSize);
+
+        uint64_t n = std::min<uint64_t>(block.size(), size);
+        out.write(block.data(), n);
+        size -= n;
+    }
+}
+
+void SpoolGenerator::AppendBlock(std::string &out, size_t size)
+{
+    while (out.size() < size)
+        AppendLine(out);
+}
+
+bool SpoolGenerator::Chance(double p)
+{
+    return std::generate_canonical<double, 32>(m_Random) < p;
+}
+
+void SpoolGenerator::AppendLine(std::string &out)
+{
+    std::uniform_int_distribution<unsigned> word(0, NrWords - 1);
+    std::uniform_int_distribution<size_t> high(0, m_HighBytePool.size() - 1);
+
+    if (m_LineOnPage == 0)
+        out += "\x1b@"; // Initialize printer at the start of every page
+
+    unsigned column = 0;
+
+    while (column < m_Mix.m_LineWidth - 12)
+    {
+        if (Chance(m_Mix.m_StyleToggles))
+            AppendStyleToggle(out);
+
+        const char *w = Words[word(m_Random)];
+        out += w;
+        column += std::char_traits<char>::length(w);
+
+        if (Chance(m_Mix.m_HighBytes))
+        {
+            out += m_HighBytePool[high(m_Random)];
+            ++column;
+        }
+
+        out += ' ';
+        ++column;
+    }
+
+    AppendStyleReset(out);
+    out += "\r\n";
+    m_Expanded = false; // line feed ends one line expanded printing
+
+    if (Chance(m_Mix.m_Graphics))
+        AppendGraphics(out);
+
+    if (m_Mix.m_LinesPerPage && ++m_LineOnPage >= m_Mix.m_LinesPerPage)
+    {
+        out += '\x0c';
+        m_LineOnPage = 0;
+    }
+}
+
+void SpoolGenerator::AppendGraphics(std::string &out)
+{
+    unsigned columns = std::min(m_Mix.m_GraphicsColumns, 0xffffu);
+    size_t bytes = columns * 3;
+    std::uniform_int_distribution<size_t> offset(0, DotPoolSize - 1);
+
+    out += "\x1b*";
+    out += GraphicsMode;
+    out += (char) (columns & 0xff);
+    out += (char) (columns >> 8);
+
+    while (bytes > 0)
+    {
+        size_t start = offset(m_Random);
+        size_t n = std::min(bytes, DotPoolSize - start);
+        out.append(m_DotPool, start, n);
+        bytes -= n;
+    }
+
+    out += "\r\n";
+}
+
+void SpoolGenerator::AppendStyleToggle(std::string &out)
+{
+    std::uniform_int_distribution<int> style(0, 3);
+
+    switch (style(m_Random))
+    {
+    case 0:
+        out += m_Bold ? "\x1b" "F" : "\x1b" "E";
+        m_Bold = !m_Bold;
+        break;
+    case 1:
+        out += m_Italic ? "\x1b" "5" : "\x1b" "4";
+        m_Italic = !m_Italic;
+        break;
+    case 2:
+        out += m_Condensed ? '\x12' : '\x0f';
+        m_Condensed = !m_Condensed;
+        break;
+    default:
+        out += m_Expanded ? '\x14' : '\x0e';
+        m_Expanded = !m_Expanded;
+        break;
+    }
+}
+
+void SpoolGenerator::AppendStyleReset(std::string &out)
+{
+    if (m_Bold)
+        out += "\x1b" "F";
+    if (m_Italic)
+        out += "\x1b" "5";
+    if (m_Condensed)
+        out += '\x12';
+
+    m_Bold = m_Italic = m_Condensed = false;
+}
+
+GeneratedInputSource::GeneratedInputSource(SpoolGenerator &generator, uint64_t size):
+    m_Generator(generator),
+    m_Left(size),
+    m_Offset(0)
+{
+    m_Block.reserve(BlockSize * 2);
+}
+
+size_t GeneratedInputSource::read(uint8_t *buf, size_t len)
+{
+    if (m_Offset == m_Block.size())
+    {
+        if (m_Left == 0)
+            return 0;
+
+        m_Block.clear();
+        m_Generator.AppendBlock(m_Block, BlockSize);
+        m_Block.resize(std::min<uint64_t>(m_Block.size(), m_Left));
+        m_Left -= m_Block.size();
+        m_Offset = 0;
+    }
+
+    size_t n = std::min(len, m_Block.size() - m_Offset);
+    memcpy(buf, m_Block.data() + m_Offset, n);
+    m_Offset += n;
+
+    return n;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPOOLGENERATOR_H_
+#define SPOOLGENERATOR_H_
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+
+#include "../InputSource.h"
+
+/** \brief Composition of the generated spool. Probabilities are in the range 0.0 - 1.0. */
+struct SpoolMix
+{
+    SpoolMix():
+        m_Codepage("CP850"),
+        m_HighBytes(0.1),
+        m_StyleToggles(0.05),
+        m_Graphics(0.0),
+        m_GraphicsColumns(480),
+        m_GraphicsDensity(0.3),
+        m_LinesPerPage(60),
+        m_LineWidth(80)
+    {}
+
+    /** \brief Codepage the high bytes are taken from, "CP850" or "CP852". */
+    std::string m_Codepage;
+
+    /** \brief Probability that a word is followed by a high byte (accented letter or box drawing). */
+    double m_HighBytes;
+
+    /** \brief Probability that a word is preceded by a bold/italic/condensed/expanded toggle. */
+    double m_StyleToggles;
+
+    /** \brief Probability that a line is followed by an ESC * graphics band. */
+    double m_Graphics;
+
+    /** \brief Columns of a graphics band. */
+    unsigned m_GraphicsColumns;
+
+    /** \brief Fraction of dots set in a graphics band. */
+    double m_GraphicsDensity;
+
+    /** \brief Lines per page before a form feed is sent, 0 for no form feeds. */
+    unsigned m_LinesPerPage;
+
+    /** \brief Printable width of a line in characters at 10 CPI. */
+    unsigned m_LineWidth;
+};
+
+/**
+ * \brief Produces synthetic ESC/P spool data.
+ *
+ * The output only depends on the seed and the mix, so the same seed always
+ * gives the same bytes. Output is produced one line at a time, so there is
+ * no limit on the size.
+ */
+class SpoolGenerator
+{
+public:
+    explicit SpoolGenerator(uint64_t seed = 1, const SpoolMix &mix = SpoolMix());
+
+    /** \brief Returns size bytes of spool data. */
+    std::string Generate(uint64_t size);
+
+    /** \brief Writes size bytes of spool data to out. */
+    void Generate(std::ostream &out, uint64_t size);
+
+    /** \brief Appends whole lines to out until it holds at least size bytes. */
+    void AppendBlock(std::string &out, size_t size);
+
+private:
+    /** \brief Appends one printed line, including the line terminator. */
+    void AppendLine(std::string &out);
+
+    /** \brief Appends an ESC * graphics band. */
+    void AppendGraphics(std::string &out);
+
+    /** \brief Appends a toggle of a randomly chosen text style. */
+    void AppendStyleToggle(std::string &out);
+
+    /** \brief Appends escapes that return all styles to normal. */
+    void AppendStyleReset(std::string &out);
+
+    bool Chance(double p);
+
+    SpoolMix m_Mix;
+    std::mt19937_64 m_Random;
+    std::string m_HighBytePool;
+    std::string m_DotPool;
+    unsigned m_LineOnPage;
+
+    bool m_Bold;
+    bool m_Italic;
+    bool m_Condensed;
+    bool m_Expanded;
+};
+
+/**
+ * \brief Input source reading size bytes from a SpoolGenerator.
+ *
+ * The data is generated block by block as it is read, so the size of the
+ * spool does not add to the memory of the process.
+ */
+class GeneratedInputSource: public IInputSource
+{
+public:
+    GeneratedInputSource(SpoolGenerator &generator, uint64_t size);
+
+    virtual size_t read(uint8_t *buf, size_t len) override;
+
+private:
+    SpoolGenerator &m_Generator;
+    uint64_t m_Left;
+    std::string m_Block;
+    size_t m_Offset;
+};
+
+#endif /*SPOOLGENERATOR_H_*/
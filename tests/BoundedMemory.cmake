@@ -0,0 +1,46 @@
+# Converts generated spools of each of SIZES from standard input, split every
+# 500 pages, and checks the peak RSS reported by --stats: it must stay below
+# MAX_RSS_KB for every size and grow by at most MAX_GROWTH_KB from the
+# smallest to the largest spool.
+#
+# Run by ctest, see CMakeLists.txt for the variables.
+
+set(peaks)
+
+foreach(size ${SIZES})
+    file(REMOVE_RECURSE "${WORK_DIR}")
+    file(MAKE_DIRECTORY "${WORK_DIR}")
+
+    execute_process(
+        COMMAND "${DOTPRINT_GEN}" --size ${size} --graphics 0.01
+        COMMAND "${DOTPRINT}" --stats -P epson -t "${TABLES_DIR}/cp850.trans" --split-pages 500
+            -o "${WORK_DIR}/out.pdf" -
+        RESULT_VARIABLE result
+        ERROR_VARIABLE stats
+    )
+    file(REMOVE_RECURSE "${WORK_DIR}")
+
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Converting ${size} failed (${result}):\n${stats}")
+    endif()
+
+    string(REGEX MATCH "peak RSS: *([0-9]+) kB" match "${stats}")
+    if(NOT match)
+        message(FATAL_ERROR "No peak RSS in the --stats output for ${size}:\n${stats}")
+    endif()
+
+    set(peak ${CMAKE_MATCH_1})
+    message(STATUS "${size}: peak RSS ${peak} kB")
+    if(peak GREATER MAX_RSS_KB)
+        message(FATAL_ERROR "Peak RSS of ${peak} kB for ${size} exceeds ${MAX_RSS_KB} kB")
+    endif()
+
+    list(APPEND peaks ${peak})
+endforeach()
+
+list(GET peaks 0 first)
+list(GET peaks -1 last)
+math(EXPR growth "${last} - ${first}")
+if(growth GREATER MAX_GROWTH_KB)
+    message(FATAL_ERROR "Peak RSS grew by ${growth} kB with the spool size, more than ${MAX_GROWTH_KB} kB")
+endif()
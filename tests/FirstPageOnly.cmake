@@ -0,0 +1,44 @@
+# Converts a spool whose first page spans more than one input block (bit
+# images, which are skipped, between two lines of text) with --first-page-only
+# and checks that the image equals page 1 of the full conversion.
+#
+# Run by ctest, see CMakeLists.txt for the variables.
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+string(ASCII 27 esc)
+string(ASCII 12 ff)
+
+# ESC K with nL = nH = 0x40: 16448 columns of image data each
+string(REPEAT "U" 16448 columns)
+string(REPEAT "${esc}K@@${columns}" 6 images)
+
+file(WRITE "${WORK_DIR}/in.prn" "First line of page 1\r\n${images}Last line of page 1\r\n${ff}Page 2\r\n")
+
+foreach(run full first)
+    if(run STREQUAL "first")
+        set(option --first-page-only)
+    else()
+        set(option)
+    endif()
+
+    execute_process(
+        COMMAND "${DOTPRINT}" -P epson --format png ${option} -o "${WORK_DIR}/${run}.png" "${WORK_DIR}/in.prn"
+        RESULT_VARIABLE result
+        ERROR_VARIABLE error
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Converting with ${run} pages failed (${result}):\n${error}")
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files "${WORK_DIR}/full-0001.png" "${WORK_DIR}/first.png"
+    RESULT_VARIABLE different
+)
+file(REMOVE_RECURSE "${WORK_DIR}")
+
+if(different)
+    message(FATAL_ERROR "--first-page-only does not output the whole first page")
+endif()
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Preemption of bulk jobs by interactive ones in JobScheduler.
+ */
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JobScheduler.h"
+
+namespace
+{
+    int failures = 0;
+
+    void Check(bool condition, const std::string &what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    class Log
+    {
+    public:
+        void Add(const std::string &event)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Events.push_back(event);
+        }
+
+        std::vector<std::string> Get()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            return m_Events;
+        }
+
+    private:
+        std::mutex m_Mutex;
+        std::vector<std::string> m_Events;
+    };
+
+    /**
+     * \brief Runs a bulk job of three pages on a scheduler with one slot and
+     * queues an interactive job while the first page is drawn. The pages are
+     * drawn on a thread of their own if renderThread is set, the way
+     * --render-thread does.
+     */
+    std::vector<std::string> Preempt(bool renderThread)
+    {
+        SchedulerSettings settings;
+        settings.m_Slots = 1;
+        settings.m_BulkJobs = 1;
+
+        Log log;
+        std::promise<void> started;
+        std::promise<void> queued;
+        std::shared_future<void> interactiveQueued = queued.get_future().share();
+
+        JobScheduler scheduler(settings);
+
+        scheduler.Submit([&]()
+        {
+            std::function<void()> pages = [&]()
+            {
+                for (int page = 0; page < 3; ++page)
+                {
+                    log.Add("bulk page " + std::to_string(page));
+                    if (page == 0)
+                    {
+                        started.set_value();
+                        interactiveQueued.wait();
+                    }
+                    JobScheduler::PageBoundary();
+                }
+            };
+
+            if (renderThread)
+            {
+                JobScheduler *bulk = JobScheduler::GetBulkScheduler();
+                std::thread renderer([&]()
+                {
+                    JobScheduler::SetBulkScheduler(bulk);
+                    pages();
+                });
+                renderer.join();
+            }
+            else
+            {
+                pages();
+            }
+            log.Add("bulk done");
+        }, JobClass::Bulk);
+
+        started.get_future().wait();
+        scheduler.Submit([&]() { log.Add("interactive"); }, JobClass::Interactive);
+        queued.set_value();
+
+        scheduler.Shutdown(true);
+        return log.Get();
+    }
+
+    void CheckPreempted(const std::vector<std::string> &events, const std::string &what)
+    {
+        std::vector<std::string> expected = { "bulk page 0", "interactive", "bulk page 1", "bulk page 2", "bulk done" };
+        Check(events == expected, what);
+
+        if (events != expected)
+        {
+            for (const std::string &event : events)
+                std::cerr << "  " << event << std::endl;
+        }
+    }
+}
+
+int main()
+{
+    CheckPreempted(Preempt(false), "a waiting interactive job runs at the next page boundary of a bulk job");
+    CheckPreempted(Preempt(true), "the same with the pages drawn on a thread of the bulk job");
+
+    Check(JobScheduler::GetBulkScheduler() == nullptr, "other threads run no bulk job");
+
+    return failures == 0 ? 0 : 1;
+}
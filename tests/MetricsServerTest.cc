@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 dotprint contributors
+ *
+ * This file is part of dotprint.
+ *
+ * dotprint is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * dotprint is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with dotprint. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * Answers of MetricsServer to a local client on a Unix socket.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "MetricsServer.h"
+
+namespace
+{
+    int failures = 0;
+
+    void Check(bool condition, const std::string &what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    int Connect(const std::string &path)
+    {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            std::cerr << "Unable to connect to \"" << path << "\": " << strerror(errno) << std::endl;
+            exit(1);
+        }
+        return fd;
+    }
+
+    /** \brief Sends request and returns everything until the server closes. */
+    std::string Ask(const std::string &path, const std::string &request)
+    {
+        int fd = Connect(path);
+        if (write(fd, request.data(), request.size()) != static_cast<ssize_t>(request.size()))
+            Check(false, "sending \"" + request + "\"");
+
+        std::string response;
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+            response.append(buffer, n);
+        close(fd);
+        return response;
+    }
+
+    bool StartsWith(const std::string &s, const std::string &prefix)
+    {
+        return s.compare(0, prefix.size(), prefix) == 0;
+    }
+}
+
+int main()
+{
+    std::string path = "/tmp/dotprint-metrics-test." + std::to_string(getpid()) + ".sock";
+    std::unique_ptr<MetricsServer> server(new MetricsServer(path, nullptr));
+
+    std::string metrics = Ask(path, "GET /metrics HTTP/1.0\r\n\r\n");
+    Check(StartsWith(metrics, "HTTP/1.0 200 OK\r\n"), "GET /metrics answers 200");
+    Check(metrics.find("\ndotprint_jobs_total ") != std::string::npos, "GET /metrics lists dotprint_jobs_total");
+
+    std::string query = Ask(path, "GET /metrics?name=x HTTP/1.1\nHost: localhost\n\n");
+    Check(StartsWith(query, "HTTP/1.0 200 OK\r\n"), "the query string is ignored");
+
+    std::string head = Ask(path, "HEAD /metrics HTTP/1.0\r\n\r\n");
+    Check(StartsWith(head, "HTTP/1.0 200 OK\r\n"), "HEAD /metrics answers 200");
+    Check(head.find("dotprint_jobs_total") == std::string::npos, "HEAD /metrics has no body");
+
+    Check(StartsWith(Ask(path, "GET / HTTP/1.0\r\n\r\n"), "HTTP/1.0 404 "), "GET / answers 404");
+    Check(StartsWith(Ask(path, "POST /metrics HTTP/1.0\r\n\r\n"), "HTTP/1.0 405 "), "POST answers 405");
+
+    // A client that never sends its request must neither block the next one
+    // nor the shutdown.
+    int idle = Connect(path);
+    Check(StartsWith(Ask(path, "GET /metrics HTTP/1.0\r\n\r\n"), "HTTP/1.0 200 OK\r\n"),
+        "answers after an idle client");
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    server.reset();
+    Check(std::chrono::steady_clock::now() - start < std::chrono::seconds(5), "stops with an idle client connected");
+    Check(access(path.c_str(), F_OK) != 0, "removes the socket");
+    close(idle);
+
+    return failures == 0 ? 0 : 1;
+}